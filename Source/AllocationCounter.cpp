@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the heap allocations of the program, by replacing the global
+// allocation functions
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// heap allocations made through operator new by every thread
+	std::atomic<long> g_heapAllocations(0);
+
+	// allocate and count heap memory, or return NULL when it fails
+	void* AllocateCounted(size_t size)
+	{
+		g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		return(malloc((size > 0) ? size : 1));
+	}
+}
+
+/***********************************************************
+ *  GetHeapAllocationCount()
+ *
+ *  This method is used for getting the number of heap
+ *  allocations made so far. The difference between two
+ *  calls is the number made in between, by any thread.
+ ***********************************************************/
+long AllocationCounter::GetHeapAllocationCount()
+{
+	return(g_heapAllocations.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  operator new()
+ *
+ *  The replacements of the global allocation functions,
+ *  which count every heap allocation. The throwing forms
+ *  throw std::bad_alloc when the memory runs out, and the
+ *  nothrow forms return NULL instead.
+ ***********************************************************/
+void* operator new(size_t size)
+{
+	void* pMemory = AllocateCounted(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	return(operator new(size));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return(AllocateCounted(size));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(AllocateCounted(size));
+}
+
+/***********************************************************
+ *  operator delete()
+ *
+ *  The replacements of the global deallocation functions
+ *  that go with the counting operator new. The sized forms
+ *  are called by the compiler when the size is known, and
+ *  free the memory the same way.
+ ***********************************************************/
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
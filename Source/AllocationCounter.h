@@ -0,0 +1,27 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the heap allocations of the program, by replacing the global
+// allocation functions
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  This class reads the count kept by the replacements of
+ *  the global operator new and operator delete, in all of
+ *  their plain, array, nothrow and sized forms. Every heap
+ *  allocation made through them by any thread is counted,
+ *  so the profiler can show the frames that allocate.
+ ***********************************************************/
+class AllocationCounter
+{
+public:
+	// number of heap allocations made by the whole program so
+	// far, through operator new
+	static long GetHeapAllocationCount();
+};
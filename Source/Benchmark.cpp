@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// ============
+// render a fixed number of frames into an offscreen target along a camera
+// path, and report the frame times and draw counts as JSON
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of the global variables and defines
+namespace
+{
+	// frames left out of the report while the driver warms up
+	const int g_WarmupFrames = 30;
+
+	// get a string from the driver, or an empty one
+	std::string GetDriverString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return((NULL != value) ? std::string((const char*)value) : std::string());
+	}
+
+	// get a string as a quoted JSON string
+	std::string QuoteJson(const std::string& value)
+	{
+		std::string quoted = "\"";
+		for (unsigned int i = 0; i < value.size(); i++)
+		{
+			char c = value[i];
+			if ((c == '"') || (c == '\\'))
+			{
+				quoted += '\\';
+				quoted += c;
+			}
+			else if ((unsigned char)c >= 0x20)
+			{
+				quoted += c;
+			}
+		}
+		quoted += "\"";
+		return(quoted);
+	}
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Benchmark::Benchmark(int frameCount, float timestep)
+{
+	m_frameCount = frameCount;
+	m_timestep = timestep;
+	m_frameIndex = 0;
+	m_startupTime = 0.0;
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+
+	m_cameraPath.MakeDefaultPath();
+}
+
+/***********************************************************
+ *  ~Benchmark()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Benchmark::~Benchmark()
+{
+	if (m_framebuffer != 0)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_colorBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for creating the offscreen render
+ *  target the frames are drawn into, so that the benchmark
+ *  does not depend on the window being shown or on the
+ *  display refresh rate.
+ ***********************************************************/
+bool Benchmark::CreateTarget(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Benchmark framebuffer is incomplete: " << status << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame of the run: the
+ *  offscreen framebuffer is bound for the whole frame, and
+ *  the time of the frame on the camera path is a multiple
+ *  of the fixed timestep, whatever the frame rate.
+ ***********************************************************/
+float Benchmark::BeginFrame()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+
+	return(m_timestep * (float)m_frameIndex);
+}
+
+/***********************************************************
+ *  AddInfo()
+ *
+ *  This method is used for adding a named string to the
+ *  description of the run written into the report.
+ ***********************************************************/
+void Benchmark::AddInfo(const char* name, const std::string& value)
+{
+	m_info.push_back(std::make_pair(std::string(name), QuoteJson(value)));
+}
+
+/***********************************************************
+ *  AddInfo()
+ *
+ *  This method is used for adding a named number to the
+ *  description of the run written into the report.
+ ***********************************************************/
+void Benchmark::AddInfo(const char* name, int value)
+{
+	m_info.push_back(std::make_pair(std::string(name), std::to_string(value)));
+}
+
+/***********************************************************
+ *  WriteStatistics()
+ *
+ *  This method is used for writing the mean, the smallest,
+ *  the percentiles and the largest of a list of values as
+ *  a JSON object, or null when there are no values.
+ ***********************************************************/
+void Benchmark::WriteStatistics(std::ostream& json, std::vector<double> values)
+{
+	if (values.empty())
+	{
+		json << "null";
+		return;
+	}
+
+	std::sort(values.begin(), values.end());
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < values.size(); i++)
+	{
+		sum += values[i];
+	}
+
+	// nearest rank percentiles
+	const int percentiles[] = { 50, 90, 95, 99 };
+	json << "{ \"mean\": " << (sum / values.size())
+		<< ", \"min\": " << values.front();
+	for (int i = 0; i < 4; i++)
+	{
+		size_t rank = (size_t)((percentiles[i] * values.size() + 99) / 100);
+		rank = std::max<size_t>(rank, 1);
+		json << ", \"p" << percentiles[i] << "\": " << values[rank - 1];
+	}
+	json << ", \"max\": " << values.back() << " }";
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the report of the run -
+ *  the driver, the startup time, the statistics of the frame
+ *  time, of the CPU and GPU time of every section, of the
+ *  GPU time of the whole frame, and of every counter.
+ ***********************************************************/
+bool Benchmark::WriteReport(const char* filename, const Profiler& profiler) const
+{
+	const std::vector<Profiler::FRAME_RECORD>& history = profiler.GetHistory();
+	size_t firstFrame = (history.size() > (size_t)g_WarmupFrames) ? (size_t)g_WarmupFrames : 0;
+
+	std::vector<double> frameTimes;
+	std::vector<double> gpuFrameTimes;
+	for (size_t i = firstFrame; i < history.size(); i++)
+	{
+		const Profiler::FRAME_RECORD& record = history[i];
+		frameTimes.push_back(record.frameTime);
+
+		// the GPU time of the frame is only known when every
+		// section timed on the GPU has its time
+		double gpuTime = 0.0;
+		bool bGpuTime = false;
+		for (int j = 0; j < profiler.GetSectionCount(); j++)
+		{
+			if (profiler.IsSectionGpuTimed(j) == false)
+			{
+				continue;
+			}
+			if (record.gpuTimes[j] < 0.0)
+			{
+				bGpuTime = false;
+				break;
+			}
+			gpuTime += record.gpuTimes[j];
+			bGpuTime = true;
+		}
+		if (bGpuTime == true)
+		{
+			gpuFrameTimes.push_back(gpuTime);
+		}
+	}
+
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(4);
+	json << "{\n";
+	json << "  \"renderer\": " << QuoteJson(GetDriverString(GL_RENDERER)) << ",\n";
+	json << "  \"version\": " << QuoteJson(GetDriverString(GL_VERSION)) << ",\n";
+	json << "  \"width\": " << m_width << ",\n";
+	json << "  \"height\": " << m_height << ",\n";
+	for (unsigned int i = 0; i < m_info.size(); i++)
+	{
+		json << "  " << QuoteJson(m_info[i].first) << ": " << m_info[i].second << ",\n";
+	}
+	json << "  \"frames\": " << history.size() << ",\n";
+	json << "  \"warmup_frames\": " << firstFrame << ",\n";
+	json << "  \"timestep_ms\": " << (m_timestep * 1000.0) << ",\n";
+	json << "  \"camera_keys\": " << m_cameraPath.GetKeyCount() << ",\n";
+	json << "  \"startup_ms\": " << m_startupTime << ",\n";
+	json << "  \"frame_ms\": ";
+	WriteStatistics(json, frameTimes);
+	json << ",\n  \"gpu_frame_ms\": ";
+	WriteStatistics(json, gpuFrameTimes);
+
+	json << ",\n  \"sections\": {";
+	for (int j = 0; j < profiler.GetSectionCount(); j++)
+	{
+		std::vector<double> cpuTimes;
+		std::vector<double> gpuTimes;
+		for (size_t i = firstFrame; i < history.size(); i++)
+		{
+			cpuTimes.push_back(history[i].cpuTimes[j]);
+			if (history[i].gpuTimes[j] >= 0.0)
+			{
+				gpuTimes.push_back(history[i].gpuTimes[j]);
+			}
+		}
+
+		json << ((j > 0) ? ",\n" : "\n") << "    " << QuoteJson(profiler.GetSectionName(j)) << ": {\n";
+		json << "      \"cpu_ms\": ";
+		WriteStatistics(json, cpuTimes);
+		json << ",\n      \"gpu_ms\": ";
+		WriteStatistics(json, gpuTimes);
+		json << "\n    }";
+	}
+	json << "\n  },\n  \"counters\": {";
+	for (int j = 0; j < profiler.GetCounterCount(); j++)
+	{
+		std::vector<double> values;
+		for (size_t i = firstFrame; i < history.size(); i++)
+		{
+			values.push_back(history[i].counters[j]);
+		}
+
+		json << ((j > 0) ? ",\n" : "\n") << "    " << QuoteJson(profiler.GetCounterName(j)) << ": ";
+		WriteStatistics(json, values);
+	}
+	json << "\n  }\n}\n";
+
+	FILE* pFile = fopen(filename, "w");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write benchmark report: " << filename << std::endl;
+		return(false);
+	}
+	fputs(json.str().c_str(), pFile);
+	fclose(pFile);
+
+	return(true);
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.h
+// ============
+// render a fixed number of frames into an offscreen target along a camera
+// path, and report the frame times and draw counts as JSON
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CameraPath.h"
+
+class Profiler;
+
+/***********************************************************
+ *  Benchmark
+ *
+ *  This class runs the scene without user input, so every
+ *  run renders the same frames: the camera follows a path
+ *  sampled at a fixed timestep, and the frames go into an
+ *  offscreen framebuffer the size of the window instead of
+ *  the screen. Once the last frame is drawn, the profiled
+ *  frames are summed up into a JSON report, leaving out the
+ *  first frames while the driver warms up.
+ ***********************************************************/
+class Benchmark
+{
+public:
+	// constructor
+	Benchmark(int frameCount, float timestep);
+	// destructor
+	~Benchmark();
+
+	// path the camera follows, the default orbit until one is loaded
+	CameraPath& GetCameraPath() { return(m_cameraPath); }
+
+	// create the offscreen framebuffer of the passed in size
+	bool CreateTarget(int width, int height);
+
+	// start a frame, binding the offscreen framebuffer, and get the
+	// time on the camera path to render it at
+	float BeginFrame();
+	// end the frame that was started last
+	void EndFrame() { m_frameIndex++; }
+	// whether every frame has been rendered
+	bool IsFinished() const { return(m_frameIndex >= m_frameCount); }
+
+	// milliseconds from the start of the application to the first frame
+	void SetStartupTime(double milliseconds) { m_startupTime = milliseconds; }
+
+	// describe what was run, such as the scene and the submission
+	// path, so that the reports of different runs can be compared
+	void AddInfo(const char* name, const std::string& value);
+	void AddInfo(const char* name, int value);
+
+	// write the report made from the frames of the profiler, which
+	// must keep its history, into a file
+	bool WriteReport(const char* filename, const Profiler& profiler) const;
+
+private:
+	// number of frames to render and the seconds between them
+	int m_frameCount;
+	float m_timestep;
+	int m_frameIndex;
+	double m_startupTime;
+	// path the camera follows
+	CameraPath m_cameraPath;
+	// names and JSON values describing the run
+	std::vector<std::pair<std::string, std::string> > m_info;
+
+	// offscreen framebuffer with a color and a depth buffer
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+
+	// write the mean, the percentiles and the largest of a list
+	// of values as a JSON object
+	static void WriteStatistics(std::ostream& json, std::vector<double> values);
+};
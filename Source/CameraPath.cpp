@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// record the camera as timed keys, save and load them as text, and play
+// them back by interpolating between the keys
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of the global variables and defines
+namespace
+{
+	// seconds between the keys kept while recording
+	const float g_RecordSpacing = 0.1f;
+	// the default orbit - the point looked at, the distance and
+	// height from it, and the seconds of one full turn
+	const glm::vec3 g_OrbitTarget = glm::vec3(0.0f, 1.0f, -2.0f);
+	const float g_OrbitRadius = 12.0f;
+	const float g_OrbitHeight = 5.0f;
+	const float g_OrbitSeconds = 10.0f;
+	const int g_OrbitKeys = 16;
+}
+
+/***********************************************************
+ *  CameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraPath::CameraPath()
+{
+}
+
+/***********************************************************
+ *  LoadFile()
+ *
+ *  This method is used for loading the keys of a path from
+ *  a text file. Empty lines and lines starting with # are
+ *  skipped, and the keys must be in increasing time.
+ ***********************************************************/
+bool CameraPath::LoadFile(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open camera path file: " << filename << std::endl;
+		return(false);
+	}
+
+	std::vector<CAMERA_KEY> keys;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if ((line.empty()) || (line[0] == '#') || (line.find_first_not_of(" \t\r") == std::string::npos))
+		{
+			continue;
+		}
+
+		CAMERA_KEY key;
+		std::istringstream values(line);
+		values >> key.time
+			>> key.position.x >> key.position.y >> key.position.z
+			>> key.front.x >> key.front.y >> key.front.z;
+		if ((values.fail()) ||
+			((!keys.empty()) && (key.time <= keys.back().time)))
+		{
+			std::cout << "Invalid camera path key on line " << lineNumber << " of " << filename << std::endl;
+			return(false);
+		}
+		keys.push_back(key);
+	}
+
+	if (keys.empty())
+	{
+		std::cout << "No keys in camera path file: " << filename << std::endl;
+		return(false);
+	}
+
+	m_keys.swap(keys);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveFile()
+ *
+ *  This method is used for saving the keys of the path into
+ *  a text file that LoadFile() can read back.
+ ***********************************************************/
+bool CameraPath::SaveFile(const char* filename) const
+{
+	FILE* pFile = fopen(filename, "w");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write camera path file: " << filename << std::endl;
+		return(false);
+	}
+
+	fprintf(pFile, "# time  position x y z  front x y z\n");
+	for (unsigned int i = 0; i < m_keys.size(); i++)
+	{
+		const CAMERA_KEY& key = m_keys[i];
+		fprintf(pFile, "%.3f  %.4f %.4f %.4f  %.4f %.4f %.4f\n",
+			key.time,
+			key.position.x, key.position.y, key.position.z,
+			key.front.x, key.front.y, key.front.z);
+	}
+	fclose(pFile);
+
+	return(true);
+}
+
+/***********************************************************
+ *  MakeDefaultPath()
+ *
+ *  This method is used for replacing the keys with one full
+ *  turn around the desk, looking at its middle, for when no
+ *  recorded path is passed in.
+ ***********************************************************/
+void CameraPath::MakeDefaultPath()
+{
+	m_keys.clear();
+
+	for (int i = 0; i <= g_OrbitKeys; i++)
+	{
+		float angle = 6.2831853f * (float)i / (float)g_OrbitKeys;
+
+		CAMERA_KEY key;
+		key.time = g_OrbitSeconds * (float)i / (float)g_OrbitKeys;
+		key.position = g_OrbitTarget + glm::vec3(
+			g_OrbitRadius * std::sin(angle),
+			g_OrbitHeight,
+			g_OrbitRadius * std::cos(angle));
+		key.front = glm::normalize(g_OrbitTarget - key.position);
+		m_keys.push_back(key);
+	}
+}
+
+/***********************************************************
+ *  AddKey()
+ *
+ *  This method is used for adding the camera at a time after
+ *  the last key, such as while recording the interactive
+ *  camera once per frame.
+ ***********************************************************/
+void CameraPath::AddKey(float time, const glm::vec3& position, const glm::vec3& front)
+{
+	if ((!m_keys.empty()) && (time < m_keys.back().time + g_RecordSpacing))
+	{
+		return;
+	}
+
+	CAMERA_KEY key;
+	key.time = time;
+	key.position = position;
+	key.front = front;
+	m_keys.push_back(key);
+}
+
+/***********************************************************
+ *  GetDuration()
+ *
+ *  This method is used for getting the time of the last key.
+ ***********************************************************/
+float CameraPath::GetDuration() const
+{
+	if (m_keys.empty())
+	{
+		return(0.0f);
+	}
+
+	return(m_keys.back().time);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method is used for getting the camera at a time on
+ *  the path, linearly between the keys around it. Times
+ *  past the last key start over from the first one.
+ ***********************************************************/
+void CameraPath::Sample(float time, glm::vec3& position, glm::vec3& front) const
+{
+	if (m_keys.empty())
+	{
+		return;
+	}
+
+	float duration = GetDuration();
+	if (duration > 0.0f)
+	{
+		time = std::fmod(time, duration);
+	}
+
+	// find the last key at or before the time
+	unsigned int next = 1;
+	while ((next < m_keys.size()) && (m_keys[next].time <= time))
+	{
+		next++;
+	}
+	if (next >= m_keys.size())
+	{
+		position = m_keys.back().position;
+		front = m_keys.back().front;
+		return;
+	}
+
+	const CAMERA_KEY& from = m_keys[next - 1];
+	const CAMERA_KEY& to = m_keys[next];
+	float blend = (time - from.time) / (to.time - from.time);
+	if (blend < 0.0f)
+	{
+		blend = 0.0f;
+	}
+
+	position = glm::mix(from.position, to.position, blend);
+	front = glm::normalize(glm::mix(from.front, to.front, blend));
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// record the camera as timed keys, save and load them as text, and play
+// them back by interpolating between the keys
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class holds the position of the camera and the
+ *  direction it is looking in at increasing times. A path
+ *  is recorded from the interactive camera, or written by
+ *  hand, one key per line of "time px py pz fx fy fz", and
+ *  played back with a fixed timestep so that every run
+ *  renders the same frames.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	// constructor
+	CameraPath();
+
+	// load keys from a text file, replacing the current ones
+	bool LoadFile(const char* filename);
+	// save the keys into a text file
+	bool SaveFile(const char* filename) const;
+	// replace the keys with a default orbit around the scene
+	void MakeDefaultPath();
+
+	// add a key after the last one, keys closer than the minimum
+	// spacing to the last one are skipped while recording
+	void AddKey(float time, const glm::vec3& position, const glm::vec3& front);
+	// get the camera at the passed in time, the path repeats
+	// after its last key
+	void Sample(float time, glm::vec3& position, glm::vec3& front) const;
+
+	// number of keys and the time of the last one
+	int GetKeyCount() const { return((int)m_keys.size()); }
+	float GetDuration() const;
+
+private:
+	// camera at a point in time on the path
+	struct CAMERA_KEY
+	{
+		float time;
+		glm::vec3 position;
+		glm::vec3 front;
+	};
+
+	// keys at increasing times
+	std::vector<CAMERA_KEY> m_keys;
+};
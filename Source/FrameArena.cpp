@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// hand out the transient memory of a frame from one block that is reset
+// at the start of every frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// alignment of the block and of the heap allocations made for
+	// what does not fit into it, enough for any of the scratch types
+	const size_t g_BlockAlignment = 16;
+
+	// allocate aligned memory from the heap, without going through
+	// operator new
+	void* AllocateAligned(size_t size)
+	{
+		// the returned address is the allocation advanced to the
+		// next multiple of the alignment, with the allocation stored
+		// right in front of it for freeing
+		void* pAllocation = malloc(size + g_BlockAlignment + sizeof(void*));
+		if (NULL == pAllocation)
+		{
+			return(NULL);
+		}
+
+		size_t address = (size_t)pAllocation + sizeof(void*);
+		address = (address + g_BlockAlignment - 1) & ~(g_BlockAlignment - 1);
+		((void**)address)[-1] = pAllocation;
+		return((void*)address);
+	}
+
+	// free memory allocated by AllocateAligned()
+	void FreeAligned(void* pMemory)
+	{
+		if (NULL != pMemory)
+		{
+			free(((void**)pMemory)[-1]);
+		}
+	}
+}
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t capacity)
+{
+	m_capacity = capacity;
+	m_pBlock = (unsigned char*)AllocateAligned(m_capacity);
+	m_offset = 0;
+	m_usedBytes = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	Reset();
+	FreeAligned(m_pBlock);
+	m_pBlock = NULL;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for freeing everything the last
+ *  frame allocated at once. When some of it did not fit,
+ *  the block is replaced by one large enough for all of it,
+ *  so the next frames of the same size do not overflow.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	for (unsigned int i = 0; i < m_overflowBlocks.size(); i++)
+	{
+		FreeAligned(m_overflowBlocks[i]);
+	}
+
+	if (m_overflowBlocks.size() > 0)
+	{
+		m_overflowBlocks.clear();
+
+		// leave room for the padding of the allocations
+		m_capacity = std::max(m_capacity, (m_usedBytes * 3) / 2);
+		FreeAligned(m_pBlock);
+		m_pBlock = (unsigned char*)AllocateAligned(m_capacity);
+	}
+
+	m_offset = 0;
+	m_usedBytes = 0;
+}
+
+/***********************************************************
+ *  AllocateBytes()
+ *
+ *  This method is used for allocating bytes from the block
+ *  at the passed in alignment. When the block is full, the
+ *  bytes come from the heap until the next reset.
+ ***********************************************************/
+void* FrameArena::AllocateBytes(size_t size, size_t alignment)
+{
+	if (size == 0)
+	{
+		size = 1;
+	}
+	m_usedBytes += size;
+
+	size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+	if ((NULL != m_pBlock) && (offset + size <= m_capacity))
+	{
+		m_offset = offset + size;
+		return(m_pBlock + offset);
+	}
+
+	void* pMemory = AllocateAligned(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	m_overflowBlocks.push_back(pMemory);
+	return(pMemory);
+}
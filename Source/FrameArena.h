@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// hand out the transient memory of a frame from one block that is reset
+// at the start of every frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class allocates the scratch data of a frame, such
+ *  as the per-chunk culling results and the indirect draw
+ *  commands, by moving a pointer through a single block.
+ *  Nothing is freed on its own, the whole block is reset
+ *  when the next frame starts, so the memory must not be
+ *  kept across frames. Allocations that do not fit come
+ *  from the heap, and the block grows to the peak of the
+ *  frame at the next reset, so steady frames stay inside
+ *  of it. The arena is only used by the main thread, the
+ *  worker threads write into ranges handed out before.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor, with the starting size of the block in bytes
+	FrameArena(size_t capacity);
+	// destructor
+	~FrameArena();
+
+	// free everything allocated in the last frame
+	void Reset();
+
+	// allocate uninitialized room for the passed in number of
+	// values of a type without a constructor or destructor
+	template <typename T>
+	T* Allocate(size_t count)
+	{
+		return((T*)AllocateBytes(sizeof(T) * count, alignof(T)));
+	}
+	// allocate room for values, all set to the passed in one
+	template <typename T>
+	T* Allocate(size_t count, const T& value)
+	{
+		T* pValues = Allocate<T>(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			pValues[i] = value;
+		}
+		return(pValues);
+	}
+
+	// bytes allocated in this frame, the block size, and the
+	// number of allocations of this frame that did not fit
+	size_t GetUsedBytes() const { return(m_usedBytes); }
+	size_t GetCapacity() const { return(m_capacity); }
+	int GetOverflowCount() const { return((int)m_overflowBlocks.size()); }
+
+private:
+	// the block and the offset of its next free byte
+	unsigned char* m_pBlock;
+	size_t m_capacity;
+	size_t m_offset;
+	// bytes asked for in this frame, with the ones that did not
+	// fit into the block
+	size_t m_usedBytes;
+	// heap allocations made for the ones that did not fit
+	std::vector<void*> m_overflowBlocks;
+
+	// allocate bytes at the passed in alignment
+	void* AllocateBytes(size_t size, size_t alignment);
+};
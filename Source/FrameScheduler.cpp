@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.cpp
+// ============
+// step the simulation and the input at a fixed rate, independent of the
+// rate the frames are rendered and presented at
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameScheduler.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// longest real time a frame adds to the accumulator, so a
+	// stall such as dragging the window is not caught up on
+	const double g_MaxFrameTime = 0.25;
+	// most update steps taken in one frame, the time past them
+	// is dropped instead of falling further behind
+	const int g_MaxUpdateSteps = 8;
+	// how long before a capped frame is due the sleeping stops and
+	// the rest is waited out by yielding, since sleeps can
+	// overshoot by about a millisecond
+	const double g_SleepMargin = 0.002;
+}
+
+/***********************************************************
+ *  FrameScheduler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameScheduler::FrameScheduler(float timestep)
+{
+	m_timestep = timestep;
+	m_accumulator = 0.0;
+	m_fixedFrameTime = 0.0;
+	m_lastFrame = CLOCK::now();
+	m_bStarted = false;
+	m_steps = 0;
+	m_pacing = PACING_VSYNC;
+	m_capPeriod = 0.0;
+	m_nextFrame = CLOCK::now();
+}
+
+/***********************************************************
+ *  SetPacing()
+ *
+ *  This method is used for choosing how the frames are
+ *  paced. Vsync waits in the swap for the display, the
+ *  other modes turn that wait off.
+ ***********************************************************/
+void FrameScheduler::SetPacing(PACING_MODE pacing, double capRate)
+{
+	if ((pacing == PACING_CAPPED) && (capRate <= 0.0))
+	{
+		pacing = PACING_UNCAPPED;
+	}
+
+	m_pacing = pacing;
+	m_capPeriod = (pacing == PACING_CAPPED) ? (1.0 / capRate) : 0.0;
+	m_nextFrame = CLOCK::now();
+
+	glfwSwapInterval((pacing == PACING_VSYNC) ? 1 : 0);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame, adding the time
+ *  since the start of the last frame to the time the update
+ *  stage has to step through.
+ ***********************************************************/
+void FrameScheduler::BeginFrame()
+{
+	CLOCK::time_point now = CLOCK::now();
+
+	double frameTime = 0.0;
+	if (m_fixedFrameTime > 0.0)
+	{
+		frameTime = m_fixedFrameTime;
+	}
+	else if (m_bStarted == true)
+	{
+		frameTime = std::chrono::duration<double>(now - m_lastFrame).count();
+	}
+	else
+	{
+		// the first frame takes one step, so the render stage
+		// always has an update to start from
+		frameTime = m_timestep;
+	}
+	if (frameTime > g_MaxFrameTime)
+	{
+		frameTime = g_MaxFrameTime;
+	}
+
+	m_lastFrame = now;
+	m_bStarted = true;
+	m_accumulator += frameTime;
+	m_steps = 0;
+}
+
+/***********************************************************
+ *  StepUpdate()
+ *
+ *  This method is used for taking the next fixed timestep of
+ *  the update stage out of the accumulated time. Once too
+ *  many steps were taken for one frame, the rest of the time
+ *  is dropped.
+ ***********************************************************/
+bool FrameScheduler::StepUpdate()
+{
+	if (m_accumulator < m_timestep)
+	{
+		return(false);
+	}
+
+	if (m_steps >= g_MaxUpdateSteps)
+	{
+		m_accumulator = 0.0;
+		return(false);
+	}
+
+	m_accumulator -= m_timestep;
+	m_steps++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetInterpolation()
+ *
+ *  This method is used for getting how far the frame is
+ *  between the last update step and the next one, from 0
+ *  to 1, for the render stage to blend the updated state by.
+ ***********************************************************/
+float FrameScheduler::GetInterpolation() const
+{
+	float alpha = (float)(m_accumulator / m_timestep);
+	if (alpha > 1.0f)
+	{
+		alpha = 1.0f;
+	}
+
+	return(alpha);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending a frame. With capped
+ *  pacing, the thread sleeps until the next frame is due,
+ *  and has its last moment waited out by yielding. Frames
+ *  that are late move the schedule along instead of being
+ *  followed by a burst of frames that catch up.
+ ***********************************************************/
+void FrameScheduler::EndFrame()
+{
+	if (m_pacing != PACING_CAPPED)
+	{
+		return;
+	}
+
+	m_nextFrame += std::chrono::duration_cast<CLOCK::duration>(std::chrono::duration<double>(m_capPeriod));
+
+	CLOCK::time_point now = CLOCK::now();
+	if (now >= m_nextFrame)
+	{
+		m_nextFrame = now;
+		return;
+	}
+
+	double wait = std::chrono::duration<double>(m_nextFrame - now).count();
+	if (wait > g_SleepMargin)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double>(wait - g_SleepMargin));
+	}
+	while (CLOCK::now() < m_nextFrame)
+	{
+		std::this_thread::yield();
+	}
+}
+
+/***********************************************************
+ *  WaitForEvents()
+ *
+ *  This method is used for blocking until there is an event
+ *  to process, or until the timeout, instead of polling for
+ *  them. The wait is taken out of the next frame time, so
+ *  the update stage does not run a burst of steps after it.
+ ***********************************************************/
+void FrameScheduler::WaitForEvents(double timeoutSeconds)
+{
+	if (timeoutSeconds > 0.0)
+	{
+		glfwWaitEventsTimeout(timeoutSeconds);
+	}
+	else
+	{
+		glfwWaitEvents();
+	}
+
+	m_lastFrame = CLOCK::now();
+	m_nextFrame = m_lastFrame;
+}
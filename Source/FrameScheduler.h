@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.h
+// ============
+// step the simulation and the input at a fixed rate, independent of the
+// rate the frames are rendered and presented at
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+/***********************************************************
+ *  FrameScheduler
+ *
+ *  This class runs the frame loop in two stages. The real
+ *  time since the last frame is added to an accumulator,
+ *  which is spent in fixed timesteps by the update stage -
+ *  input and camera movement - so they behave the same at
+ *  any frame rate. What is left over between two steps is
+ *  the fraction the render stage interpolates by. The frames
+ *  are paced by the display, capped to a rate, or uncapped,
+ *  and the loop can wait for events while nothing changes.
+ ***********************************************************/
+class FrameScheduler
+{
+public:
+	// how the presenting of frames is paced
+	enum PACING_MODE
+	{
+		PACING_VSYNC,		// wait for the display refresh
+		PACING_CAPPED,		// sleep down to a frame rate
+		PACING_UNCAPPED		// present as fast as possible
+	};
+
+	// constructor
+	FrameScheduler(float timestep);
+
+	// choose the pacing, with the frame rate for capped pacing -
+	// this sets the swap interval of the current context
+	void SetPacing(PACING_MODE pacing, double capRate);
+	PACING_MODE GetPacing() const { return(m_pacing); }
+
+	// advance every frame by the passed in seconds instead of the
+	// real time, for runs that must render the same frames every
+	// time - 0 goes back to the real time
+	void SetFixedFrameTime(double seconds) { m_fixedFrameTime = seconds; }
+
+	// start a frame, adding the time since the last one
+	void BeginFrame();
+	// take the next fixed timestep of the update stage, returns
+	// false once the time of the frame is used up
+	bool StepUpdate();
+	// fraction of a timestep the render stage is past the last update
+	float GetInterpolation() const;
+	// end a frame, sleeping down to the frame rate when capped
+	void EndFrame();
+
+	// wait for an event, or for the passed in seconds, instead of
+	// rendering frames while nothing changes - the time spent
+	// waiting is not caught up on by the update stage
+	void WaitForEvents(double timeoutSeconds);
+
+	// seconds of every fixed timestep
+	float GetTimestep() const { return(m_timestep); }
+
+private:
+	typedef std::chrono::steady_clock CLOCK;
+
+	// seconds of every update step, and the time not spent yet
+	float m_timestep;
+	double m_accumulator;
+	// frame time used instead of the real time, when not 0
+	double m_fixedFrameTime;
+	// start of the last frame
+	CLOCK::time_point m_lastFrame;
+	bool m_bStarted;
+	// update steps taken in the current frame
+	int m_steps;
+
+	// pacing, and the time the next capped frame is due at
+	PACING_MODE m_pacing;
+	double m_capPeriod;
+	CLOCK::time_point m_nextFrame;
+};
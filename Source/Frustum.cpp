@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.cpp
+// ============
+// test the bounding volumes of the scene objects against the view frustum,
+// so that objects outside of the view are not drawn
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Frustum.h"
+
+#include <cmath>
+
+/***********************************************************
+ *  Frustum()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Frustum::Frustum()
+{
+	// until planes are extracted nothing is rejected
+	for (int i = 0; i < 6; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+/***********************************************************
+ *  ExtractPlanes()
+ *
+ *  This method is used for extracting the six clipping
+ *  planes from the combined view and projection matrix. A
+ *  point is inside of the frustum when its clip space
+ *  coordinates are within -w and w, so each plane is the
+ *  fourth row of the matrix plus or minus one of the others.
+ ***********************************************************/
+void Frustum::ExtractPlanes(const glm::mat4& viewProjection)
+{
+	// the matrix is stored by columns, so gather the rows
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(
+			viewProjection[0][i],
+			viewProjection[1][i],
+			viewProjection[2][i],
+			viewProjection[3][i]);
+	}
+
+	m_planes[0] = rows[3] + rows[0];	// left
+	m_planes[1] = rows[3] - rows[0];	// right
+	m_planes[2] = rows[3] + rows[1];	// bottom
+	m_planes[3] = rows[3] - rows[1];	// top
+	m_planes[4] = rows[3] + rows[2];	// near
+	m_planes[5] = rows[3] - rows[2];	// far
+}
+
+/***********************************************************
+ *  IsBoxVisible()
+ *
+ *  This method is used for testing a world space box
+ *  against the clipping planes. For each plane only the
+ *  corner furthest along the plane normal is tested - when
+ *  even that corner is behind a plane, the whole box is
+ *  outside of the frustum.
+ ***********************************************************/
+bool Frustum::IsBoxVisible(const BOUNDING_BOX& box) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& plane = m_planes[i];
+
+		glm::vec3 corner(
+			(plane.x >= 0.0f) ? box.maximum.x : box.minimum.x,
+			(plane.y >= 0.0f) ? box.maximum.y : box.minimum.y,
+			(plane.z >= 0.0f) ? box.maximum.z : box.minimum.z);
+
+		if ((plane.x * corner.x) + (plane.y * corner.y) + (plane.z * corner.z) + plane.w < 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  TransformBox()
+ *
+ *  This method is used for calculating the world space box
+ *  of an object. The center of the object space box is
+ *  transformed as a point, and the half size is spread over
+ *  the world axes by the absolute values of the rotation
+ *  and scale part of the model matrix.
+ ***********************************************************/
+Frustum::BOUNDING_BOX Frustum::TransformBox(
+	const BOUNDING_BOX& box,
+	const glm::mat4& modelMatrix)
+{
+	glm::vec3 center = (box.minimum + box.maximum) * 0.5f;
+	glm::vec3 halfSize = (box.maximum - box.minimum) * 0.5f;
+
+	glm::vec3 worldCenter = glm::vec3(modelMatrix * glm::vec4(center, 1.0f));
+	glm::vec3 worldHalfSize(0.0f);
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			worldHalfSize[row] += std::fabs(modelMatrix[column][row]) * halfSize[column];
+		}
+	}
+
+	BOUNDING_BOX worldBox;
+	worldBox.minimum = worldCenter - worldHalfSize;
+	worldBox.maximum = worldCenter + worldHalfSize;
+	return(worldBox);
+}
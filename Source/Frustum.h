@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.h
+// ============
+// test the bounding volumes of the scene objects against the view frustum,
+// so that objects outside of the view are not drawn
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  Frustum
+ *
+ *  This class holds the six clipping planes of a camera,
+ *  extracted from its combined view and projection matrix,
+ *  and tests axis-aligned bounding boxes against them.
+ ***********************************************************/
+class Frustum
+{
+public:
+	// constructor
+	Frustum();
+
+	// axis-aligned bounding box
+	struct BOUNDING_BOX
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// extract the clipping planes from the view-projection matrix
+	void ExtractPlanes(const glm::mat4& viewProjection);
+	// whether any part of the world space box is inside the planes
+	bool IsBoxVisible(const BOUNDING_BOX& box) const;
+	// the clipping planes, for testing on the GPU
+	const glm::vec4* GetPlanes() const { return(m_planes); }
+
+	// calculate the world space box that encloses an object
+	// space box transformed by the passed in model matrix
+	static BOUNDING_BOX TransformBox(const BOUNDING_BOX& box, const glm::mat4& modelMatrix);
+
+private:
+	// left, right, bottom, top, near and far planes, with the
+	// normals pointing into the frustum
+	glm::vec4 m_planes[6];
+};
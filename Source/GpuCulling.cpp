@@ -0,0 +1,399 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculling.cpp
+// ============
+// test the scene instances against the view frustum in a compute shader and
+// write the surviving ones straight into the indirect draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCulling.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static_assert(sizeof(GpuCulling::CULL_BATCH) == 64, "CullBatch does not match std430");
+static_assert(sizeof(InstancedMeshes::DRAW_COMMAND) == 20, "DrawCommand does not match std430");
+
+// declaration of global variables
+namespace
+{
+	// invocations per work group, must match the compute shader
+	const GLuint g_WorkGroupSize = 64;
+
+	// storage buffer binding points used by the compute shader
+	const GLuint g_InstanceMatricesBinding = 0;
+	const GLuint g_InstanceDataBinding = 1;
+	const GLuint g_InstanceBatchesBinding = 2;
+	const GLuint g_CullBatchesBinding = 3;
+	const GLuint g_DrawCommandsBinding = 4;
+	const GLuint g_CulledMatricesBinding = 5;
+	const GLuint g_CulledDataBinding = 6;
+	const GLuint g_InstanceLodsBinding = 7;
+	// atomic counter binding point of the visible count
+	const GLuint g_VisibleCountBinding = 0;
+}
+
+/***********************************************************
+ *  GpuCulling()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCulling::GpuCulling()
+{
+	m_programID = 0;
+	m_frustumPlanesLocation = -1;
+	m_instanceCountLocation = -1;
+	m_viewProjectionLocation = -1;
+	m_lodScaleLocation = -1;
+	m_lodThresholdsLocation = -1;
+	m_lodHysteresisLocation = -1;
+	m_lodThresholds[0] = 0.0f;
+	m_lodThresholds[1] = 0.0f;
+	m_lodHysteresis = 0.0f;
+
+	m_instanceBatchBuffer = 0;
+	m_batchBuffer = 0;
+	m_resetBuffer = 0;
+	m_instanceLodBuffer = 0;
+	m_culledInstanceBuffer = 0;
+	m_culledInstanceDataBuffer = 0;
+	m_counterBuffers[0] = 0;
+	m_counterBuffers[1] = 0;
+	m_counterIndex = 0;
+	m_bCounterWritten[0] = false;
+	m_bCounterWritten[1] = false;
+	m_bDispatched = false;
+	m_visibleCount = 0;
+
+	m_batchCount = 0;
+	m_instanceCount = 0;
+}
+
+/***********************************************************
+ *  ~GpuCulling()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCulling::~GpuCulling()
+{
+	if (m_programID != 0)
+	{
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+
+	if (m_batchBuffer != 0)
+	{
+		GLuint buffers[8] = {
+			m_instanceBatchBuffer,
+			m_batchBuffer,
+			m_resetBuffer,
+			m_instanceLodBuffer,
+			m_culledInstanceBuffer,
+			m_culledInstanceDataBuffer,
+			m_counterBuffers[0],
+			m_counterBuffers[1] };
+		glDeleteBuffers(8, buffers);
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the context
+ *  supports compute shaders, storage buffers and multi-draw
+ *  indirect, which are all core in OpenGL 4.3.
+ ***********************************************************/
+bool GpuCulling::IsSupported()
+{
+	if (GLEW_VERSION_4_3)
+	{
+		return(true);
+	}
+
+	return(GLEW_ARB_compute_shader &&
+		GLEW_ARB_shader_storage_buffer_object &&
+		InstancedMeshes::IsIndirectSupported());
+}
+
+/***********************************************************
+ *  LoadShader()
+ *
+ *  This method is used for reading the culling compute
+ *  shader from a GLSL file, compiling it and linking it
+ *  into its own shader program.
+ ***********************************************************/
+bool GpuCulling::LoadShader(const char* filename)
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "Compute shaders are not supported, culling on the CPU" << std::endl;
+		return(false);
+	}
+
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open compute shader file: " << filename << std::endl;
+		return(false);
+	}
+	std::stringstream contents;
+	contents << file.rdbuf();
+	std::string source = contents.str();
+	const char* sourceText = source.c_str();
+
+	GLint success = 0;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &sourceText, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not compile compute shader: " << filename << "\n" << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not link compute shader: " << filename << "\n" << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	if (m_programID != 0)
+	{
+		glDeleteProgram(m_programID);
+	}
+	m_programID = programID;
+	m_frustumPlanesLocation = glGetUniformLocation(m_programID, "frustumPlanes");
+	m_instanceCountLocation = glGetUniformLocation(m_programID, "instanceCount");
+	m_viewProjectionLocation = glGetUniformLocation(m_programID, "viewProjection");
+	m_lodScaleLocation = glGetUniformLocation(m_programID, "lodScale");
+	m_lodThresholdsLocation = glGetUniformLocation(m_programID, "lodThresholds");
+	m_lodHysteresisLocation = glGetUniformLocation(m_programID, "lodHysteresis");
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the buffer objects the
+ *  compute shader reads from and writes to.
+ ***********************************************************/
+void GpuCulling::CreateBuffers()
+{
+	glGenBuffers(1, &m_instanceBatchBuffer);
+	glGenBuffers(1, &m_batchBuffer);
+	glGenBuffers(1, &m_resetBuffer);
+	glGenBuffers(1, &m_instanceLodBuffer);
+	glGenBuffers(1, &m_culledInstanceBuffer);
+	glGenBuffers(1, &m_culledInstanceDataBuffer);
+	glGenBuffers(2, m_counterBuffers);
+
+	GLuint zero = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_counterBuffers[i]);
+		glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_READ);
+	}
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetBatches()
+ *
+ *  This method is used for uploading the batch levels to
+ *  cull, the batch of every instance, and the draw commands
+ *  with zero instances that each dispatch starts from. The
+ *  culled instance buffers are sized to hold every instance
+ *  at every level of detail.
+ ***********************************************************/
+void GpuCulling::SetBatches(
+	const std::vector<CULL_BATCH>& batches,
+	const std::vector<GLuint>& instanceBatches)
+{
+	if (m_batchBuffer == 0)
+	{
+		CreateBuffers();
+	}
+
+	int instanceCount = (int)instanceBatches.size();
+
+	std::vector<InstancedMeshes::DRAW_COMMAND> resetCommands(batches.size());
+	for (unsigned int i = 0; i < batches.size(); i++)
+	{
+		const CULL_BATCH& batch = batches[i];
+
+		resetCommands[i].count = batch.count;
+		resetCommands[i].instanceCount = 0;
+		resetCommands[i].firstIndex = batch.firstIndex;
+		resetCommands[i].baseVertex = batch.baseVertex;
+		resetCommands[i].baseInstance = batch.firstInstance;
+	}
+	// every instance starts out at the finest level
+	std::vector<GLuint> instanceLods(instanceCount, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBatchBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * instanceBatches.size(), instanceBatches.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_batchBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CULL_BATCH) * batches.size(), batches.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceLodBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * instanceLods.size(), instanceLods.data(), GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_culledInstanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::mat4) * instanceCount * MESH_LOD_LEVELS, NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_culledInstanceDataBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(InstancedMeshes::INSTANCE_DATA) * instanceCount * MESH_LOD_LEVELS, NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, m_resetBuffer);
+	glBufferData(GL_COPY_READ_BUFFER, sizeof(InstancedMeshes::DRAW_COMMAND) * resetCommands.size(), resetCommands.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	m_batchCount = (int)batches.size();
+	m_instanceCount = instanceCount;
+}
+
+/***********************************************************
+ *  SetLodSelection()
+ *
+ *  This method is used for setting the projected sizes at
+ *  which instances change from the finest level of detail
+ *  to the middle one, and from the middle one to the
+ *  coarsest, and how far past a threshold the size has to
+ *  move before the level changes back.
+ ***********************************************************/
+void GpuCulling::SetLodSelection(
+	float fineThreshold,
+	float coarseThreshold,
+	float hysteresis)
+{
+	m_lodThresholds[0] = fineThreshold;
+	m_lodThresholds[1] = coarseThreshold;
+	m_lodHysteresis = hysteresis;
+}
+
+/***********************************************************
+ *  Dispatch()
+ *
+ *  This method is used for culling every instance on the
+ *  GPU. The commands in the indirect buffer are first reset
+ *  to zero instances, then each invocation of the compute
+ *  shader tests one instance and, when it is visible, picks
+ *  its level of detail and adds it to the instance count of
+ *  the command for that level of its batch.
+ ***********************************************************/
+void GpuCulling::Dispatch(
+	const Frustum& frustum,
+	const glm::mat4& viewProjection,
+	float lodScale,
+	GLuint instanceBuffer,
+	GLintptr instanceOffset,
+	GLuint instanceDataBuffer,
+	GLintptr instanceDataOffset,
+	GLuint indirectBuffer)
+{
+	if ((m_programID == 0) || (m_batchCount == 0) || (m_instanceCount == 0))
+	{
+		return;
+	}
+
+	// reset the draw commands without a round trip to the CPU
+	glBindBuffer(GL_COPY_READ_BUFFER, m_resetBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, indirectBuffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(InstancedMeshes::DRAW_COMMAND) * m_batchCount);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	GLuint zero = 0;
+	GLuint counterBuffer = m_counterBuffers[m_counterIndex];
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	glBindBufferRange(
+		GL_SHADER_STORAGE_BUFFER,
+		g_InstanceMatricesBinding,
+		instanceBuffer,
+		instanceOffset,
+		sizeof(glm::mat4) * m_instanceCount);
+	glBindBufferRange(
+		GL_SHADER_STORAGE_BUFFER,
+		g_InstanceDataBinding,
+		instanceDataBuffer,
+		instanceDataOffset,
+		sizeof(InstancedMeshes::INSTANCE_DATA) * m_instanceCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_InstanceBatchesBinding, m_instanceBatchBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CullBatchesBinding, m_batchBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_DrawCommandsBinding, indirectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CulledMatricesBinding, m_culledInstanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CulledDataBinding, m_culledInstanceDataBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_InstanceLodsBinding, m_instanceLodBuffer);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, g_VisibleCountBinding, counterBuffer);
+
+	// the scene program is restored once the dispatch is issued
+	GLint currentProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+	glUseProgram(m_programID);
+	glUniform4fv(m_frustumPlanesLocation, 6, &frustum.GetPlanes()[0].x);
+	glUniform1ui(m_instanceCountLocation, (GLuint)m_instanceCount);
+	glUniformMatrix4fv(m_viewProjectionLocation, 1, GL_FALSE, &viewProjection[0].x);
+	glUniform1f(m_lodScaleLocation, lodScale);
+	glUniform2f(m_lodThresholdsLocation, m_lodThresholds[0], m_lodThresholds[1]);
+	glUniform1f(m_lodHysteresisLocation, m_lodHysteresis);
+	glDispatchCompute((m_instanceCount + g_WorkGroupSize - 1) / g_WorkGroupSize, 1, 1);
+
+	// the draw commands and the culled instances are read by
+	// the draw calls that follow, the levels of detail by the
+	// next dispatch, and the commands and the counter are reset
+	// and read back with buffer calls
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT |
+		GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	glUseProgram((GLuint)currentProgram);
+
+	m_bCounterWritten[m_counterIndex] = true;
+	m_counterIndex = 1 - m_counterIndex;
+	m_bDispatched = true;
+}
+
+/***********************************************************
+ *  GetVisibleCount()
+ *
+ *  This method is used for reading back the number of the
+ *  instances that survived culling. Right after a dispatch
+ *  the counter of the previous one is read, so the read does
+ *  not wait on the GPU to catch up, and from the next frame
+ *  on the counter of the latest one.
+ ***********************************************************/
+int GpuCulling::GetVisibleCount()
+{
+	// after a dispatch the index points at the older counter
+	int readIndex = m_bDispatched ? m_counterIndex : (1 - m_counterIndex);
+	m_bDispatched = false;
+
+	if (m_bCounterWritten[readIndex] == true)
+	{
+		GLuint visibleCount = 0;
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_counterBuffers[readIndex]);
+		glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &visibleCount);
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+		m_visibleCount = (int)visibleCount;
+	}
+
+	return(m_visibleCount);
+}
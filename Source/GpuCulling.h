@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculling.h
+// ============
+// test the scene instances against the view frustum in a compute shader and
+// write the surviving ones straight into the indirect draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Frustum.h"
+#include "InstancedMeshes.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  GpuCulling
+ *
+ *  This class runs the culling compute shader over every
+ *  instance of the shared instance buffers. The instances
+ *  that are inside of the view frustum are copied into the
+ *  culled instance buffers, packed at the start of their
+ *  batch, and counted into the instance count of the batch
+ *  command in the indirect buffer with an atomic add. The
+ *  draw commands never travel back to the CPU.
+ ***********************************************************/
+class GpuCulling
+{
+public:
+	// constructor
+	GpuCulling();
+	// destructor
+	~GpuCulling();
+
+	// one level of detail of a batch of instances, drawn with
+	// one command, in the std430 layout read by the compute
+	// shader - every batch has MESH_LOD_LEVELS of these in a row
+	struct CULL_BATCH
+	{
+		GLuint count;
+		GLuint firstIndex;
+		GLint baseVertex;
+		// where the surviving instances of the level are packed
+		GLuint firstInstance;
+		GLuint instanceCount;
+		// number of levels the batch really has
+		GLuint lodCount;
+		GLuint padding[2];
+		// object space bounds of the mesh
+		glm::vec4 boundsMin;
+		glm::vec4 boundsMax;
+	};
+
+	// whether compute shaders and storage buffers are supported
+	static bool IsSupported();
+	// compile the culling compute shader from a GLSL file
+	bool LoadShader(const char* filename);
+	// whether the compute shader is ready to be dispatched
+	bool IsReady() const { return(m_programID != 0); }
+
+	// set the batches to cull, and the batch of each instance
+	void SetBatches(
+		const std::vector<CULL_BATCH>& batches,
+		const std::vector<GLuint>& instanceBatches);
+	// set the projected sizes where the levels of detail change
+	void SetLodSelection(float fineThreshold, float coarseThreshold, float hysteresis);
+	// cull every instance, pick its level of detail, and write the
+	// draw commands, one per batch level, into the indirect buffer,
+	// the instances are read from the passed in offsets
+	void Dispatch(
+		const Frustum& frustum,
+		const glm::mat4& viewProjection,
+		float lodScale,
+		GLuint instanceBuffer,
+		GLintptr instanceOffset,
+		GLuint instanceDataBuffer,
+		GLintptr instanceDataOffset,
+		GLuint indirectBuffer);
+
+	// buffers holding the surviving instances after a dispatch
+	GLuint GetCulledInstanceBuffer() const { return(m_culledInstanceBuffer); }
+	GLuint GetCulledInstanceDataBuffer() const { return(m_culledInstanceDataBuffer); }
+	// number of instances that survived a recent dispatch
+	int GetVisibleCount();
+
+private:
+	// compute shader program and the locations of its uniforms
+	GLuint m_programID;
+	GLint m_frustumPlanesLocation;
+	GLint m_instanceCountLocation;
+	GLint m_viewProjectionLocation;
+	GLint m_lodScaleLocation;
+	GLint m_lodThresholdsLocation;
+	GLint m_lodHysteresisLocation;
+	// projected sizes where the levels of detail change
+	float m_lodThresholds[2];
+	float m_lodHysteresis;
+
+	// batch of each instance, the batches, and the draw commands
+	// with zero instances that the indirect buffer is reset to
+	GLuint m_instanceBatchBuffer;
+	GLuint m_batchBuffer;
+	GLuint m_resetBuffer;
+	// level of detail each instance was last drawn with
+	GLuint m_instanceLodBuffer;
+	// surviving instances, with room for every instance at
+	// every level of detail
+	GLuint m_culledInstanceBuffer;
+	GLuint m_culledInstanceDataBuffer;
+	// counters of the surviving instances - one is written while
+	// the other, from the previous dispatch, is read back
+	GLuint m_counterBuffers[2];
+	int m_counterIndex;
+	bool m_bCounterWritten[2];
+	// whether a dispatch was issued since the last read back,
+	// and the number of surviving instances last read back
+	bool m_bDispatched;
+	int m_visibleCount;
+	// number of batches and instances set to be culled
+	int m_batchCount;
+	int m_instanceCount;
+
+	// create the buffer objects on first use
+	void CreateBuffers();
+};
@@ -0,0 +1,1039 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.cpp
+// ============
+// create meshes for 3D primitives that are repeated many times in a scene,
+// so that every copy can be drawn with a single instanced draw call, and
+// every mesh of the scene with a single multi-draw indirect call
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InstancedMeshes.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of floats per vertex - position, normal, texture coordinate
+	const GLuint g_FloatsPerVertex = 8;
+	// radius of the main ring of the torus
+	const float g_TorusMainRadius = 1.0f;
+	const float g_TwoPi = 6.28318530718f;
+
+	// append a vertex to the generated vertex data
+	void AddVertex(
+		std::vector<GLfloat>& vertices,
+		const glm::vec3& position,
+		const glm::vec3& normal,
+		float u,
+		float v)
+	{
+		vertices.push_back(position.x);
+		vertices.push_back(position.y);
+		vertices.push_back(position.z);
+		vertices.push_back(normal.x);
+		vertices.push_back(normal.y);
+		vertices.push_back(normal.z);
+		vertices.push_back(u);
+		vertices.push_back(v);
+	}
+
+	// number of vertices in the generated vertex data
+	GLuint VertexCount(const std::vector<GLfloat>& vertices)
+	{
+		return((GLuint)(vertices.size() / g_FloatsPerVertex));
+	}
+
+	// append a flat quad with its corners in counter-clockwise
+	// order, mapped to the whole of the texture
+	void AddQuad(
+		std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices,
+		const glm::vec3& corner0,
+		const glm::vec3& corner1,
+		const glm::vec3& corner2,
+		const glm::vec3& corner3)
+	{
+		glm::vec3 normal = glm::normalize(glm::cross(corner1 - corner0, corner2 - corner0));
+		GLuint first = VertexCount(vertices);
+
+		AddVertex(vertices, corner0, normal, 0.0f, 0.0f);
+		AddVertex(vertices, corner1, normal, 1.0f, 0.0f);
+		AddVertex(vertices, corner2, normal, 1.0f, 1.0f);
+		AddVertex(vertices, corner3, normal, 0.0f, 1.0f);
+
+		indices.push_back(first);
+		indices.push_back(first + 1);
+		indices.push_back(first + 2);
+		indices.push_back(first);
+		indices.push_back(first + 2);
+		indices.push_back(first + 3);
+	}
+
+	// append a flat disc facing up or down at the passed in height,
+	// divided into the passed in number of segments
+	void AddDisc(
+		std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices,
+		float height,
+		bool bFacingUp,
+		int segments)
+	{
+		glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+		GLuint center = VertexCount(vertices);
+
+		AddVertex(vertices, glm::vec3(0.0f, height, 0.0f), normal, 0.5f, 0.5f);
+		for (int i = 0; i <= segments; i++)
+		{
+			float angle = ((float)i / segments) * g_TwoPi;
+			float x = cos(angle);
+			float z = sin(angle);
+
+			AddVertex(vertices, glm::vec3(x, height, z), normal, (x * 0.5f) + 0.5f, (z * 0.5f) + 0.5f);
+		}
+
+		for (int i = 0; i < segments; i++)
+		{
+			GLuint current = center + 1 + i;
+
+			indices.push_back(center);
+			if (bFacingUp)
+			{
+				indices.push_back(current + 1);
+				indices.push_back(current);
+			}
+			else
+			{
+				indices.push_back(current);
+				indices.push_back(current + 1);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  InstancedMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InstancedMeshes::InstancedMeshes()
+{
+	m_vao = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+
+	m_instanceBuffer = 0;
+	m_instanceDataBuffer = 0;
+	m_instanceCapacity = 0;
+	m_sourceBuffer = 0;
+	m_sourceMatrixOffset = 0;
+	m_sourceDataOffset = 0;
+
+	m_indirectBuffer = 0;
+	m_commandCount = 0;
+
+	m_bCacheStale = false;
+	m_cachedMeshCount = 0;
+}
+
+/***********************************************************
+ *  ~InstancedMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InstancedMeshes::~InstancedMeshes()
+{
+	if (m_vao != 0)
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = 0;
+	}
+
+	GLuint buffers[5] = { m_vertexBuffer, m_indexBuffer, m_instanceBuffer, m_instanceDataBuffer, m_indirectBuffer };
+	for (int i = 0; i < 5; i++)
+	{
+		if (buffers[i] != 0)
+		{
+			glDeleteBuffers(1, &buffers[i]);
+		}
+	}
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_instanceBuffer = 0;
+	m_instanceDataBuffer = 0;
+	m_indirectBuffer = 0;
+}
+
+/***********************************************************
+ *  LoadPlaneMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  plane lying in the XZ plane, from -1.0 to 1.0 on both
+ *  axes and facing up.
+ ***********************************************************/
+int InstancedMeshes::LoadPlaneMesh()
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_PLANE, 0, 0, 0.0f);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	AddQuad(vertices, indices,
+		glm::vec3(-1.0f, 0.0f, 1.0f),
+		glm::vec3(1.0f, 0.0f, 1.0f),
+		glm::vec3(1.0f, 0.0f, -1.0f),
+		glm::vec3(-1.0f, 0.0f, -1.0f));
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  LoadPrismMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  triangular prism that fits in a 1.0 unit cube centered
+ *  on the origin, with its triangles facing along Z.
+ ***********************************************************/
+int InstancedMeshes::LoadPrismMesh()
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_PRISM, 0, 0, 0.0f);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	glm::vec3 frontLeft(-0.5f, -0.5f, 0.5f);
+	glm::vec3 frontRight(0.5f, -0.5f, 0.5f);
+	glm::vec3 frontTop(0.0f, 0.5f, 0.5f);
+	glm::vec3 backLeft(-0.5f, -0.5f, -0.5f);
+	glm::vec3 backRight(0.5f, -0.5f, -0.5f);
+	glm::vec3 backTop(0.0f, 0.5f, -0.5f);
+
+	// the triangle faces
+	GLuint first = VertexCount(vertices);
+	AddVertex(vertices, frontLeft, glm::vec3(0.0f, 0.0f, 1.0f), 0.0f, 0.0f);
+	AddVertex(vertices, frontRight, glm::vec3(0.0f, 0.0f, 1.0f), 1.0f, 0.0f);
+	AddVertex(vertices, frontTop, glm::vec3(0.0f, 0.0f, 1.0f), 0.5f, 1.0f);
+	AddVertex(vertices, backRight, glm::vec3(0.0f, 0.0f, -1.0f), 0.0f, 0.0f);
+	AddVertex(vertices, backLeft, glm::vec3(0.0f, 0.0f, -1.0f), 1.0f, 0.0f);
+	AddVertex(vertices, backTop, glm::vec3(0.0f, 0.0f, -1.0f), 0.5f, 1.0f);
+	for (GLuint i = 0; i < 6; i++)
+	{
+		indices.push_back(first + i);
+	}
+
+	// the rectangle faces
+	AddQuad(vertices, indices, backLeft, backRight, frontRight, frontLeft);
+	AddQuad(vertices, indices, frontRight, backRight, backTop, frontTop);
+	AddQuad(vertices, indices, backLeft, frontLeft, frontTop, backTop);
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  LoadBoxMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  1.0 unit cube centered on the origin, with the whole of
+ *  the texture mapped onto every face.
+ ***********************************************************/
+int InstancedMeshes::LoadBoxMesh()
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_BOX, 0, 0, 0.0f);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	// the two axes along each face, chosen so that their cross
+	// product points out of the box
+	const glm::vec3 faceNormals[6] = {
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) };
+	const glm::vec3 faceAcross[6] = {
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) };
+	const glm::vec3 faceUp[6] = {
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec3 center = faceNormals[face] * 0.5f;
+		glm::vec3 across = faceAcross[face] * 0.5f;
+		glm::vec3 up = faceUp[face] * 0.5f;
+
+		AddQuad(vertices, indices,
+			center - across - up,
+			center + across - up,
+			center + across + up,
+			center - across + up);
+	}
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  cylinder with a radius of 1.0, standing on the XZ plane
+ *  and reaching up to a height of 1.0, with both caps. The
+ *  segments define how finely the round side is divided.
+ ***********************************************************/
+int InstancedMeshes::LoadCylinderMesh(int segments)
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_CYLINDER, segments, 0, 0.0f);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	// one extra column of vertices on the seam so the texture
+	// coordinates can wrap from 1.0 back to 0.0
+	GLuint first = VertexCount(vertices);
+	for (int i = 0; i <= segments; i++)
+	{
+		float u = (float)i / segments;
+		float angle = u * g_TwoPi;
+		glm::vec3 normal(cos(angle), 0.0f, sin(angle));
+
+		AddVertex(vertices, glm::vec3(normal.x, 0.0f, normal.z), normal, u, 0.0f);
+		AddVertex(vertices, glm::vec3(normal.x, 1.0f, normal.z), normal, u, 1.0f);
+	}
+	for (int i = 0; i < segments; i++)
+	{
+		GLuint bottom = first + (i * 2);
+
+		indices.push_back(bottom);
+		indices.push_back(bottom + 1);
+		indices.push_back(bottom + 3);
+		indices.push_back(bottom);
+		indices.push_back(bottom + 3);
+		indices.push_back(bottom + 2);
+	}
+
+	AddDisc(vertices, indices, 1.0f, true, segments);
+	AddDisc(vertices, indices, 0.0f, false, segments);
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  LoadConeMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  cone with a base radius of 1.0, standing on the XZ plane
+ *  with its tip at a height of 1.0. The segments define how
+ *  finely the round side is divided.
+ ***********************************************************/
+int InstancedMeshes::LoadConeMesh(int segments)
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_CONE, segments, 0, 0.0f);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	// the slope of the side is 45 degrees, so the normals
+	// lean up by the same amount everywhere
+	GLuint first = VertexCount(vertices);
+	for (int i = 0; i <= segments; i++)
+	{
+		float u = (float)i / segments;
+		float angle = u * g_TwoPi;
+		// the tip gets its own vertex per segment, with the
+		// normal of the middle of that segment
+		float tipAngle = (u + (0.5f / segments)) * g_TwoPi;
+
+		glm::vec3 normal = glm::normalize(glm::vec3(cos(angle), 1.0f, sin(angle)));
+		glm::vec3 tipNormal = glm::normalize(glm::vec3(cos(tipAngle), 1.0f, sin(tipAngle)));
+
+		AddVertex(vertices, glm::vec3(cos(angle), 0.0f, sin(angle)), normal, u, 0.0f);
+		AddVertex(vertices, glm::vec3(0.0f, 1.0f, 0.0f), tipNormal, u, 1.0f);
+	}
+	for (int i = 0; i < segments; i++)
+	{
+		GLuint bottom = first + (i * 2);
+
+		indices.push_back(bottom);
+		indices.push_back(bottom + 1);
+		indices.push_back(bottom + 2);
+	}
+
+	AddDisc(vertices, indices, 0.0f, false, segments);
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  LoadTorusMesh()
+ *
+ *  This method is used for generating the vertex data of a
+ *  torus lying in the XY plane, with a main radius of 1.0
+ *  and a tube radius of the passed in thickness, divided
+ *  into the passed in number of segments around the main
+ *  ring and around the tube.
+ ***********************************************************/
+int InstancedMeshes::LoadTorusMesh(
+	float thickness,
+	int mainSegments,
+	int tubeSegments)
+{
+	MeshCache::MESH_KEY key = MakeMeshKey(SHAPE_TORUS, mainSegments, tubeSegments, thickness);
+	int meshID = FindCachedMesh(key);
+	if (meshID >= 0)
+	{
+		return(meshID);
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	// generate one extra ring of vertices on each seam so the
+	// texture coordinates can wrap from 1.0 back to 0.0
+	for (int i = 0; i <= mainSegments; i++)
+	{
+		float u = (float)i / mainSegments;
+		float mainAngle = u * g_TwoPi;
+
+		for (int j = 0; j <= tubeSegments; j++)
+		{
+			float v = (float)j / tubeSegments;
+			float tubeAngle = v * g_TwoPi;
+
+			// normal of the tube surface at this vertex
+			glm::vec3 normal(
+				cos(tubeAngle) * cos(mainAngle),
+				cos(tubeAngle) * sin(mainAngle),
+				sin(tubeAngle));
+			// center of the tube at this vertex
+			glm::vec3 center(
+				g_TorusMainRadius * cos(mainAngle),
+				g_TorusMainRadius * sin(mainAngle),
+				0.0f);
+			glm::vec3 position = center + (normal * thickness);
+
+			AddVertex(vertices, position, normal, u, v);
+		}
+	}
+
+	// two triangles for each quad between neighboring rings
+	for (int i = 0; i < mainSegments; i++)
+	{
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			GLuint current = i * (tubeSegments + 1) + j;
+			GLuint next = current + (tubeSegments + 1);
+
+			indices.push_back(current);
+			indices.push_back(next);
+			indices.push_back(current + 1);
+
+			indices.push_back(current + 1);
+			indices.push_back(next);
+			indices.push_back(next + 1);
+		}
+	}
+
+	return(AddMesh(key, vertices, indices));
+}
+
+/***********************************************************
+ *  OpenMeshCache()
+ *
+ *  This method is used for mapping the mesh cache written
+ *  by an earlier launch, so that the meshes loaded next are
+ *  taken from it instead of being generated. The name is
+ *  kept for writing the cache again, when it is missing or
+ *  holds other meshes.
+ ***********************************************************/
+void InstancedMeshes::OpenMeshCache(const char* filename)
+{
+	if (m_meshes.size() > 0)
+	{
+		std::cout << "The mesh cache needs to be opened before the first mesh is loaded" << std::endl;
+		return;
+	}
+
+	m_cacheFilename = filename;
+	m_meshCache.Open(filename);
+}
+
+/***********************************************************
+ *  MakeMeshKey()
+ *
+ *  This method is used for filling in the key a mesh is
+ *  found by in the cache, from its shape and the parameters
+ *  it is generated with.
+ ***********************************************************/
+MeshCache::MESH_KEY InstancedMeshes::MakeMeshKey(
+	MESH_SHAPE shape,
+	int segments0,
+	int segments1,
+	float thickness)
+{
+	MeshCache::MESH_KEY key;
+	key.shape = (uint32_t)shape;
+	key.segments[0] = (uint32_t)segments0;
+	key.segments[1] = (uint32_t)segments1;
+	key.thickness = thickness;
+
+	return(key);
+}
+
+/***********************************************************
+ *  FindCachedMesh()
+ *
+ *  This method is used for taking the next mesh of the
+ *  cache, when it was generated with the same key as the
+ *  mesh being loaded. Its range of the cached arrays is the
+ *  range it gets in the shared buffers. Once a mesh differs
+ *  from the cache, the meshes taken from it so far are
+ *  copied out, and every following mesh is generated.
+ ***********************************************************/
+int InstancedMeshes::FindCachedMesh(const MeshCache::MESH_KEY& key)
+{
+	if (m_meshCache.IsOpen() == false)
+	{
+		return(-1);
+	}
+
+	int meshID = (int)m_meshes.size();
+	if ((meshID < m_meshCache.GetMeshCount()) &&
+		(memcmp(&m_meshCache.GetMeshes()[meshID].key, &key, sizeof(key)) == 0))
+	{
+		m_meshes.push_back(m_meshCache.GetMeshes()[meshID]);
+		m_cachedMeshCount++;
+		return(meshID);
+	}
+
+	if (meshID > 0)
+	{
+		const MeshCache::MESH_RECORD& lastMesh = m_meshes.back();
+		m_vertices.assign(
+			m_meshCache.GetVertices(),
+			m_meshCache.GetVertices() + lastMesh.baseVertex + lastMesh.vertexCount);
+		m_indices.assign(
+			m_meshCache.GetIndices(),
+			m_meshCache.GetIndices() + lastMesh.firstIndex + lastMesh.indexCount);
+	}
+	m_meshCache.Close();
+
+	return(-1);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for appending the generated vertex
+ *  data of a mesh to the shared vertex and index arrays.
+ *  The vertices are packed, and the triangles and then the
+ *  vertices are reordered for the caches of the GPU. The
+ *  indices stay relative to the first vertex of the mesh,
+ *  which is passed as the base vertex when drawing.
+ ***********************************************************/
+int InstancedMeshes::AddMesh(
+	const MeshCache::MESH_KEY& key,
+	const std::vector<GLfloat>& vertices,
+	const std::vector<GLuint>& indices)
+{
+	std::vector<MeshCache::PACKED_VERTEX> packedVertices;
+	packedVertices.reserve(VertexCount(vertices));
+	for (unsigned int i = 0; i + g_FloatsPerVertex <= vertices.size(); i += g_FloatsPerVertex)
+	{
+		packedVertices.push_back(MeshCache::PackVertex(
+			glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]),
+			glm::vec3(vertices[i + 3], vertices[i + 4], vertices[i + 5]),
+			vertices[i + 6],
+			vertices[i + 7]));
+	}
+
+	std::vector<GLuint> orderedIndices(indices);
+	MeshCache::OptimizeVertexCache(orderedIndices, (GLuint)packedVertices.size());
+	MeshCache::OptimizeVertexFetch(orderedIndices, packedVertices);
+
+	MeshCache::MESH_RECORD mesh;
+	memset(&mesh, 0, sizeof(mesh));
+	mesh.key = key;
+	mesh.firstIndex = (uint32_t)m_indices.size();
+	mesh.indexCount = (uint32_t)orderedIndices.size();
+	mesh.baseVertex = (int32_t)m_vertices.size();
+	mesh.vertexCount = (uint32_t)packedVertices.size();
+
+	// the bounds are taken from the packed positions, which are
+	// the ones that get drawn
+	glm::vec3 minimum(0.0f);
+	glm::vec3 maximum(0.0f);
+	for (unsigned int i = 0; i < packedVertices.size(); i++)
+	{
+		glm::vec3 position = MeshCache::UnpackPosition(packedVertices[i]);
+		if (i == 0)
+		{
+			minimum = position;
+			maximum = position;
+		}
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		mesh.minimum[axis] = minimum[axis];
+		mesh.maximum[axis] = maximum[axis];
+	}
+
+	m_vertices.insert(m_vertices.end(), packedVertices.begin(), packedVertices.end());
+	m_indices.insert(m_indices.end(), orderedIndices.begin(), orderedIndices.end());
+	m_meshes.push_back(mesh);
+	m_bCacheStale = true;
+
+	return((int)m_meshes.size() - 1);
+}
+
+/***********************************************************
+ *  UploadMeshes()
+ *
+ *  This method is used for uploading the loaded meshes into
+ *  the shared vertex and index buffers. When every mesh came
+ *  from the cache, the arrays are uploaded straight from the
+ *  mapped file, otherwise the generated ones are uploaded
+ *  and written into the cache for the next launch.
+ ***********************************************************/
+void InstancedMeshes::UploadMeshes()
+{
+	if (m_vao == 0)
+	{
+		CreateVertexArray();
+	}
+
+	const MeshCache::PACKED_VERTEX* pVertices = m_vertices.data();
+	size_t vertexCount = m_vertices.size();
+	const GLuint* pIndices = m_indices.data();
+	size_t indexCount = m_indices.size();
+	if ((m_meshCache.IsOpen() == true) && (m_meshes.size() > 0))
+	{
+		const MeshCache::MESH_RECORD& lastMesh = m_meshes.back();
+		pVertices = m_meshCache.GetVertices();
+		vertexCount = lastMesh.baseVertex + lastMesh.vertexCount;
+		pIndices = m_meshCache.GetIndices();
+		indexCount = lastMesh.firstIndex + lastMesh.indexCount;
+	}
+
+	glBindVertexArray(m_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(MeshCache::PACKED_VERTEX) * vertexCount, pVertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indexCount, pIndices, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (m_cacheFilename.empty() == false)
+	{
+		if (m_bCacheStale == true)
+		{
+			MeshCache::Write(m_cacheFilename.c_str(), m_meshes, m_vertices, m_indices);
+			m_bCacheStale = false;
+		}
+		std::cout << "INFO: " << m_cachedMeshCount << " of " << m_meshes.size()
+			<< " meshes mapped from the mesh cache" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ReserveInstances()
+ *
+ *  This method is used for sizing the instance buffers so
+ *  that they can hold the passed in number of instances.
+ *  The buffers only ever grow.
+ ***********************************************************/
+void InstancedMeshes::ReserveInstances(int instanceCount)
+{
+	if (m_vao == 0)
+	{
+		CreateVertexArray();
+	}
+
+	if (instanceCount > m_instanceCapacity)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * instanceCount, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceDataBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(INSTANCE_DATA) * instanceCount, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_instanceCapacity = instanceCount;
+	}
+}
+
+/***********************************************************
+ *  SetInstanceMatrices()
+ *
+ *  This method is used for copying the passed in model
+ *  matrices into a range of the instance buffer.
+ ***********************************************************/
+void InstancedMeshes::SetInstanceMatrices(
+	int firstInstance,
+	int instanceCount,
+	const glm::mat4* modelMatrices)
+{
+	if ((firstInstance < 0) || (firstInstance + instanceCount > m_instanceCapacity))
+	{
+		std::cout << "Instance range " << firstInstance << "-" << firstInstance + instanceCount
+			<< " is outside the instance buffer" << std::endl;
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferSubData(
+		GL_ARRAY_BUFFER,
+		sizeof(glm::mat4) * firstInstance,
+		sizeof(glm::mat4) * instanceCount,
+		modelMatrices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetInstanceData()
+ *
+ *  This method is used for copying the passed in draw
+ *  values into a range of the instance data buffer.
+ ***********************************************************/
+void InstancedMeshes::SetInstanceData(
+	int firstInstance,
+	int instanceCount,
+	const INSTANCE_DATA* instanceData)
+{
+	if ((firstInstance < 0) || (firstInstance + instanceCount > m_instanceCapacity))
+	{
+		std::cout << "Instance range " << firstInstance << "-" << firstInstance + instanceCount
+			<< " is outside the instance buffer" << std::endl;
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceDataBuffer);
+	glBufferSubData(
+		GL_ARRAY_BUFFER,
+		sizeof(INSTANCE_DATA) * firstInstance,
+		sizeof(INSTANCE_DATA) * instanceCount,
+		instanceData);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetInstanceSource()
+ *
+ *  This method is used for reading the model matrices and
+ *  draw values from the passed in offsets of another buffer,
+ *  so that data written into it every frame is drawn from
+ *  where it was written.
+ ***********************************************************/
+void InstancedMeshes::SetInstanceSource(
+	GLuint buffer,
+	GLintptr matrixOffset,
+	GLintptr dataOffset)
+{
+	m_sourceBuffer = buffer;
+	m_sourceMatrixOffset = (buffer != 0) ? matrixOffset : 0;
+	m_sourceDataOffset = (buffer != 0) ? dataOffset : 0;
+}
+
+/***********************************************************
+ *  DrawMeshInstanced()
+ *
+ *  This method is used for drawing one copy of the mesh
+ *  for every instance in the passed in range of the
+ *  instance buffers, with a single draw call.
+ ***********************************************************/
+void InstancedMeshes::DrawMeshInstanced(
+	int meshID,
+	int firstInstance,
+	int instanceCount)
+{
+	if ((meshID < 0) || (meshID >= (int)m_meshes.size()) || (instanceCount <= 0))
+	{
+		return;
+	}
+
+	const MeshCache::MESH_RECORD& mesh = m_meshes[meshID];
+
+	glBindVertexArray(m_vao);
+	BindInstanceRange(firstInstance);
+	glDrawElementsInstancedBaseVertex(
+		GL_TRIANGLES,
+		mesh.indexCount,
+		GL_UNSIGNED_INT,
+		(void*)(sizeof(GLuint) * mesh.firstIndex),
+		instanceCount,
+		mesh.baseVertex);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  IsIndirectSupported()
+ *
+ *  This method is used for checking whether the context
+ *  supports multi-draw indirect with a base instance.
+ ***********************************************************/
+bool InstancedMeshes::IsIndirectSupported()
+{
+	return(GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+}
+
+/***********************************************************
+ *  MakeDrawCommand()
+ *
+ *  This method is used for filling in the indirect draw
+ *  command for a range of instances of a mesh. The base
+ *  instance selects where the instance attributes start
+ *  reading, so each command finds its own model matrices
+ *  and draw values.
+ ***********************************************************/
+InstancedMeshes::DRAW_COMMAND InstancedMeshes::MakeDrawCommand(
+	int meshID,
+	int firstInstance,
+	int instanceCount) const
+{
+	DRAW_COMMAND command;
+	command.count = 0;
+	command.instanceCount = 0;
+	command.firstIndex = 0;
+	command.baseVertex = 0;
+	command.baseInstance = 0;
+
+	if ((meshID >= 0) && (meshID < (int)m_meshes.size()))
+	{
+		const MeshCache::MESH_RECORD& mesh = m_meshes[meshID];
+
+		command.count = mesh.indexCount;
+		command.instanceCount = instanceCount;
+		command.firstIndex = mesh.firstIndex;
+		command.baseVertex = mesh.baseVertex;
+		command.baseInstance = firstInstance;
+	}
+
+	return(command);
+}
+
+/***********************************************************
+ *  SetDrawCommands()
+ *
+ *  This method is used for replacing the contents of the
+ *  indirect buffer with the passed in draw commands.
+ ***********************************************************/
+void InstancedMeshes::SetDrawCommands(const DRAW_COMMAND* pCommands, int commandCount)
+{
+	if (m_indirectBuffer == 0)
+	{
+		glGenBuffers(1, &m_indirectBuffer);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DRAW_COMMAND) * commandCount, pCommands, GL_STATIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	m_commandCount = commandCount;
+}
+
+/***********************************************************
+ *  DrawIndirect()
+ *
+ *  This method is used for drawing a range of the commands
+ *  in the indirect buffer with a single draw call. When
+ *  instance buffers are passed in, the instance attributes
+ *  are read from them instead of the shared ones.
+ ***********************************************************/
+void InstancedMeshes::DrawIndirect(
+	int firstCommand,
+	int commandCount,
+	GLuint instanceBuffer,
+	GLuint instanceDataBuffer)
+{
+	if ((firstCommand < 0) || (commandCount <= 0) || (firstCommand + commandCount > m_commandCount))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_vao);
+	// the base instance of each command does the offsetting
+	BindInstanceRange(0, instanceBuffer, instanceDataBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	glMultiDrawElementsIndirect(
+		GL_TRIANGLES,
+		GL_UNSIGNED_INT,
+		(void*)(sizeof(DRAW_COMMAND) * firstCommand),
+		commandCount,
+		0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	// leave the shared buffers bound for the other draw paths
+	if ((instanceBuffer != 0) || (instanceDataBuffer != 0))
+	{
+		BindInstanceRange(0);
+	}
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  GetIndexCount()
+ *
+ *  This method is used for getting the number of indices
+ *  drawn for one copy of a loaded mesh.
+ ***********************************************************/
+int InstancedMeshes::GetIndexCount(int meshID) const
+{
+	if ((meshID < 0) || (meshID >= (int)m_meshes.size()))
+	{
+		return(0);
+	}
+
+	return((int)m_meshes[meshID].indexCount);
+}
+
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the object space box
+ *  that encloses the generated vertices of a loaded mesh,
+ *  for culling the objects drawn with it.
+ ***********************************************************/
+void InstancedMeshes::GetMeshBounds(
+	int meshID,
+	glm::vec3& minimum,
+	glm::vec3& maximum) const
+{
+	if ((meshID < 0) || (meshID >= (int)m_meshes.size()))
+	{
+		minimum = glm::vec3(0.0f);
+		maximum = glm::vec3(0.0f);
+		return;
+	}
+
+	const MeshCache::MESH_RECORD& mesh = m_meshes[meshID];
+	minimum = glm::vec3(mesh.minimum[0], mesh.minimum[1], mesh.minimum[2]);
+	maximum = glm::vec3(mesh.maximum[0], mesh.maximum[1], mesh.maximum[2]);
+}
+
+/***********************************************************
+ *  CreateVertexArray()
+ *
+ *  This method is used for creating the vertex array object
+ *  with the shared vertex and index buffers, and configuring
+ *  the per-vertex and per-instance attributes.
+ ***********************************************************/
+void InstancedMeshes::CreateVertexArray()
+{
+	const GLsizei stride = sizeof(MeshCache::PACKED_VERTEX);
+
+	glGenVertexArrays(1, &m_vao);
+	glBindVertexArray(m_vao);
+
+	// create the buffers for the vertex data, the indices and the instances
+	glGenBuffers(1, &m_vertexBuffer);
+	glGenBuffers(1, &m_indexBuffer);
+	glGenBuffers(1, &m_instanceBuffer);
+	glGenBuffers(1, &m_instanceDataBuffer);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+
+	// the attributes are packed, but are read as the same floats
+	// as the ones of the ShapeMeshes, so the same shader attributes
+	// can be used for both
+	glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(sizeof(GLhalf) * 4));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)((sizeof(GLhalf) * 4) + sizeof(GLuint)));
+	glEnableVertexAttribArray(2);
+
+	// a mat4 attribute takes up four vec4 attribute locations,
+	// each of which advances once per drawn instance
+	for (GLuint column = 0; column < 4; column++)
+	{
+		GLuint location = INSTANCE_MATRIX_LOCATION + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+	glEnableVertexAttribArray(INSTANCE_DATA_LOCATION);
+	glVertexAttribDivisor(INSTANCE_DATA_LOCATION, 1);
+	BindInstanceRange(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindInstanceRange()
+ *
+ *  This method is used for pointing the instance attributes
+ *  of the vertex array at the first instance to draw, so
+ *  that several batches can share the instance buffers.
+ *  Buffers that are not passed in default to the instance
+ *  source, or else to the shared instance buffers.
+ ***********************************************************/
+void InstancedMeshes::BindInstanceRange(
+	int firstInstance,
+	GLuint instanceBuffer,
+	GLuint instanceDataBuffer)
+{
+	GLintptr offset = sizeof(glm::mat4) * firstInstance;
+	GLintptr dataOffset = sizeof(INSTANCE_DATA) * firstInstance;
+
+	if (instanceBuffer == 0)
+	{
+		instanceBuffer = GetInstanceBuffer();
+		offset += m_sourceMatrixOffset;
+	}
+	if (instanceDataBuffer == 0)
+	{
+		instanceDataBuffer = GetInstanceDataBuffer();
+		dataOffset += m_sourceDataOffset;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glVertexAttribPointer(
+			INSTANCE_MATRIX_LOCATION + column,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(glm::mat4),
+			(void*)(offset + (sizeof(glm::vec4) * column)));
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceDataBuffer);
+	glVertexAttribIPointer(
+		INSTANCE_DATA_LOCATION,
+		2,
+		GL_INT,
+		sizeof(INSTANCE_DATA),
+		(void*)dataOffset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
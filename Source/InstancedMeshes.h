@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.h
+// ============
+// create meshes for 3D primitives that are repeated many times in a scene,
+// so that every copy can be drawn with a single instanced draw call, and
+// every mesh of the scene with a single multi-draw indirect call
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshCache.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// number of levels of detail the round meshes are generated with,
+// this value needs to match the one in the culling compute shader
+#define MESH_LOD_LEVELS 3
+
+/***********************************************************
+ *  InstancedMeshes
+ *
+ *  This class generates the vertex data for the basic 3D
+ *  primitives into one shared vertex and index buffer, or
+ *  maps it in from the mesh cache of an earlier launch, and
+ *  draws the copies of each mesh at once, reading a model
+ *  matrix and draw values per instance from the instance
+ *  buffers. The draws can also be written into an indirect
+ *  buffer, so that a whole range of meshes is drawn with a
+ *  single multi-draw call.
+ ***********************************************************/
+class InstancedMeshes
+{
+public:
+	// constructor
+	InstancedMeshes();
+	// destructor
+	~InstancedMeshes();
+
+	// vertex attribute location of the first column of the
+	// per-instance model matrix - it uses this and the next
+	// three locations
+	static const GLuint INSTANCE_MATRIX_LOCATION = 3;
+	// vertex attribute location of the per-instance draw values
+	static const GLuint INSTANCE_DATA_LOCATION = 7;
+
+	// per-instance draw values read by the shader
+	struct INSTANCE_DATA
+	{
+		GLint materialIndex;
+		GLint textureLayer;
+	};
+
+	// layout of a command in the indirect buffer, as read by
+	// glMultiDrawElementsIndirect
+	struct DRAW_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// load the meshes into the shared buffers, each method
+	// returns the ID of the loaded mesh for the draw methods -
+	// the round meshes can be loaded several times with fewer
+	// segments, as coarser levels of detail
+	int LoadPlaneMesh();
+	int LoadPrismMesh();
+	int LoadBoxMesh();
+	int LoadCylinderMesh(int segments = 36);
+	int LoadConeMesh(int segments = 36);
+	int LoadTorusMesh(float thickness = 0.1f, int mainSegments = 30, int tubeSegments = 30);
+	// take the meshes from the passed in cache file, for as long
+	// as they are loaded in the order and with the parameters they
+	// were cached with - called before the first mesh is loaded,
+	// the file is written again when any mesh had to be generated
+	void OpenMeshCache(const char* filename);
+	// upload the loaded meshes into the shared buffers, once they
+	// are all loaded and before any of them is drawn
+	void UploadMeshes();
+
+	// size the instance buffers to hold the passed in number
+	// of instances
+	void ReserveInstances(int instanceCount);
+	// copy model matrices into a range of the instance buffer
+	void SetInstanceMatrices(
+		int firstInstance,
+		int instanceCount,
+		const glm::mat4* modelMatrices);
+	// copy draw values into a range of the instance buffer
+	void SetInstanceData(
+		int firstInstance,
+		int instanceCount,
+		const INSTANCE_DATA* instanceData);
+
+	// read the instance attributes from the passed in ranges of
+	// another buffer, such as the region of the current frame
+	// in a ring buffer, passing in 0 goes back to the shared
+	// instance buffers
+	void SetInstanceSource(GLuint buffer, GLintptr matrixOffset, GLintptr dataOffset);
+
+	// draw one copy of the mesh per instance in the passed in
+	// range of the instance buffers
+	void DrawMeshInstanced(int meshID, int firstInstance, int instanceCount);
+
+	// whether the multi-draw indirect path can be used
+	static bool IsIndirectSupported();
+	// fill in the draw command for a range of instances of a mesh
+	DRAW_COMMAND MakeDrawCommand(int meshID, int firstInstance, int instanceCount) const;
+	// replace the contents of the indirect buffer
+	void SetDrawCommands(const DRAW_COMMAND* pCommands, int commandCount);
+	// draw a range of the commands in the indirect buffer, the
+	// instance attributes can be read from other buffers with
+	// the same layout, such as the output of the culling pass
+	void DrawIndirect(
+		int firstCommand,
+		int commandCount,
+		GLuint instanceBuffer = 0,
+		GLuint instanceDataBuffer = 0);
+
+	// buffers the instances and draw commands are stored in, and
+	// where in them the first instance starts
+	GLuint GetInstanceBuffer() const { return((m_sourceBuffer != 0) ? m_sourceBuffer : m_instanceBuffer); }
+	GLuint GetInstanceDataBuffer() const { return((m_sourceBuffer != 0) ? m_sourceBuffer : m_instanceDataBuffer); }
+	GLintptr GetInstanceOffset() const { return(m_sourceMatrixOffset); }
+	GLintptr GetInstanceDataOffset() const { return(m_sourceDataOffset); }
+	GLuint GetIndirectBuffer() const { return(m_indirectBuffer); }
+
+	// number of indices drawn for one copy of a mesh
+	int GetIndexCount(int meshID) const;
+	// object space bounding box of the generated vertices of a mesh
+	void GetMeshBounds(int meshID, glm::vec3& minimum, glm::vec3& maximum) const;
+
+private:
+	// shapes the meshes are generated as, stored in the cache
+	enum MESH_SHAPE
+	{
+		SHAPE_PLANE,
+		SHAPE_PRISM,
+		SHAPE_BOX,
+		SHAPE_CYLINDER,
+		SHAPE_CONE,
+		SHAPE_TORUS
+	};
+
+	// vertex array object and the shared vertex and index buffers
+	GLuint m_vao;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+	// packed vertex data of the generated meshes, which stays
+	// empty while every mesh comes from the cache
+	std::vector<MeshCache::PACKED_VERTEX> m_vertices;
+	std::vector<GLuint> m_indices;
+	// location of each loaded mesh inside of the shared buffers,
+	// and the parameters it was generated with, by mesh ID
+	std::vector<MeshCache::MESH_RECORD> m_meshes;
+	// mapped cache the meshes are taken from, the file it is
+	// written into, whether a generated mesh is missing from it,
+	// and the number of meshes taken from it
+	MeshCache m_meshCache;
+	std::string m_cacheFilename;
+	bool m_bCacheStale;
+	int m_cachedMeshCount;
+
+	// model matrices and draw values of all the instances,
+	// shared by every mesh
+	GLuint m_instanceBuffer;
+	GLuint m_instanceDataBuffer;
+	// number of instances the instance buffers can hold
+	int m_instanceCapacity;
+	// buffer the instance attributes are read from instead of
+	// the shared ones, and the offsets of their first instance
+	GLuint m_sourceBuffer;
+	GLintptr m_sourceMatrixOffset;
+	GLintptr m_sourceDataOffset;
+
+	// draw commands for the multi-draw indirect path
+	GLuint m_indirectBuffer;
+	int m_commandCount;
+
+	// fill in the cache key of a mesh
+	static MeshCache::MESH_KEY MakeMeshKey(MESH_SHAPE shape, int segments0, int segments1, float thickness);
+	// take the next mesh from the cache when it was generated with
+	// the passed in key, returns -1 when it has to be generated
+	int FindCachedMesh(const MeshCache::MESH_KEY& key);
+	// pack and optimize the generated vertex data, and append it
+	// to the shared buffers
+	int AddMesh(
+		const MeshCache::MESH_KEY& key,
+		const std::vector<GLfloat>& vertices,
+		const std::vector<GLuint>& indices);
+	// create the vertex array object and configure its attributes
+	void CreateVertexArray();
+	// point the instance attributes at the first instance to draw
+	void BindInstanceRange(
+		int firstInstance,
+		GLuint instanceBuffer = 0,
+		GLuint instanceDataBuffer = 0);
+};
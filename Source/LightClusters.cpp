@@ -0,0 +1,373 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.cpp
+// ============
+// sort the point lights of the scene into clusters of the view, so that each
+// fragment only evaluates the lights that can reach it
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of clusters in the whole view
+	const int g_ClusterCount = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES;
+	// number of texels each light takes up in its buffer texture
+	const int g_TexelsPerLight = 4;
+
+	// index of a cluster from its tile and slice
+	int ClusterIndex(int x, int y, int slice)
+	{
+		return((((slice * CLUSTER_TILES_Y) + y) * CLUSTER_TILES_X) + x);
+	}
+}
+
+/***********************************************************
+ *  LightClusters()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightClusters::LightClusters()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		m_buffers[i] = 0;
+		m_textures[i] = 0;
+	}
+
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportWidth = 0;
+	m_viewportHeight = 0;
+	m_bClustersValid = false;
+
+	m_tileSize = glm::vec2(1.0f);
+	m_depthScale = 0.0f;
+	m_depthBias = 0.0f;
+	m_maxClusterLights = 0;
+}
+
+/***********************************************************
+ *  ~LightClusters()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightClusters::~LightClusters()
+{
+	if (m_buffers[0] != 0)
+	{
+		glDeleteTextures(3, m_textures);
+		glDeleteBuffers(3, m_buffers);
+	}
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the buffers and the
+ *  buffer textures that the fragment shader reads them
+ *  through - the lights as four RGBA texels each, and the
+ *  cluster ranges and light lists as unsigned integers.
+ ***********************************************************/
+void LightClusters::CreateBuffers()
+{
+	const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+
+	glGenBuffers(3, m_buffers);
+	glGenTextures(3, m_textures);
+
+	for (int i = 0; i < 3; i++)
+	{
+		// a buffer texture needs storage before it is attached
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[i]);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), NULL, GL_DYNAMIC_DRAW);
+
+		glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, formats[i], m_buffers[i]);
+	}
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	UploadLights();
+	m_bClustersValid = false;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for replacing the point lights of
+ *  the scene. The clusters are rebuilt on the next update.
+ ***********************************************************/
+void LightClusters::SetLights(const std::vector<POINT_LIGHT>& lights)
+{
+	m_lights = lights;
+	if ((int)m_lights.size() > MAX_CLUSTER_LIGHTS)
+	{
+		std::cout << "Only the first " << MAX_CLUSTER_LIGHTS << " of "
+			<< m_lights.size() << " point lights are used" << std::endl;
+		m_lights.resize(MAX_CLUSTER_LIGHTS);
+	}
+
+	UploadLights();
+	m_bClustersValid = false;
+}
+
+/***********************************************************
+ *  UploadLights()
+ *
+ *  This method is used for uploading the point lights into
+ *  their buffer texture - position and radius, then the
+ *  ambient, diffuse and specular colors.
+ ***********************************************************/
+void LightClusters::UploadLights()
+{
+	if (m_buffers[0] == 0)
+	{
+		return;
+	}
+
+	std::vector<glm::vec4> texels(std::max((int)m_lights.size(), 1) * g_TexelsPerLight, glm::vec4(0.0f));
+	for (unsigned int i = 0; i < m_lights.size(); i++)
+	{
+		const POINT_LIGHT& light = m_lights[i];
+
+		texels[(i * g_TexelsPerLight) + 0] = glm::vec4(light.position, light.radius);
+		texels[(i * g_TexelsPerLight) + 1] = glm::vec4(light.ambient, 0.0f);
+		texels[(i * g_TexelsPerLight) + 2] = glm::vec4(light.diffuse, 0.0f);
+		texels[(i * g_TexelsPerLight) + 3] = glm::vec4(light.specular, 0.0f);
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[0]);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4) * texels.size(), texels.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  GetSlice()
+ *
+ *  This method is used for finding the slice a view depth
+ *  falls into. The slices get deeper with the distance, so
+ *  that the clusters keep about the same proportions.
+ ***********************************************************/
+int LightClusters::GetSlice(float depth) const
+{
+	int slice = (int)floor((log(std::max(depth, 0.0001f)) * m_depthScale) + m_depthBias);
+	return(std::min(std::max(slice, 0), CLUSTER_SLICES - 1));
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for sorting the point lights into
+ *  the clusters of the camera. The range of each light is
+ *  turned into a box in view space, and that box into the
+ *  screen tiles and depth slices it covers. The lights are
+ *  first counted per cluster, so that all of the lists can
+ *  be packed one after another into a single buffer.
+ ***********************************************************/
+void LightClusters::Update(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportWidth,
+	int viewportHeight)
+{
+	if ((m_bClustersValid == true) &&
+		(view == m_view) &&
+		(projection == m_projection) &&
+		(viewportWidth == m_viewportWidth) &&
+		(viewportHeight == m_viewportHeight))
+	{
+		return;
+	}
+
+	m_view = view;
+	m_projection = projection;
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+	m_bClustersValid = true;
+
+	m_tileSize = glm::vec2(
+		(float)std::max(viewportWidth, 1) / CLUSTER_TILES_X,
+		(float)std::max(viewportHeight, 1) / CLUSTER_TILES_Y);
+
+	// the near and far distances of the projection, for both
+	// perspective and orthographic projections
+	float nearDistance = 0.1f;
+	float farDistance = 100.0f;
+	if (projection[3][3] == 0.0f)
+	{
+		nearDistance = projection[3][2] / (projection[2][2] - 1.0f);
+		farDistance = projection[3][2] / (projection[2][2] + 1.0f);
+	}
+	else
+	{
+		nearDistance = (projection[3][2] + 1.0f) / projection[2][2];
+		farDistance = (projection[3][2] - 1.0f) / projection[2][2];
+	}
+	nearDistance = std::max(nearDistance, 0.0001f);
+	farDistance = std::max(farDistance, nearDistance * 2.0f);
+
+	m_depthScale = CLUSTER_SLICES / log(farDistance / nearDistance);
+	m_depthBias = -(CLUSTER_SLICES * log(nearDistance)) / log(farDistance / nearDistance);
+
+	// the ranges are kept in members, so updating the clusters as
+	// the camera moves does not allocate
+	m_coveredClusters.resize(m_lights.size());
+	m_lightCovers.assign(m_lights.size(), 0);
+	std::vector<LIGHT_CLUSTERS>& covered = m_coveredClusters;
+	std::vector<unsigned char>& bCovers = m_lightCovers;
+
+	for (unsigned int i = 0; i < m_lights.size(); i++)
+	{
+		const POINT_LIGHT& light = m_lights[i];
+		LIGHT_CLUSTERS& range = covered[i];
+
+		// a light without a radius reaches every cluster
+		range.minX = 0;
+		range.maxX = CLUSTER_TILES_X - 1;
+		range.minY = 0;
+		range.maxY = CLUSTER_TILES_Y - 1;
+		range.minSlice = 0;
+		range.maxSlice = CLUSTER_SLICES - 1;
+		bCovers[i] = 1;
+		if (light.radius <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+		float nearest = -center.z - light.radius;
+		float furthest = -center.z + light.radius;
+		if ((furthest < nearDistance) || (nearest > farDistance))
+		{
+			bCovers[i] = 0;
+			continue;
+		}
+		range.minSlice = GetSlice(std::max(nearest, nearDistance));
+		range.maxSlice = GetSlice(std::min(furthest, farDistance));
+
+		// a light reaching past the near plane can cover any
+		// tile, otherwise its view space box is projected
+		if (nearest <= nearDistance)
+		{
+			continue;
+		}
+
+		glm::vec2 screenMin(1.0f);
+		glm::vec2 screenMax(-1.0f);
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 offset(
+				(corner & 1) ? light.radius : -light.radius,
+				(corner & 2) ? light.radius : -light.radius,
+				(corner & 4) ? light.radius : -light.radius);
+			glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+			glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+
+			screenMin = glm::min(screenMin, ndc);
+			screenMax = glm::max(screenMax, ndc);
+		}
+		if ((screenMax.x < -1.0f) || (screenMax.y < -1.0f) || (screenMin.x > 1.0f) || (screenMin.y > 1.0f))
+		{
+			bCovers[i] = 0;
+			continue;
+		}
+
+		range.minX = std::max((int)floor(((screenMin.x * 0.5f) + 0.5f) * CLUSTER_TILES_X), 0);
+		range.maxX = std::min((int)floor(((screenMax.x * 0.5f) + 0.5f) * CLUSTER_TILES_X), CLUSTER_TILES_X - 1);
+		range.minY = std::max((int)floor(((screenMin.y * 0.5f) + 0.5f) * CLUSTER_TILES_Y), 0);
+		range.maxY = std::min((int)floor(((screenMax.y * 0.5f) + 0.5f) * CLUSTER_TILES_Y), CLUSTER_TILES_Y - 1);
+	}
+
+	// count the lights of each cluster
+	m_clusterRanges.assign(g_ClusterCount * 2, 0);
+	for (unsigned int i = 0; i < m_lights.size(); i++)
+	{
+		if (bCovers[i] == 0)
+		{
+			continue;
+		}
+
+		const LIGHT_CLUSTERS& range = covered[i];
+		for (int slice = range.minSlice; slice <= range.maxSlice; slice++)
+		{
+			for (int y = range.minY; y <= range.maxY; y++)
+			{
+				for (int x = range.minX; x <= range.maxX; x++)
+				{
+					m_clusterRanges[(ClusterIndex(x, y, slice) * 2) + 1]++;
+				}
+			}
+		}
+	}
+
+	// place the lists one after another
+	GLuint offset = 0;
+	m_maxClusterLights = 0;
+	for (int i = 0; i < g_ClusterCount; i++)
+	{
+		GLuint count = m_clusterRanges[(i * 2) + 1];
+
+		m_clusterRanges[i * 2] = offset;
+		m_clusterRanges[(i * 2) + 1] = 0;
+		offset += count;
+		m_maxClusterLights = std::max(m_maxClusterLights, (int)count);
+	}
+
+	// fill in the lists
+	m_lightIndices.assign(std::max(offset, (GLuint)1), 0);
+	for (unsigned int i = 0; i < m_lights.size(); i++)
+	{
+		if (bCovers[i] == 0)
+		{
+			continue;
+		}
+
+		const LIGHT_CLUSTERS& range = covered[i];
+		for (int slice = range.minSlice; slice <= range.maxSlice; slice++)
+		{
+			for (int y = range.minY; y <= range.maxY; y++)
+			{
+				for (int x = range.minX; x <= range.maxX; x++)
+				{
+					int cluster = ClusterIndex(x, y, slice) * 2;
+					m_lightIndices[m_clusterRanges[cluster] + m_clusterRanges[cluster + 1]] = i;
+					m_clusterRanges[cluster + 1]++;
+				}
+			}
+		}
+	}
+
+	if (m_buffers[0] != 0)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[1]);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * m_clusterRanges.size(), m_clusterRanges.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[2]);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * m_lightIndices.size(), m_lightIndices.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+}
+
+/***********************************************************
+ *  BindTextures()
+ *
+ *  This method is used for binding the buffer textures of
+ *  the lights, the cluster ranges and the light lists to
+ *  consecutive texture units, starting at the passed in one.
+ ***********************************************************/
+void LightClusters::BindTextures(int firstUnit)
+{
+	for (int i = 0; i < TEXTURE_UNIT_COUNT; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+		glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.h
+// ============
+// sort the point lights of the scene into clusters of the view, so that each
+// fragment only evaluates the lights that can reach it
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// these values need to match the ones in the shader code
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+#define MAX_CLUSTER_LIGHTS 256
+
+/***********************************************************
+ *  LightClusters
+ *
+ *  This class divides the view into screen tiles, and each
+ *  tile into slices along the view depth. Whenever the
+ *  camera or the lights change, every point light is added
+ *  to the list of each cluster its range overlaps. The
+ *  lights, the per-cluster ranges and the light lists are
+ *  stored in buffer textures for the fragment shader, which
+ *  works with the OpenGL 3.3 context on every platform.
+ ***********************************************************/
+class LightClusters
+{
+public:
+	// constructor
+	LightClusters();
+	// destructor
+	~LightClusters();
+
+	// properties of a point light - without a radius the light
+	// reaches the whole scene, with one it fades out to nothing
+	// at that distance
+	struct POINT_LIGHT
+	{
+		glm::vec3 position;
+		float radius;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+	};
+
+	// number of texture units the buffer textures are bound to
+	static const int TEXTURE_UNIT_COUNT = 3;
+
+	// create the buffer textures
+	void CreateBuffers();
+	// replace the point lights of the scene
+	void SetLights(const std::vector<POINT_LIGHT>& lights);
+	// sort the lights into the clusters of the passed in camera,
+	// only when the camera, the viewport or the lights changed
+	void Update(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportWidth,
+		int viewportHeight);
+	// bind the buffer textures to consecutive texture units
+	void BindTextures(int firstUnit);
+
+	// values the shader needs to find the cluster of a fragment
+	glm::vec2 GetTileSize() const { return(m_tileSize); }
+	float GetDepthScale() const { return(m_depthScale); }
+	float GetDepthBias() const { return(m_depthBias); }
+
+	// number of lights, and the most lights found in one cluster
+	int GetLightCount() const { return((int)m_lights.size()); }
+	int GetMaxClusterLights() const { return(m_maxClusterLights); }
+
+private:
+	// one buffer and buffer texture each for the lights, the
+	// offset and count of every cluster, and the light lists
+	GLuint m_buffers[3];
+	GLuint m_textures[3];
+
+	// point lights of the scene
+	std::vector<POINT_LIGHT> m_lights;
+	// camera and viewport the clusters were last built for,
+	// and whether they are still up to date
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	bool m_bClustersValid;
+
+	// size of a tile in pixels, and the factors that turn the
+	// log of the view depth into a slice
+	glm::vec2 m_tileSize;
+	float m_depthScale;
+	float m_depthBias;
+	int m_maxClusterLights;
+
+	// offset and count of each cluster, and the light lists
+	std::vector<GLuint> m_clusterRanges;
+	std::vector<GLuint> m_lightIndices;
+
+	// clusters covered by each light, as tile and slice ranges
+	struct LIGHT_CLUSTERS
+	{
+		int minX, maxX;
+		int minY, maxY;
+		int minSlice, maxSlice;
+	};
+	// clusters of each light and whether it covers any, kept
+	// between updates so their storage is reused
+	std::vector<LIGHT_CLUSTERS> m_coveredClusters;
+	std::vector<unsigned char> m_lightCovers;
+
+	// upload the lights into their buffer texture
+	void UploadLights();
+	// find the slice of a view depth
+	int GetSlice(float depth) const;
+};
@@ -1,186 +1,802 @@
-///////////////////////////////////////////////////////////////////////////////
-// maincode.cpp
-// ============
-// gets called when application is launched - initializes GLEW, GLFW
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
+///////////////////////////////////////////////////////////////////////////////
+// maincode.cpp
+// ============
+// gets called when application is launched - initializes GLEW, GLFW
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <string>           // window title with the profiler summary
+#include <chrono>           // startup time of the benchmark
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "ShaderStateCache.h"
+#include "UniformBlocks.h"
+#include "RingBuffer.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include "Benchmark.h"
+#include "CameraPath.h"
+#include "FrameScheduler.h"
+#include "SceneFile.h"
+#include "RenderTarget.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// uniform state cache that skips redundant shader uploads
+	ShaderStateCache* g_ShaderState = nullptr;
+	// uniform buffers for the camera, lights and materials
+	UniformBlocks* g_UniformBlocks = nullptr;
+	// per-frame allocator for the camera block and the instances
+	RingBuffer* g_RingBuffer = nullptr;
+	// bytes of every ring buffer region for the small blocks, the
+	// scene reserves the room for its instances on top
+	const int RING_BUFFER_FRAME_SIZE = 64 * 1024;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+	// profiler object for timing the parts of every frame
+	Profiler* g_Profiler = nullptr;
+
+	// seconds between updates of the profiler overlay
+	const double PROFILER_OVERLAY_INTERVAL = 0.5;
+
+	// benchmark object for rendering a fixed run of frames offscreen
+	Benchmark* g_Benchmark = nullptr;
+	// frames rendered by a benchmark run unless told otherwise, and
+	// the fixed timestep they are rendered at
+	const int BENCHMARK_FRAMES = 600;
+	const float BENCHMARK_TIMESTEP = 1.0f / 60.0f;
+
+	// frame scheduler object for stepping the input at a fixed rate
+	// and pacing the rendered frames
+	FrameScheduler* g_FrameScheduler = nullptr;
+	// seconds of every update step of the input and the camera
+	const float UPDATE_TIMESTEP = 1.0f / 120.0f;
+
+	// frames still rendered after the last change when rendering on
+	// demand, for the results that lag a frame behind - the culling
+	// done on the GPU and the blending of the camera between steps
+	const int RENDER_SETTLE_FRAMES = 3;
+	// the following variable is true when the window contents were
+	// damaged and have to be rendered again
+	bool g_bWindowDamaged = true;
+
+	// multisampled offscreen target the frames are rendered into at
+	// a scaled size, and resolved onto the window
+	RenderTarget* g_RenderTarget = nullptr;
+	// samples of the target unless told otherwise
+	const int RENDER_TARGET_SAMPLES = 4;
+	// frame time the dynamic resolution keeps the GPU work under
+	// unless the frame rate is capped, and the smallest scale of
+	// the window size it lowers the frames to
+	const double DYNAMIC_RESOLUTION_TARGET = 1000.0 / 60.0;
+	const float DYNAMIC_RESOLUTION_MINIMUM_SCALE = 0.5f;
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+void Window_Refresh_Callback(GLFWwindow* window);
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	// the scene can be run as a benchmark, along a camera path that
+	// can also be recorded from the interactive camera
+	int benchmarkFrames = 0;
+	const char* benchmarkReport = "benchmark.json";
+	const char* cameraPathFile = NULL;
+	const char* recordPathFile = NULL;
+	// the frames are paced by the display, unless capped to a frame
+	// rate or uncapped
+	FrameScheduler::PACING_MODE pacing = FrameScheduler::PACING_VSYNC;
+	double fpsCap = 0.0;
+	// every frame is rendered, unless only the frames that change
+	// anything are asked for
+	bool bRenderOnDemand = false;
+	// the window is created at its default size, and the frames are
+	// rendered into a multisampled target whose resolution drops
+	// while the frames miss the target frame time
+	int windowWidth = 0;
+	int windowHeight = 0;
+	bool bRenderTarget = true;
+	int renderSamples = RENDER_TARGET_SAMPLES;
+	float renderScale = 1.0f;
+	double frameTarget = -1.0;
+
+	// the textures can be baked offline, without opening a window
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bake-textures") == 0)
+		{
+			return(SceneManager::BakeSceneTextures() ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		// and so can the text form of a scene file be converted into
+		// the binary form that is loaded in place
+		if ((strcmp(argv[i], "--convert-scene") == 0) && (i + 2 < argc))
+		{
+			SceneFile sceneFile;
+			bool bConverted = (sceneFile.Open(argv[i + 1]) == true) && (sceneFile.WriteBinary(argv[i + 2]) == true);
+			return(bConverted ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			benchmarkFrames = BENCHMARK_FRAMES;
+		}
+		if (strcmp(argv[i], "--vsync") == 0)
+		{
+			pacing = FrameScheduler::PACING_VSYNC;
+		}
+		if (strcmp(argv[i], "--uncapped") == 0)
+		{
+			pacing = FrameScheduler::PACING_UNCAPPED;
+		}
+		if (strcmp(argv[i], "--on-demand") == 0)
+		{
+			bRenderOnDemand = true;
+		}
+		if (strcmp(argv[i], "--no-render-target") == 0)
+		{
+			bRenderTarget = false;
+		}
+		if (strcmp(argv[i], "--no-dynamic-resolution") == 0)
+		{
+			frameTarget = 0.0;
+		}
+		if ((strcmp(argv[i], "--window") == 0) && (i + 2 < argc))
+		{
+			windowWidth = atoi(argv[i + 1]);
+			windowHeight = atoi(argv[i + 2]);
+		}
+		if (i + 1 < argc)
+		{
+			if (strcmp(argv[i], "--fps-cap") == 0)
+			{
+				pacing = FrameScheduler::PACING_CAPPED;
+				fpsCap = atof(argv[i + 1]);
+			}
+			if (strcmp(argv[i], "--benchmark-frames") == 0)
+			{
+				benchmarkFrames = atoi(argv[i + 1]);
+			}
+			if (strcmp(argv[i], "--benchmark-report") == 0)
+			{
+				benchmarkReport = argv[i + 1];
+			}
+			if (strcmp(argv[i], "--camera-path") == 0)
+			{
+				cameraPathFile = argv[i + 1];
+			}
+			if (strcmp(argv[i], "--record-camera-path") == 0)
+			{
+				recordPathFile = argv[i + 1];
+			}
+			if (strcmp(argv[i], "--msaa") == 0)
+			{
+				renderSamples = atoi(argv[i + 1]);
+			}
+			if (strcmp(argv[i], "--render-scale") == 0)
+			{
+				renderScale = (float)atof(argv[i + 1]);
+			}
+			if (strcmp(argv[i], "--frame-target") == 0)
+			{
+				frameTarget = atof(argv[i + 1]);
+			}
+		}
+	}
+
+	// if GLFW fails initialization, then terminate the application
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// try to create a new shader manager object
+	g_ShaderManager = new ShaderManager();
+	// try to create a new uniform state cache for the shader manager
+	g_ShaderState = new ShaderStateCache(g_ShaderManager);
+	// try to create a new uniform blocks object
+	g_UniformBlocks = new UniformBlocks();
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderManager,
+		g_ShaderState,
+		g_UniformBlocks);
+
+	// try to create the main display window, which is not shown
+	// while benchmarking
+	g_ViewManager->SetHiddenWindow(benchmarkFrames > 0);
+	g_ViewManager->SetWindowSize(windowWidth, windowHeight);
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	if (NULL == g_Window)
+	{
+		return(EXIT_FAILURE);
+	}
+	// this callback is used to receive the window being uncovered
+	// or resized, which needs a new frame when rendering on demand
+	glfwSetWindowRefreshCallback(g_Window, &Window_Refresh_Callback);
+
+	// if GLEW fails initialization, then terminate the application
+	if (InitializeGLEW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// try to create a new frame scheduler object, a benchmark is
+	// neither paced nor run in real time, every frame takes one
+	// benchmark timestep
+	g_FrameScheduler = new FrameScheduler(UPDATE_TIMESTEP);
+	if (benchmarkFrames > 0)
+	{
+		pacing = FrameScheduler::PACING_UNCAPPED;
+		g_FrameScheduler->SetFixedFrameTime(BENCHMARK_TIMESTEP);
+	}
+	g_FrameScheduler->SetPacing(pacing, fpsCap);
+
+	// load the shader code from the external GLSL files
+	g_ShaderManager->LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+	g_ShaderManager->use();
+	// look up the uniform locations once in the loaded program
+	g_ShaderState->LoadUniformLocations();
+	// create the shared uniform buffers and connect them to the program
+	g_UniformBlocks->CreateBuffers();
+	g_UniformBlocks->BindProgram(g_ShaderState->GetProgramID());
+	// try to create a new ring buffer object, whose regions take
+	// turns holding the dynamic data of the frames in flight
+	g_RingBuffer = new RingBuffer();
+	if (g_RingBuffer->Create(RING_BUFFER_FRAME_SIZE) == true)
+	{
+		g_UniformBlocks->SetRingBuffer(g_RingBuffer);
+	}
+
+	// try to create a new scene manager object and prepare the 3D scene
+	g_SceneManager = new SceneManager(g_ShaderManager, g_ShaderState, g_UniformBlocks);
+	if (g_RingBuffer->GetBuffer() != 0)
+	{
+		g_SceneManager->SetRingBuffer(g_RingBuffer);
+	}
+	// the point lights are sorted into clusters of the view, unless
+	// the fixed forward light slots are asked for at startup,
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--forward-lighting") == 0)
+		{
+			g_SceneManager->SetLightingPath(SceneManager::LIGHTING_FORWARD);
+		}
+		// and the draws use shader variants compiled for the scene,
+		// unless the features are to be branched on at runtime
+		if (strcmp(argv[i], "--no-shader-variants") == 0)
+		{
+			g_SceneManager->SetShaderVariants(false);
+		}
+		// and the directional light casts shadows, unless turned off
+		if (strcmp(argv[i], "--no-shadows") == 0)
+		{
+			g_SceneManager->SetShadows(false);
+		}
+		// and the meshes are mapped in from the mesh cache, unless
+		// they are to be generated on every launch
+		if (strcmp(argv[i], "--no-mesh-cache") == 0)
+		{
+			g_SceneManager->SetMeshCache(false);
+		}
+		// and the desk is drawn, unless it is to be replaced with a
+		// number of copies of its props for stress testing
+		if ((strcmp(argv[i], "--stress") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->SetStressScene(atoi(argv[i + 1]));
+		}
+		// or loaded from a scene file in the text or binary form
+		if ((strcmp(argv[i], "--scene") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->SetSceneFile(argv[i + 1]);
+		}
+	}
+	g_SceneManager->PrepareScene();
+
+	// the scene is submitted with multi-draw indirect calls culled on
+	// the GPU when supported, unless another path is asked for, to
+	// compare how the paths scale with the number of objects
+	bool bCulling = true;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--submit") == 0) && (i + 1 < argc))
+		{
+			const char* submitName = argv[i + 1];
+			if (strcmp(submitName, "naive") == 0)
+			{
+				g_SceneManager->SetSubmitMode(SceneManager::SUBMIT_NAIVE);
+			}
+			else if (strcmp(submitName, "instanced") == 0)
+			{
+				g_SceneManager->SetSubmitMode(SceneManager::SUBMIT_INSTANCED);
+			}
+			else if (strcmp(submitName, "indirect") != 0)
+			{
+				std::cout << "Unknown submit mode " << submitName << ", using indirect" << std::endl;
+			}
+		}
+		// and every object is drawn, even outside of the view
+		if (strcmp(argv[i], "--no-culling") == 0)
+		{
+			g_SceneManager->SetFrustumCulling(false);
+			g_SceneManager->SetGpuCulling(false);
+			bCulling = false;
+		}
+	}
+
+	// try to create a new profiler object, with a section for
+	// every part of the frame and a counter for the draw work
+	g_Profiler = new Profiler();
+	const int viewSection = g_Profiler->AddSection("view", true);
+	const int sceneSection = g_Profiler->AddSection("scene", true);
+	const int resolveSection = g_Profiler->AddSection("resolve", true);
+	// the swap waits on the display, its GPU time says nothing
+	const int swapSection = g_Profiler->AddSection("swap", false);
+	const int drawCallCounter = g_Profiler->AddCounter("draws");
+	const int shadowDrawCounter = g_Profiler->AddCounter("shadow_draws");
+	const int uploadCounter = g_Profiler->AddCounter("uploads");
+	const int skippedUploadCounter = g_Profiler->AddCounter("skipped_uploads");
+	const int triangleCounter = g_Profiler->AddCounter("tris");
+	const int visibleCounter = g_Profiler->AddCounter("visible");
+	const int culledCounter = g_Profiler->AddCounter("culled");
+	const int stateChangeCounter = g_Profiler->AddCounter("states");
+	const int heapCounter = g_Profiler->AddCounter("heap_allocs");
+	const int arenaBytesCounter = g_Profiler->AddCounter("arena_bytes");
+	const int ringBytesCounter = g_Profiler->AddCounter("ring_bytes");
+	const int ringWaitCounter = g_Profiler->AddCounter("ring_waits");
+	const int renderScaleCounter = g_Profiler->AddCounter("render_scale");
+	// every frame is written into a CSV file when one is passed in
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--profile-csv") == 0)
+		{
+			g_Profiler->OpenCsv(argv[i + 1]);
+		}
+	}
+	if (Profiler::IsGpuTimingSupported() == false)
+	{
+		std::cout << "GPU timer queries are not supported, profiling the CPU only" << std::endl;
+	}
+
+	// a benchmark renders into an offscreen target the size of the
+	// window, with the camera on a path instead of the user input
+	if (benchmarkFrames > 0)
+	{
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(g_Window, &width, &height);
+
+		g_Benchmark = new Benchmark(benchmarkFrames, BENCHMARK_TIMESTEP);
+		if ((NULL != cameraPathFile) &&
+			(g_Benchmark->GetCameraPath().LoadFile(cameraPathFile) == false))
+		{
+			return(EXIT_FAILURE);
+		}
+		if (g_Benchmark->CreateTarget(width, height) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+
+		g_ViewManager->SetInputEnabled(false);
+		g_Profiler->SetKeepHistory(true);
+		g_Benchmark->AddInfo("objects", g_SceneManager->GetObjectCount());
+		// the indirect mode falls back to instanced draws when it
+		// is not supported
+		const char* submitNames[] = { "naive", "instanced", "indirect" };
+		g_Benchmark->AddInfo("submit", submitNames[g_SceneManager->GetSubmitMode()]);
+		g_Benchmark->AddInfo("culling", bCulling ? "on" : "off");
+		g_Benchmark->AddInfo("ring_buffer", g_RingBuffer->IsPersistent() ? "persistent" : "uploaded");
+		g_Benchmark->SetStartupTime(std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - startTime).count());
+	}
+
+	// the window is drawn through the offscreen target, unless turned
+	// off - a benchmark has its own target at the full window size
+	if ((bRenderTarget == true) && (NULL == g_Benchmark))
+	{
+		int width = 0;
+		int height = 0;
+		g_ViewManager->GetFramebufferSize(width, height);
+
+		g_RenderTarget = new RenderTarget();
+		if (g_RenderTarget->Create(width, height, renderSamples) == true)
+		{
+			// the frames aim for the capped frame rate when there is one
+			if (frameTarget < 0.0)
+			{
+				frameTarget = ((pacing == FrameScheduler::PACING_CAPPED) && (fpsCap > 0.0)) ?
+					1000.0 / fpsCap : DYNAMIC_RESOLUTION_TARGET;
+			}
+			g_RenderTarget->SetScale(renderScale);
+			g_RenderTarget->SetDynamicResolution(frameTarget, DYNAMIC_RESOLUTION_MINIMUM_SCALE);
+			std::cout << "INFO: rendering with " << g_RenderTarget->GetSamples() << "x multisampling";
+			if (frameTarget > 0.0)
+			{
+				std::cout << ", dynamic resolution for " << frameTarget << " ms frames";
+			}
+			std::cout << std::endl;
+		}
+		else
+		{
+			// the frames go straight into the window instead
+			delete g_RenderTarget;
+			g_RenderTarget = NULL;
+		}
+	}
+
+	// the interactive camera is recorded into a path when asked for
+	CameraPath recordedPath;
+	double recordStart = glfwGetTime();
+
+	// frames left to render since the last change, on demand
+	int settleFrames = RENDER_SETTLE_FRAMES;
+	// whether the window title is showing the profiler summary
+	bool bProfilerTitle = false;
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		if ((NULL != g_Benchmark) && (g_Benchmark->IsFinished()))
+		{
+			break;
+		}
+
+		// nothing can be seen of a minimized window, so wait for it
+		// to be restored instead of rendering frames
+		if (glfwGetWindowAttrib(g_Window, GLFW_ICONIFIED) == GLFW_TRUE)
+		{
+			g_FrameScheduler->WaitForEvents(0.0);
+			continue;
+		}
+
+		// when rendering on demand, a frame is only rendered when the
+		// input, the camera, the scene or the window changed - until
+		// then the last presented frame stays on the screen, and the
+		// loop sleeps until the next event
+		if ((bRenderOnDemand == true) && (NULL == g_Benchmark))
+		{
+			if ((g_ViewManager->IsInputActive()) ||
+				(g_ViewManager->ConsumeViewChanged()) ||
+				(g_SceneManager->IsRedrawNeeded()) ||
+				(g_bWindowDamaged == true))
+			{
+				settleFrames = RENDER_SETTLE_FRAMES;
+				g_bWindowDamaged = false;
+			}
+			else if (settleFrames > 0)
+			{
+				settleFrames--;
+			}
+			else
+			{
+				g_FrameScheduler->WaitForEvents(0.0);
+				continue;
+			}
+		}
+
+		g_FrameScheduler->BeginFrame();
+		g_Profiler->BeginFrame();
+		// wait for the ring buffer region the GPU read three frames ago
+		g_RingBuffer->BeginFrame();
+		// the heap allocations of the view and scene work are counted,
+		// steady frames are meant to make none
+		long heapAllocations = AllocationCounter::GetHeapAllocationCount();
+
+		// Enable z-depth
+		glEnable(GL_DEPTH_TEST);
+
+		// restart the per-frame uniform upload counters
+		g_ShaderState->BeginFrame();
+
+		// render into the offscreen target at the scale the GPU time
+		// of the latest finished frame allows, or straight into the
+		// window, at the size it has been resized to - a benchmark
+		// binds its own target, before it is cleared
+		float benchmarkTime = 0.0f;
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+		if (NULL != g_RenderTarget)
+		{
+			g_RenderTarget->UpdateScale(g_Profiler->GetLastWorkTime());
+			if (g_RenderTarget->Resize(framebufferWidth, framebufferHeight) == false)
+			{
+				delete g_RenderTarget;
+				g_RenderTarget = NULL;
+			}
+		}
+		if (NULL != g_Benchmark)
+		{
+			benchmarkTime = g_Benchmark->BeginFrame();
+		}
+		else if (NULL != g_RenderTarget)
+		{
+			g_RenderTarget->Bind();
+		}
+		else
+		{
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+		}
+
+		// Clear the frame and z buffers
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// convert from 3D object space to 2D view, after stepping
+		// the input through the time since the last frame
+		{
+			Profiler::Scope viewScope(g_Profiler, viewSection);
+			while (g_FrameScheduler->StepUpdate())
+			{
+				g_ViewManager->UpdateCamera(g_FrameScheduler->GetTimestep());
+			}
+
+			// a benchmark places the camera on its path instead
+			if (NULL != g_Benchmark)
+			{
+				glm::vec3 position;
+				glm::vec3 front;
+				g_Benchmark->GetCameraPath().Sample(benchmarkTime, position, front);
+				g_ViewManager->SetCameraPose(position, front);
+			}
+
+			g_ViewManager->PrepareSceneView(g_FrameScheduler->GetInterpolation());
+		}
+
+		// refresh the 3D scene
+		{
+			Profiler::Scope sceneScope(g_Profiler, sceneSection);
+			g_SceneManager->RenderScene();
+		}
+
+		// stretch the rendered frame onto the window
+		if (NULL != g_RenderTarget)
+		{
+			Profiler::Scope resolveScope(g_Profiler, resolveSection);
+			g_RenderTarget->Resolve();
+		}
+
+		const SceneManager::DRAW_STATS& drawStats = g_SceneManager->GetDrawStats();
+		g_Profiler->SetCounter(drawCallCounter, drawStats.drawCalls);
+		g_Profiler->SetCounter(shadowDrawCounter, drawStats.shadowDrawCalls);
+		g_Profiler->SetCounter(uploadCounter, g_ShaderState->GetUploadCount());
+		g_Profiler->SetCounter(skippedUploadCounter, g_ShaderState->GetSkippedCount());
+		g_Profiler->SetCounter(triangleCounter, drawStats.triangles);
+		// the frustum culling, through the overlay and the CSV file
+		// rather than printed in the frame loop
+		g_Profiler->SetCounter(visibleCounter, drawStats.visibleObjects);
+		g_Profiler->SetCounter(culledCounter, drawStats.culledObjects);
+		g_Profiler->SetCounter(stateChangeCounter, drawStats.stateChanges);
+		g_Profiler->SetCounter(heapCounter, AllocationCounter::GetHeapAllocationCount() - heapAllocations);
+		g_Profiler->SetCounter(arenaBytesCounter, (double)g_SceneManager->GetFrameArena().GetUsedBytes());
+		g_Profiler->SetCounter(ringBytesCounter, (double)g_RingBuffer->GetFrameBytes());
+		g_Profiler->SetCounter(ringWaitCounter, g_RingBuffer->GetWaitCount());
+		g_Profiler->SetCounter(renderScaleCounter, (NULL != g_RenderTarget) ? g_RenderTarget->GetScale() : 1.0);
+
+		// Flips the the back buffer with the front buffer every frame.
+		{
+			Profiler::Scope swapScope(g_Profiler, swapSection);
+			glfwSwapBuffers(g_Window);
+		}
+		// the region of this frame is written again once the GPU is done
+		g_RingBuffer->EndFrame();
+
+		// query the latest GLFW events
+		glfwPollEvents();
+
+		g_Profiler->EndFrame();
+		g_FrameScheduler->EndFrame();
+
+		if (NULL != g_Benchmark)
+		{
+			g_Benchmark->EndFrame();
+		}
+		if (NULL != recordPathFile)
+		{
+			glm::vec3 position;
+			glm::vec3 front;
+			g_ViewManager->GetCameraPose(position, front);
+			recordedPath.AddKey((float)(glfwGetTime() - recordStart), position, front);
+		}
+
+		// show the averages of the profiler in the window title while
+		// the overlay is toggled on, there is no text drawn in the scene,
+		// and the summary text is only made while it is shown
+		if (g_ViewManager->IsProfilerShown())
+		{
+			bool bSummary = g_Profiler->UpdateSummary(PROFILER_OVERLAY_INTERVAL);
+			if ((bSummary == true) || (bProfilerTitle == false))
+			{
+				std::string title = std::string(WINDOW_TITLE) + " | " + g_Profiler->GetSummary();
+				glfwSetWindowTitle(g_Window, title.c_str());
+				bProfilerTitle = true;
+			}
+		}
+		else if (bProfilerTitle == true)
+		{
+			glfwSetWindowTitle(g_Window, WINDOW_TITLE);
+			bProfilerTitle = false;
+		}
+	}
+
+	if (NULL != recordPathFile)
+	{
+		recordedPath.SaveFile(recordPathFile);
+	}
+
+	// the benchmark is summed up once the last frames are read back
+	bool bBenchmarkWritten = true;
+	if (NULL != g_Benchmark)
+	{
+		g_Profiler->Flush();
+		bBenchmarkWritten = g_Benchmark->WriteReport(benchmarkReport, *g_Profiler);
+		if (bBenchmarkWritten == true)
+		{
+			std::cout << "INFO: benchmark report written to " << benchmarkReport << std::endl;
+		}
+
+		delete g_Benchmark;
+		g_Benchmark = NULL;
+	}
+
+	// the profiler writes out the frames still pending in the CSV file
+	if (NULL != g_Profiler)
+	{
+		delete g_Profiler;
+		g_Profiler = NULL;
+	}
+	if (NULL != g_FrameScheduler)
+	{
+		delete g_FrameScheduler;
+		g_FrameScheduler = NULL;
+	}
+
+	if (NULL != g_RenderTarget)
+	{
+		delete g_RenderTarget;
+		g_RenderTarget = NULL;
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_UniformBlocks)
+	{
+		delete g_UniformBlocks;
+		g_UniformBlocks = NULL;
+	}
+	if (NULL != g_RingBuffer)
+	{
+		delete g_RingBuffer;
+		g_RingBuffer = NULL;
+	}
+	if (NULL != g_ShaderState)
+	{
+		delete g_ShaderState;
+		g_ShaderState = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	// Terminates the program successfully, unless the benchmark
+	// report could not be written
+	exit(bBenchmarkWritten ? EXIT_SUCCESS : EXIT_FAILURE); 
+}
+
+/***********************************************************
+ *	Window_Refresh_Callback()
+ *
+ *  This function is automatically called from GLFW whenever
+ *  the contents of the window need to be rendered again,
+ *  such as after it was uncovered or resized.
+ ***********************************************************/
+void Window_Refresh_Callback(GLFWwindow* /*window*/)
+{
+	g_bWindowDamaged = true;
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
 }
\ No newline at end of file
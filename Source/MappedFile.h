@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory, so its contents can be used in place
+// without reading them into a separate buffer
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps the whole of a file read-only into the
+ *  address space of the process. The pages are read from
+ *  disk as they are touched, and released when the file is
+ *  closed.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file, returns false when it cannot be opened
+	bool Open(const char* filename);
+	// unmap the file
+	void Close();
+
+	// start and size of the mapped file contents
+	const unsigned char* GetData() const { return(m_pData); }
+	size_t GetSize() const { return(m_size); }
+	bool IsOpen() const { return(NULL != m_pData); }
+
+private:
+	// start and size of the mapped file contents
+	const unsigned char* m_pData;
+	size_t m_size;
+	// operating system handles of the file and the mapping
+	void* m_fileHandle;
+	void* m_mappingHandle;
+
+	// the mapping cannot be shared between two objects
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
@@ -0,0 +1,499 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// store the generated meshes quantized and optimized for the vertex cache
+// in a file, so that later launches map them in instead of generating them
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// "MSHC", marks the start of a mesh cache file, and the version
+	// of the mesh generation and vertex packing it was written with,
+	// which needs to change whenever either of them does
+	const uint32_t g_CacheMagic = 0x4348534D;
+	const uint32_t g_CacheVersion = 1;
+
+	// size of the post-transform cache the triangles are ordered
+	// for, and the weights of the vertex scores
+	const int g_OptimizeCacheSize = 32;
+	const float g_CacheDecayPower = 1.5f;
+	const float g_LastTriangleScore = 0.75f;
+	const float g_ValenceBoostScale = 2.0f;
+	const float g_ValenceBoostPower = 0.5f;
+
+	// convert a float into a half float, rounding to the nearest,
+	// values too small for a normal half float become zero
+	GLhalf FloatToHalf(float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+		if (exponent <= 0)
+		{
+			return((GLhalf)sign);
+		}
+		if (exponent >= 31)
+		{
+			return((GLhalf)(sign | 0x7C00));
+		}
+
+		// a carry out of the mantissa moves on to the exponent
+		uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+		uint32_t rest = mantissa & 0x1FFF;
+		if ((rest > 0x1000) || ((rest == 0x1000) && ((half & 1) != 0)))
+		{
+			half++;
+		}
+		return((GLhalf)half);
+	}
+
+	// convert a half float back into a float
+	float HalfToFloat(GLhalf half)
+	{
+		uint32_t sign = ((uint32_t)half & 0x8000) << 16;
+		uint32_t exponent = ((uint32_t)half >> 10) & 0x1F;
+		uint32_t mantissa = (uint32_t)half & 0x3FF;
+
+		if (exponent == 0)
+		{
+			float value = std::ldexp((float)mantissa, -24);
+			return((sign != 0) ? -value : value);
+		}
+
+		uint32_t bits = sign | (mantissa << 13);
+		if (exponent == 31)
+		{
+			bits |= 0x7F800000;
+		}
+		else
+		{
+			bits |= (exponent - 15 + 127) << 23;
+		}
+
+		float value = 0.0f;
+		memcpy(&value, &bits, sizeof(value));
+		return(value);
+	}
+
+	// pack a component from -1 to 1 into a signed 10-bit field
+	GLuint PackSnorm10(float value)
+	{
+		int packed = (int)std::floor((std::min(std::max(value, -1.0f), 1.0f) * 511.0f) + 0.5f);
+		return((GLuint)packed & 0x3FF);
+	}
+
+	// pack a component from 0 to 1 into an unsigned 16-bit value
+	GLushort PackUnorm16(float value)
+	{
+		return((GLushort)std::floor((std::min(std::max(value, 0.0f), 1.0f) * 65535.0f) + 0.5f));
+	}
+
+	// score of a vertex for the triangle order, from its place in
+	// the cache and the number of its triangles not yet ordered
+	float GetVertexScore(int cachePosition, int remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// the vertices of the last triangle are scored
+				// lower, so that strips do not run on forever
+				score = g_LastTriangleScore;
+			}
+			else
+			{
+				float scale = 1.0f / (g_OptimizeCacheSize - 3);
+				score = std::pow(1.0f - ((cachePosition - 3) * scale), g_CacheDecayPower);
+			}
+		}
+
+		// the vertices with few triangles left are finished first,
+		// so that they do not end up as lonely triangles
+		score += g_ValenceBoostScale * std::pow((float)remainingTriangles, -g_ValenceBoostPower);
+		return(score);
+	}
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+	m_pMeshes = NULL;
+	m_meshCount = 0;
+	m_pVertices = NULL;
+	m_pIndices = NULL;
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a cache file and
+ *  checking that its arrays are inside of it, and that the
+ *  range of every mesh is inside of the arrays, since they
+ *  are uploaded without being copied.
+ ***********************************************************/
+bool MeshCache::Open(const char* filename)
+{
+	Close();
+
+	if (m_file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	if (m_file.GetSize() < sizeof(header))
+	{
+		Close();
+		return(false);
+	}
+	memcpy(&header, m_file.GetData(), sizeof(header));
+	if ((header.magic != g_CacheMagic) || (header.version != g_CacheVersion))
+	{
+		// written by another version, generated again
+		Close();
+		return(false);
+	}
+
+	// the sizes are checked in 64 bits, so that large counts in a
+	// damaged file cannot wrap around
+	const uint64_t fileSize = m_file.GetSize();
+	if (((header.meshOffset % 4) != 0) || ((header.vertexOffset % 4) != 0) || ((header.indexOffset % 4) != 0) ||
+		(header.meshOffset + (uint64_t)header.meshCount * sizeof(MESH_RECORD) > fileSize) ||
+		(header.vertexOffset + (uint64_t)header.vertexCount * sizeof(PACKED_VERTEX) > fileSize) ||
+		(header.indexOffset + (uint64_t)header.indexCount * sizeof(GLuint) > fileSize))
+	{
+		std::cout << "Invalid arrays in mesh cache: " << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_pMeshes = (const MESH_RECORD*)(m_file.GetData() + header.meshOffset);
+	m_meshCount = (int)header.meshCount;
+	m_pVertices = (const PACKED_VERTEX*)(m_file.GetData() + header.vertexOffset);
+	m_pIndices = (const GLuint*)(m_file.GetData() + header.indexOffset);
+
+	for (int i = 0; i < m_meshCount; i++)
+	{
+		const MESH_RECORD& mesh = m_pMeshes[i];
+		if ((mesh.baseVertex < 0) ||
+			((uint64_t)mesh.baseVertex + mesh.vertexCount > header.vertexCount) ||
+			((uint64_t)mesh.firstIndex + mesh.indexCount > header.indexCount))
+		{
+			std::cout << "Invalid mesh " << i << " in mesh cache: " << filename << std::endl;
+			Close();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cache file.
+ ***********************************************************/
+void MeshCache::Close()
+{
+	m_file.Close();
+	m_pMeshes = NULL;
+	m_meshCount = 0;
+	m_pVertices = NULL;
+	m_pIndices = NULL;
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for writing the passed in meshes and
+ *  their shared arrays into a cache file, as the header
+ *  followed by the mesh table, the vertices and the indices.
+ ***********************************************************/
+bool MeshCache::Write(
+	const char* filename,
+	const std::vector<MESH_RECORD>& meshes,
+	const std::vector<PACKED_VERTEX>& vertices,
+	const std::vector<GLuint>& indices)
+{
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = g_CacheMagic;
+	header.version = g_CacheVersion;
+	header.meshCount = (uint32_t)meshes.size();
+	header.meshOffset = sizeof(header);
+	header.vertexCount = (uint32_t)vertices.size();
+	header.vertexOffset = header.meshOffset + header.meshCount * sizeof(MESH_RECORD);
+	header.indexCount = (uint32_t)indices.size();
+	header.indexOffset = header.vertexOffset + header.vertexCount * sizeof(PACKED_VERTEX);
+
+	FILE* pFile = fopen(filename, "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write mesh cache: " << filename << std::endl;
+		return(false);
+	}
+
+	fwrite(&header, sizeof(header), 1, pFile);
+	fwrite(meshes.data(), sizeof(MESH_RECORD), meshes.size(), pFile);
+	fwrite(vertices.data(), sizeof(PACKED_VERTEX), vertices.size(), pFile);
+	fwrite(indices.data(), sizeof(GLuint), indices.size(), pFile);
+	bool bWritten = (ferror(pFile) == 0);
+	fclose(pFile);
+
+	if (bWritten == false)
+	{
+		std::cout << "Could not write mesh cache: " << filename << std::endl;
+		remove(filename);
+	}
+
+	return(bWritten);
+}
+
+/***********************************************************
+ *  PackVertex()
+ *
+ *  This method is used for packing the position, normal and
+ *  texture coordinate of a generated vertex. The texture
+ *  coordinates of the generated meshes are all from 0 to 1.
+ ***********************************************************/
+MeshCache::PACKED_VERTEX MeshCache::PackVertex(
+	const glm::vec3& position,
+	const glm::vec3& normal,
+	float u,
+	float v)
+{
+	PACKED_VERTEX vertex;
+	vertex.position[0] = FloatToHalf(position.x);
+	vertex.position[1] = FloatToHalf(position.y);
+	vertex.position[2] = FloatToHalf(position.z);
+	vertex.position[3] = FloatToHalf(1.0f);
+	vertex.normal =
+		PackSnorm10(normal.x) |
+		(PackSnorm10(normal.y) << 10) |
+		(PackSnorm10(normal.z) << 20);
+	vertex.textureCoordinate[0] = PackUnorm16(u);
+	vertex.textureCoordinate[1] = PackUnorm16(v);
+
+	return(vertex);
+}
+
+/***********************************************************
+ *  UnpackPosition()
+ *
+ *  This method is used for getting the position of a packed
+ *  vertex as the vertex shader reads it.
+ ***********************************************************/
+glm::vec3 MeshCache::UnpackPosition(const PACKED_VERTEX& vertex)
+{
+	return(glm::vec3(
+		HalfToFloat(vertex.position[0]),
+		HalfToFloat(vertex.position[1]),
+		HalfToFloat(vertex.position[2])));
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles of a
+ *  mesh for the post-transform vertex cache, with the
+ *  greedy vertex scoring of Tom Forsyth. Every step adds
+ *  the triangle with the highest score, which favors the
+ *  vertices that are in a simulated cache and the ones with
+ *  few triangles left. Only the triangles of the vertices
+ *  in the cache are scored again after each step.
+ ***********************************************************/
+void MeshCache::OptimizeVertexCache(std::vector<GLuint>& indices, GLuint vertexCount)
+{
+	const int triangleCount = (int)(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// the triangles of every vertex, as ranges of one array, the
+	// ordered ones are moved behind the remaining ones
+	std::vector<int> remaining(vertexCount, 0);
+	for (unsigned int i = 0; i < (unsigned int)triangleCount * 3; i++)
+	{
+		remaining[indices[i]]++;
+	}
+	std::vector<int> firstTriangle(vertexCount + 1, 0);
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		firstTriangle[vertex + 1] = firstTriangle[vertex] + remaining[vertex];
+	}
+	std::vector<int> vertexTriangles(firstTriangle[vertexCount]);
+	std::vector<int> filled(vertexCount, 0);
+	for (int triangle = 0; triangle < triangleCount; triangle++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			GLuint vertex = indices[(triangle * 3) + corner];
+			vertexTriangles[firstTriangle[vertex] + filled[vertex]] = triangle;
+			filled[vertex]++;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		vertexScore[vertex] = GetVertexScore(-1, remaining[vertex]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	for (int triangle = 0; triangle < triangleCount; triangle++)
+	{
+		triangleScore[triangle] =
+			vertexScore[indices[triangle * 3]] +
+			vertexScore[indices[(triangle * 3) + 1]] +
+			vertexScore[indices[(triangle * 3) + 2]];
+	}
+
+	std::vector<unsigned char> bOrdered(triangleCount, 0);
+	std::vector<GLuint> ordered;
+	ordered.reserve(triangleCount * 3);
+	// the simulated cache, most recently used first, with room
+	// for the vertices of a new triangle before the oldest fall out
+	std::vector<GLuint> cache;
+	std::vector<GLuint> newCache;
+	cache.reserve(g_OptimizeCacheSize + 3);
+	newCache.reserve(g_OptimizeCacheSize + 3);
+
+	int bestTriangle = -1;
+	for (int step = 0; step < triangleCount; step++)
+	{
+		// when none of the cached vertices has triangles left, the
+		// best of the remaining triangles starts a new run
+		if (bestTriangle < 0)
+		{
+			float bestScore = -1.0f;
+			for (int triangle = 0; triangle < triangleCount; triangle++)
+			{
+				if ((bOrdered[triangle] == 0) && (triangleScore[triangle] > bestScore))
+				{
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		const GLuint* corners = &indices[bestTriangle * 3];
+		bOrdered[bestTriangle] = 1;
+		ordered.insert(ordered.end(), corners, corners + 3);
+
+		// the triangle is no longer one of the remaining ones of
+		// its vertices, and they move to the front of the cache
+		newCache.clear();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			GLuint vertex = corners[corner];
+			int* pTriangles = &vertexTriangles[firstTriangle[vertex]];
+			for (int i = 0; i < remaining[vertex]; i++)
+			{
+				if (pTriangles[i] == bestTriangle)
+				{
+					std::swap(pTriangles[i], pTriangles[remaining[vertex] - 1]);
+					break;
+				}
+			}
+			remaining[vertex]--;
+			newCache.push_back(vertex);
+		}
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			if ((cache[i] != corners[0]) && (cache[i] != corners[1]) && (cache[i] != corners[2]))
+			{
+				newCache.push_back(cache[i]);
+			}
+		}
+		cache.swap(newCache);
+
+		// score the vertices that moved again, including the ones
+		// that fell out of the cache, and then their triangles
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			GLuint vertex = cache[i];
+			cachePosition[vertex] = ((int)i < g_OptimizeCacheSize) ? (int)i : -1;
+			vertexScore[vertex] = GetVertexScore(cachePosition[vertex], remaining[vertex]);
+		}
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			GLuint vertex = cache[i];
+			const int* pTriangles = &vertexTriangles[firstTriangle[vertex]];
+			for (int j = 0; j < remaining[vertex]; j++)
+			{
+				int triangle = pTriangles[j];
+				triangleScore[triangle] =
+					vertexScore[indices[triangle * 3]] +
+					vertexScore[indices[(triangle * 3) + 1]] +
+					vertexScore[indices[(triangle * 3) + 2]];
+				if (triangleScore[triangle] > bestScore)
+				{
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+		if ((int)cache.size() > g_OptimizeCacheSize)
+		{
+			cache.resize(g_OptimizeCacheSize);
+		}
+	}
+
+	indices.swap(ordered);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for reordering the vertices of a
+ *  mesh into the order the triangles first use them in, so
+ *  that the vertex fetches walk through memory front to
+ *  back. Vertices no triangle uses are dropped.
+ ***********************************************************/
+void MeshCache::OptimizeVertexFetch(std::vector<GLuint>& indices, std::vector<PACKED_VERTEX>& vertices)
+{
+	const GLuint unused = 0xFFFFFFFF;
+	std::vector<GLuint> remap(vertices.size(), unused);
+	std::vector<PACKED_VERTEX> ordered;
+	ordered.reserve(vertices.size());
+
+	for (unsigned int i = 0; i < indices.size(); i++)
+	{
+		GLuint& index = indices[i];
+		if (remap[index] == unused)
+		{
+			remap[index] = (GLuint)ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices.swap(ordered);
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// store the generated meshes quantized and optimized for the vertex cache
+// in a file, so that later launches map them in instead of generating them
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class reads and writes a file holding a table of
+ *  meshes and their shared vertex and index arrays. The
+ *  vertices are packed into 16 bytes, with half float
+ *  positions, normals packed into 10 bits per component and
+ *  16-bit texture coordinates, which is half the size of
+ *  the generated floats. The file is mapped, so its arrays
+ *  can be uploaded straight from the mapping. Every mesh is
+ *  stored with the parameters it was generated from, so a
+ *  cached mesh is only used for the same request. The class
+ *  also has the helpers that pack the generated vertices
+ *  and reorder the triangles for the post-transform cache.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache();
+
+	// layout of a vertex in the cache and in the vertex buffer
+	struct PACKED_VERTEX
+	{
+		GLhalf position[4];
+		// signed normalized, in GL_INT_2_10_10_10_REV order
+		GLuint normal;
+		// unsigned normalized
+		GLushort textureCoordinate[2];
+	};
+
+	// the shape and the parameters a mesh was generated with
+	struct MESH_KEY
+	{
+		uint32_t shape;
+		uint32_t segments[2];
+		float thickness;
+	};
+
+	// a mesh of the cache, as a range of the shared arrays
+	struct MESH_RECORD
+	{
+		MESH_KEY key;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t baseVertex;
+		uint32_t vertexCount;
+		// object space bounds of the packed vertex positions
+		float minimum[3];
+		float maximum[3];
+	};
+
+	// map a cache file, returns false when it is missing or was
+	// written by another version of the mesh generation
+	bool Open(const char* filename);
+	// unmap the cache file
+	void Close();
+	bool IsOpen() const { return(m_file.IsOpen()); }
+
+	// meshes and shared arrays of the mapped cache file
+	int GetMeshCount() const { return(m_meshCount); }
+	const MESH_RECORD* GetMeshes() const { return(m_pMeshes); }
+	const PACKED_VERTEX* GetVertices() const { return(m_pVertices); }
+	const GLuint* GetIndices() const { return(m_pIndices); }
+
+	// write the passed in meshes and arrays into a cache file
+	static bool Write(
+		const char* filename,
+		const std::vector<MESH_RECORD>& meshes,
+		const std::vector<PACKED_VERTEX>& vertices,
+		const std::vector<GLuint>& indices);
+
+	// pack a generated vertex, and get the position back out of
+	// a packed one
+	static PACKED_VERTEX PackVertex(const glm::vec3& position, const glm::vec3& normal, float u, float v);
+	static glm::vec3 UnpackPosition(const PACKED_VERTEX& vertex);
+
+	// reorder the triangles of a mesh so that they reuse the
+	// vertices still in the post-transform cache
+	static void OptimizeVertexCache(std::vector<GLuint>& indices, GLuint vertexCount);
+	// reorder the vertices of a mesh into the order the triangles
+	// first use them in, so they are fetched front to back
+	static void OptimizeVertexFetch(std::vector<GLuint>& indices, std::vector<PACKED_VERTEX>& vertices);
+
+private:
+	// layout of the header at the start of a cache file, the
+	// offsets are in bytes from the start of the file
+	struct CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t meshCount;
+		uint32_t meshOffset;
+		uint32_t vertexCount;
+		uint32_t vertexOffset;
+		uint32_t indexCount;
+		uint32_t indexOffset;
+	};
+
+	// the mapped cache file
+	MappedFile m_file;
+	// meshes and shared arrays inside of the mapping
+	const MESH_RECORD* m_pMeshes;
+	int m_meshCount;
+	const PACKED_VERTEX* m_pVertices;
+	const GLuint* m_pIndices;
+};
@@ -0,0 +1,536 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.cpp
+// ============
+// measure the CPU and GPU time of the parts of each frame, collect the
+// per-frame counters of the renderer, and report them as a summary or as
+// one CSV row per frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/***********************************************************
+ *  Profiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Profiler::Profiler()
+{
+	m_gpuSection = -1;
+	m_bGpuTiming = false;
+	m_frameIndex = 0;
+	m_buffer = 0;
+	m_frameStart = CLOCK::now();
+	m_bInFrame = false;
+	m_summaryFrames = 0;
+	m_frameTimeSum = 0.0;
+	m_summaryStart = CLOCK::now();
+	m_pCsvFile = NULL;
+	m_bCsvHeader = false;
+	m_bKeepHistory = false;
+	m_lastWorkTime = -1.0;
+
+	for (int i = 0; i < QUERY_BUFFERS; i++)
+	{
+		m_records[i].frameIndex = 0;
+		m_records[i].frameTime = 0.0;
+		m_records[i].bPending = false;
+	}
+}
+
+/***********************************************************
+ *  ~Profiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Profiler::~Profiler()
+{
+	CloseCsv();
+
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		if (m_sections[i].queries[0] != 0)
+		{
+			glDeleteQueries(QUERY_BUFFERS, m_sections[i].queries);
+		}
+	}
+	m_sections.clear();
+	m_counters.clear();
+}
+
+/***********************************************************
+ *  Scope()
+ *
+ *  The constructor of a scoped section marker, which starts
+ *  timing the section.
+ ***********************************************************/
+Profiler::Scope::Scope(Profiler* pProfiler, int section)
+{
+	m_pProfiler = pProfiler;
+	m_section = section;
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->BeginSection(m_section);
+	}
+}
+
+/***********************************************************
+ *  ~Scope()
+ *
+ *  The destructor of a scoped section marker, which stops
+ *  timing the section.
+ ***********************************************************/
+Profiler::Scope::~Scope()
+{
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndSection(m_section);
+	}
+}
+
+/***********************************************************
+ *  IsGpuTimingSupported()
+ *
+ *  This method is used for checking whether the driver can
+ *  measure the GPU time of a range of commands.
+ ***********************************************************/
+bool Profiler::IsGpuTimingSupported()
+{
+	return(GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+}
+
+/***********************************************************
+ *  AddSection()
+ *
+ *  This method is used for adding a named section of the
+ *  frame. The GPU time is only measured for sections that
+ *  ask for it, and only when the driver supports it. All of
+ *  the sections are meant to be added before the first
+ *  frame, so every CSV row has the same columns.
+ ***********************************************************/
+int Profiler::AddSection(const char* name, bool bGpuTiming)
+{
+	m_bGpuTiming = IsGpuTimingSupported();
+
+	SECTION section;
+	section.name = name;
+	section.bGpuTiming = (bGpuTiming && m_bGpuTiming);
+	section.cpuStart = CLOCK::now();
+	for (int i = 0; i < QUERY_BUFFERS; i++)
+	{
+		section.queries[i] = 0;
+		section.bQueryIssued[i] = false;
+	}
+	if (section.bGpuTiming == true)
+	{
+		glGenQueries(QUERY_BUFFERS, section.queries);
+	}
+
+	m_sections.push_back(section);
+	ResizeRecords();
+
+	return((int)m_sections.size() - 1);
+}
+
+/***********************************************************
+ *  AddCounter()
+ *
+ *  This method is used for adding a named counter, which is
+ *  set once per frame.
+ ***********************************************************/
+int Profiler::AddCounter(const char* name)
+{
+	COUNTER counter;
+	counter.name = name;
+	counter.value = 0.0;
+
+	m_counters.push_back(counter);
+	ResizeRecords();
+
+	return((int)m_counters.size() - 1);
+}
+
+/***********************************************************
+ *  ResizeRecords()
+ *
+ *  This method is used for sizing the per-frame records and
+ *  the summary sums for the sections and the counters.
+ ***********************************************************/
+void Profiler::ResizeRecords()
+{
+	for (int i = 0; i < QUERY_BUFFERS; i++)
+	{
+		m_records[i].cpuTimes.resize(m_sections.size(), 0.0);
+		m_records[i].gpuTimes.resize(m_sections.size(), -1.0);
+		m_records[i].counters.resize(m_counters.size(), 0.0);
+	}
+	m_cpuSums.resize(m_sections.size(), 0.0);
+	m_gpuSums.resize(m_sections.size(), 0.0);
+	m_gpuFrames.resize(m_sections.size(), 0);
+	m_counterSums.resize(m_counters.size(), 0.0);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame. The queries of
+ *  the oldest buffered frame are in the buffer this frame
+ *  is about to reuse, so they are read first - by now the
+ *  GPU has normally finished with them.
+ ***********************************************************/
+void Profiler::BeginFrame()
+{
+	m_buffer = (int)(m_frameIndex % QUERY_BUFFERS);
+	CollectFrame(m_buffer);
+
+	FRAME_RECORD& record = m_records[m_buffer];
+	record.frameIndex = m_frameIndex;
+	record.frameTime = 0.0;
+	record.cpuTimes.assign(m_sections.size(), 0.0);
+	record.gpuTimes.assign(m_sections.size(), -1.0);
+	record.counters.assign(m_counters.size(), 0.0);
+	record.bPending = false;
+
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		m_sections[i].bQueryIssued[m_buffer] = false;
+	}
+	for (unsigned int i = 0; i < m_counters.size(); i++)
+	{
+		m_counters[i].value = 0.0;
+	}
+
+	m_gpuSection = -1;
+	m_frameStart = CLOCK::now();
+	m_bInFrame = true;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending a frame. Its CPU times
+ *  and counters are added to the summary right away, and
+ *  its GPU times once they are read back.
+ ***********************************************************/
+void Profiler::EndFrame()
+{
+	if (m_bInFrame == false)
+	{
+		return;
+	}
+
+	FRAME_RECORD& record = m_records[m_buffer];
+	record.frameTime = std::chrono::duration<double, std::milli>(CLOCK::now() - m_frameStart).count();
+	for (unsigned int i = 0; i < m_counters.size(); i++)
+	{
+		record.counters[i] = m_counters[i].value;
+	}
+	record.bPending = true;
+
+	m_frameTimeSum += record.frameTime;
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		m_cpuSums[i] += record.cpuTimes[i];
+	}
+	for (unsigned int i = 0; i < m_counters.size(); i++)
+	{
+		m_counterSums[i] += record.counters[i];
+	}
+	m_summaryFrames++;
+
+	m_frameIndex++;
+	m_bInFrame = false;
+}
+
+/***********************************************************
+ *  BeginSection()
+ *
+ *  This method is used for starting to time a section. Its
+ *  GPU query is only started when no other section is
+ *  being timed on the GPU, since those queries cannot
+ *  overlap - a nested section only gets its CPU time.
+ ***********************************************************/
+void Profiler::BeginSection(int section)
+{
+	if ((m_bInFrame == false) || (section < 0) || (section >= (int)m_sections.size()))
+	{
+		return;
+	}
+
+	SECTION& timedSection = m_sections[section];
+	timedSection.cpuStart = CLOCK::now();
+
+	if ((timedSection.bGpuTiming == true) && (m_gpuSection < 0))
+	{
+		glBeginQuery(GL_TIME_ELAPSED, timedSection.queries[m_buffer]);
+		timedSection.bQueryIssued[m_buffer] = true;
+		m_gpuSection = section;
+	}
+}
+
+/***********************************************************
+ *  EndSection()
+ *
+ *  This method is used for stopping the timing of a section.
+ *  A section can be timed more than once in a frame, the
+ *  CPU times are added up.
+ ***********************************************************/
+void Profiler::EndSection(int section)
+{
+	if ((m_bInFrame == false) || (section < 0) || (section >= (int)m_sections.size()))
+	{
+		return;
+	}
+
+	SECTION& timedSection = m_sections[section];
+	m_records[m_buffer].cpuTimes[section] +=
+		std::chrono::duration<double, std::milli>(CLOCK::now() - timedSection.cpuStart).count();
+
+	if (m_gpuSection == section)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_gpuSection = -1;
+	}
+}
+
+/***********************************************************
+ *  SetCounter()
+ *
+ *  This method is used for setting the value of a counter
+ *  for the frame being profiled.
+ ***********************************************************/
+void Profiler::SetCounter(int counter, double value)
+{
+	if ((counter >= 0) && (counter < (int)m_counters.size()))
+	{
+		m_counters[counter].value = value;
+	}
+}
+
+/***********************************************************
+ *  CollectFrame()
+ *
+ *  This method is used for reading back the GPU times of
+ *  the frame measured into a buffer. A query that is still
+ *  not available is given up on rather than waited for, and
+ *  the frame is reported without its GPU times.
+ ***********************************************************/
+void Profiler::CollectFrame(int buffer)
+{
+	FRAME_RECORD& record = m_records[buffer];
+	if (record.bPending == false)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		const SECTION& section = m_sections[i];
+		if (section.bQueryIssued[buffer] == false)
+		{
+			continue;
+		}
+
+		GLint bAvailable = 0;
+		glGetQueryObjectiv(section.queries[buffer], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == 0)
+		{
+			continue;
+		}
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(section.queries[buffer], GL_QUERY_RESULT, &elapsed);
+		record.gpuTimes[i] = (double)elapsed / 1000000.0;
+		m_gpuSums[i] += record.gpuTimes[i];
+		m_gpuFrames[i]++;
+	}
+
+	// the work of the frame is the time of its GPU timed sections,
+	// on the CPU for a section whose GPU time is missing
+	m_lastWorkTime = 0.0;
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		if (m_sections[i].bGpuTiming == true)
+		{
+			m_lastWorkTime += (record.gpuTimes[i] >= 0.0) ? record.gpuTimes[i] : record.cpuTimes[i];
+		}
+	}
+
+	if (NULL != m_pCsvFile)
+	{
+		WriteCsvRow(record);
+	}
+	if (m_bKeepHistory == true)
+	{
+		m_history.push_back(record);
+	}
+	record.bPending = false;
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for reading back the frames still
+ *  waiting for their GPU times, oldest first, after waiting
+ *  for the GPU to finish them.
+ ***********************************************************/
+void Profiler::Flush()
+{
+	if (m_bGpuTiming == true)
+	{
+		glFinish();
+	}
+
+	for (long frame = m_frameIndex - QUERY_BUFFERS; frame < m_frameIndex; frame++)
+	{
+		if (frame >= 0)
+		{
+			CollectFrame((int)(frame % QUERY_BUFFERS));
+		}
+	}
+}
+
+/***********************************************************
+ *  OpenCsv()
+ *
+ *  This method is used for opening the CSV file the frames
+ *  are written into. The header is written with the first
+ *  row, once all of the sections and counters are known.
+ ***********************************************************/
+bool Profiler::OpenCsv(const char* filename)
+{
+	CloseCsv();
+
+	m_pCsvFile = fopen(filename, "w");
+	if (NULL == m_pCsvFile)
+	{
+		std::cout << "Could not open profiler CSV file: " << filename << std::endl;
+		return(false);
+	}
+	m_bCsvHeader = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CloseCsv()
+ *
+ *  This method is used for closing the CSV file, once the
+ *  frames still waiting for their GPU times are written.
+ ***********************************************************/
+void Profiler::CloseCsv()
+{
+	if (NULL == m_pCsvFile)
+	{
+		return;
+	}
+
+	Flush();
+
+	fclose(m_pCsvFile);
+	m_pCsvFile = NULL;
+}
+
+/***********************************************************
+ *  WriteCsvRow()
+ *
+ *  This method is used for writing a frame into the CSV
+ *  file, with a column for the CPU time of every section,
+ *  the GPU time of the sections timed on the GPU, and the
+ *  value of every counter. Missing GPU times are left empty.
+ ***********************************************************/
+void Profiler::WriteCsvRow(const FRAME_RECORD& record)
+{
+	if (m_bCsvHeader == false)
+	{
+		fprintf(m_pCsvFile, "frame,frame_ms");
+		for (unsigned int i = 0; i < m_sections.size(); i++)
+		{
+			fprintf(m_pCsvFile, ",%s_cpu_ms", m_sections[i].name.c_str());
+			if (m_sections[i].bGpuTiming == true)
+			{
+				fprintf(m_pCsvFile, ",%s_gpu_ms", m_sections[i].name.c_str());
+			}
+		}
+		for (unsigned int i = 0; i < m_counters.size(); i++)
+		{
+			fprintf(m_pCsvFile, ",%s", m_counters[i].name.c_str());
+		}
+		fprintf(m_pCsvFile, "\n");
+		m_bCsvHeader = true;
+	}
+
+	fprintf(m_pCsvFile, "%ld,%.4f", record.frameIndex, record.frameTime);
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		fprintf(m_pCsvFile, ",%.4f", record.cpuTimes[i]);
+		if (m_sections[i].bGpuTiming == true)
+		{
+			if (record.gpuTimes[i] >= 0.0)
+			{
+				fprintf(m_pCsvFile, ",%.4f", record.gpuTimes[i]);
+			}
+			else
+			{
+				fprintf(m_pCsvFile, ",");
+			}
+		}
+	}
+	for (unsigned int i = 0; i < m_counters.size(); i++)
+	{
+		fprintf(m_pCsvFile, ",%.0f", record.counters[i]);
+	}
+	fprintf(m_pCsvFile, "\n");
+}
+
+/***********************************************************
+ *  UpdateSummary()
+ *
+ *  This method is used for averaging the frames since the
+ *  last summary into one line of text - the frame rate, the
+ *  CPU and GPU milliseconds of every section, and every
+ *  counter. Nothing is done until the passed in number of
+ *  seconds has passed.
+ ***********************************************************/
+bool Profiler::UpdateSummary(double intervalSeconds)
+{
+	double elapsed = std::chrono::duration<double>(CLOCK::now() - m_summaryStart).count();
+	if ((elapsed < intervalSeconds) || (m_summaryFrames == 0))
+	{
+		return(false);
+	}
+
+	std::ostringstream summary;
+	summary << std::fixed << std::setprecision(1)
+		<< (m_summaryFrames / elapsed) << " fps, "
+		<< (m_frameTimeSum / m_summaryFrames) << " ms |";
+	for (unsigned int i = 0; i < m_sections.size(); i++)
+	{
+		summary << " " << m_sections[i].name << " " << std::setprecision(2) << (m_cpuSums[i] / m_summaryFrames);
+		if (m_gpuFrames[i] > 0)
+		{
+			summary << "/" << (m_gpuSums[i] / m_gpuFrames[i]);
+		}
+	}
+	summary << " ms |" << std::setprecision(0);
+	for (unsigned int i = 0; i < m_counters.size(); i++)
+	{
+		summary << " " << m_counters[i].name << " " << (m_counterSums[i] / m_summaryFrames);
+	}
+	m_summary = summary.str();
+
+	m_summaryFrames = 0;
+	m_frameTimeSum = 0.0;
+	m_cpuSums.assign(m_sections.size(), 0.0);
+	m_gpuSums.assign(m_sections.size(), 0.0);
+	m_gpuFrames.assign(m_sections.size(), 0);
+	m_counterSums.assign(m_counters.size(), 0.0);
+	m_summaryStart = CLOCK::now();
+
+	return(true);
+}
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.h
+// ============
+// measure the CPU and GPU time of the parts of each frame, collect the
+// per-frame counters of the renderer, and report them as a summary or as
+// one CSV row per frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "RingBuffer.h"
+
+/***********************************************************
+ *  Profiler
+ *
+ *  This class times named sections of the frame on the CPU
+ *  and, for sections that do not overlap, on the GPU with
+ *  GL_TIME_ELAPSED queries. The queries are buffered over
+ *  one more frame than can be in flight: the results of a
+ *  frame are only read once the GPU has moved past it, so
+ *  reading them never stalls the pipeline. Named counters are set once
+ *  per frame, such as draw calls and uniform uploads.
+ ***********************************************************/
+class Profiler
+{
+public:
+	// constructor
+	Profiler();
+	// destructor
+	~Profiler();
+
+	// times a section from its construction to its destruction
+	class Scope
+	{
+	public:
+		Scope(Profiler* pProfiler, int section);
+		~Scope();
+	private:
+		Profiler* m_pProfiler;
+		int m_section;
+	};
+
+	// whether the GPU time of sections can be measured
+	static bool IsGpuTimingSupported();
+
+	// add a named section, with or without its GPU time, and a
+	// named counter, returning the ID for the other methods
+	int AddSection(const char* name, bool bGpuTiming);
+	int AddCounter(const char* name);
+
+	// mark the start and the end of a frame
+	void BeginFrame();
+	void EndFrame();
+	// mark the start and the end of a section in the frame
+	void BeginSection(int section);
+	void EndSection(int section);
+	// set the value of a counter for this frame
+	void SetCounter(int counter, double value);
+
+	// write one row per frame into a CSV file, once the GPU
+	// times of the frame are known
+	bool OpenCsv(const char* filename);
+	void CloseCsv();
+
+	// average the frames since the last summary into a line of
+	// text, returns false until the passed in seconds have passed
+	bool UpdateSummary(double intervalSeconds);
+	const std::string& GetSummary() const { return(m_summary); }
+
+	// number of frames profiled so far
+	long GetFrameCount() const { return(m_frameIndex); }
+	// milliseconds the sections timed on the GPU took in the latest
+	// frame read back, or -1 before the first one - which leaves out
+	// the waits on the display that the frame time includes
+	double GetLastWorkTime() const { return(m_lastWorkTime); }
+
+	// everything measured in a frame, kept until the GPU times
+	// of the frame are read back
+	struct FRAME_RECORD
+	{
+		long frameIndex;
+		double frameTime;
+		std::vector<double> cpuTimes;
+		std::vector<double> gpuTimes;
+		std::vector<double> counters;
+		bool bPending;
+	};
+
+	// keep every frame once it is read back, for reports made
+	// after the last frame
+	void SetKeepHistory(bool bKeepHistory) { m_bKeepHistory = bKeepHistory; }
+	const std::vector<FRAME_RECORD>& GetHistory() const { return(m_history); }
+	// wait for the GPU and read back the frames still pending
+	void Flush();
+
+	// names of the sections and counters, by ID
+	int GetSectionCount() const { return((int)m_sections.size()); }
+	const std::string& GetSectionName(int section) const { return(m_sections[section].name); }
+	bool IsSectionGpuTimed(int section) const { return(m_sections[section].bGpuTiming); }
+	int GetCounterCount() const { return((int)m_counters.size()); }
+	const std::string& GetCounterName(int counter) const { return(m_counters[counter].name); }
+
+private:
+	typedef std::chrono::steady_clock CLOCK;
+
+	// number of frames the GPU queries are buffered over - a frame
+	// is read back before the ring buffer waits for its region, so
+	// one more than the frames in flight
+	static const int QUERY_BUFFERS = RingBuffer::FRAME_REGIONS + 1;
+
+	// timing of a named section of the frame
+	struct SECTION
+	{
+		std::string name;
+		bool bGpuTiming;
+		CLOCK::time_point cpuStart;
+		// GPU queries of each buffered frame, and whether they
+		// were issued during that frame
+		GLuint queries[QUERY_BUFFERS];
+		bool bQueryIssued[QUERY_BUFFERS];
+	};
+
+	// a named per-frame value
+	struct COUNTER
+	{
+		std::string name;
+		double value;
+	};
+
+	// sections and counters, by ID
+	std::vector<SECTION> m_sections;
+	std::vector<COUNTER> m_counters;
+	// measurements of the frames whose GPU times are pending
+	FRAME_RECORD m_records[QUERY_BUFFERS];
+	// section whose GPU query is running, GL_TIME_ELAPSED queries
+	// cannot overlap
+	int m_gpuSection;
+	bool m_bGpuTiming;
+
+	// frame being profiled, and the buffer its queries go into
+	long m_frameIndex;
+	int m_buffer;
+	CLOCK::time_point m_frameStart;
+	bool m_bInFrame;
+
+	// sums of the frames since the last summary
+	int m_summaryFrames;
+	double m_frameTimeSum;
+	std::vector<double> m_cpuSums;
+	// GPU times are summed per section, since a section nested in
+	// another one or a late query has no GPU time for the frame
+	std::vector<double> m_gpuSums;
+	std::vector<int> m_gpuFrames;
+	std::vector<double> m_counterSums;
+	CLOCK::time_point m_summaryStart;
+	std::string m_summary;
+
+	// file the per-frame rows are written into
+	FILE* m_pCsvFile;
+	bool m_bCsvHeader;
+	// every frame read back so far, when they are kept
+	std::vector<FRAME_RECORD> m_history;
+	bool m_bKeepHistory;
+	// work time of the latest frame read back
+	double m_lastWorkTime;
+
+	// read back the GPU times of the frame in a buffer, when they
+	// are available, and report the frame
+	void CollectFrame(int buffer);
+	// write the frame into the CSV file
+	void WriteCsvRow(const FRAME_RECORD& record);
+	// size the per-frame records for the sections and counters
+	void ResizeRecords();
+};
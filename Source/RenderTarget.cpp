@@ -0,0 +1,372 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.cpp
+// ============
+// render the scene into a multisampled offscreen framebuffer at a scaled
+// internal size, and resolve it onto the window
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderTarget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// the render scale moves in steps of this size, so that small
+	// changes of the frame time do not resize the frame every time
+	const float g_ScaleStep = 0.05f;
+	// fraction of the target frame time a frame may take before the
+	// scale is lowered, and the fraction it has to stay under for
+	// the scale to be raised again
+	const double g_SlowFraction = 0.95;
+	const double g_FastFraction = 0.75;
+	// fraction of the target frame time a lowered scale aims for,
+	// between the two so that it settles there
+	const double g_FitFraction = 0.85;
+	// frames in a row that have to be fast before the scale is raised
+	const int g_FastFrameCount = 30;
+	// frames waited after a change of the scale, since the GPU times
+	// of the frames are read back a few frames late
+	const int g_ScaleSettleFrames = 8;
+	// largest drop of the scale in one change
+	const float g_MaximumScaleDrop = 0.25f;
+
+	// size of a window side scaled by the render scale, at least
+	// one pixel
+	int ScaleSize(int size, float scale)
+	{
+		return(std::max(1, (int)std::floor((float)size * scale + 0.5f)));
+	}
+}
+
+/***********************************************************
+ *  RenderTarget()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderTarget::RenderTarget()
+{
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_resolveFramebuffer = 0;
+	m_resolveBuffer = 0;
+	m_samples = 1;
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_scale = 1.0f;
+	m_maximumScale = 1.0f;
+	m_targetTime = 0.0;
+	m_minimumScale = 1.0f;
+	m_settleFrames = 0;
+	m_fastFrames = 0;
+}
+
+/***********************************************************
+ *  ~RenderTarget()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderTarget::~RenderTarget()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the framebuffers the
+ *  frames are rendered and resolved into. The resolve
+ *  framebuffer is only needed with multisampling, a single
+ *  sampled frame is stretched onto the window as it is.
+ ***********************************************************/
+bool RenderTarget::Create(int windowWidth, int windowHeight, int samples)
+{
+	Destroy();
+
+	GLint maximumSamples = 1;
+	glGetIntegerv(GL_MAX_SAMPLES, &maximumSamples);
+	m_samples = std::max(1, std::min(samples, (int)maximumSamples));
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	if (m_samples > 1)
+	{
+		glGenFramebuffers(1, &m_resolveFramebuffer);
+		glGenRenderbuffers(1, &m_resolveBuffer);
+	}
+
+	m_windowWidth = std::max(windowWidth, 1);
+	m_windowHeight = std::max(windowHeight, 1);
+	if (AllocateBuffers() == false)
+	{
+		Destroy();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for deleting the framebuffers and
+ *  their attachments.
+ ***********************************************************/
+void RenderTarget::Destroy()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_colorBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+	if (m_resolveFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_resolveFramebuffer);
+		m_resolveFramebuffer = 0;
+	}
+	if (m_resolveBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_resolveBuffer);
+		m_resolveBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for reallocating the attachments
+ *  when the size of the window changed. A minimized window
+ *  has no size, and keeps the attachments it had.
+ ***********************************************************/
+bool RenderTarget::Resize(int windowWidth, int windowHeight)
+{
+	if ((windowWidth <= 0) || (windowHeight <= 0) ||
+		((windowWidth == m_windowWidth) && (windowHeight == m_windowHeight)))
+	{
+		return(true);
+	}
+
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+
+	return(AllocateBuffers());
+}
+
+/***********************************************************
+ *  AllocateBuffers()
+ *
+ *  This method is used for allocating the storage of the
+ *  attachments at the size of the window, which is the
+ *  largest the frames can be rendered at, and attaching
+ *  them to the framebuffers.
+ ***********************************************************/
+bool RenderTarget::AllocateBuffers()
+{
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples > 1 ? m_samples : 0, GL_RGBA8, m_windowWidth, m_windowHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples > 1 ? m_samples : 0, GL_DEPTH_COMPONENT24, m_windowWidth, m_windowHeight);
+	if (m_samples > 1)
+	{
+		glBindRenderbuffer(GL_RENDERBUFFER, m_resolveBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_windowWidth, m_windowHeight);
+	}
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if ((status == GL_FRAMEBUFFER_COMPLETE) && (m_samples > 1))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_resolveFramebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_resolveBuffer);
+		status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Render target framebuffer is incomplete: " << status << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the multisampled
+ *  framebuffer, with the viewport covering the part of it
+ *  the frame is rendered at.
+ ***********************************************************/
+void RenderTarget::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, GetRenderWidth(), GetRenderHeight());
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method is used for presenting the rendered frame on
+ *  the window. A multisampled blit cannot scale, so the
+ *  samples are first resolved at the render size into the
+ *  resolve framebuffer, which is then stretched onto the
+ *  window with linear filtering. The rendered buffers are
+ *  not needed after that, which lets the driver skip
+ *  writing them back to memory.
+ ***********************************************************/
+void RenderTarget::Resolve()
+{
+	const int width = GetRenderWidth();
+	const int height = GetRenderHeight();
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	if (m_samples > 1)
+	{
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveFramebuffer);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+		if (GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata)
+		{
+			const GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT };
+			glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, 2, attachments);
+		}
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_resolveFramebuffer);
+	}
+
+	// the frame is copied as it is when it has the size of the window
+	const bool bScaled = (width != m_windowWidth) || (height != m_windowHeight);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, m_windowWidth, m_windowHeight,
+		GL_COLOR_BUFFER_BIT, bScaled ? GL_LINEAR : GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, m_windowWidth, m_windowHeight);
+}
+
+/***********************************************************
+ *  SetScale()
+ *
+ *  This method is used for setting the render scale, which
+ *  is also the largest scale the dynamic resolution raises
+ *  it back up to.
+ ***********************************************************/
+void RenderTarget::SetScale(float scale)
+{
+	m_maximumScale = std::max(g_ScaleStep, std::min(scale, 1.0f));
+	m_scale = m_maximumScale;
+	m_minimumScale = std::min(m_minimumScale, m_maximumScale);
+	m_fastFrames = 0;
+}
+
+/***********************************************************
+ *  SetDynamicResolution()
+ *
+ *  This method is used for setting the frame time the
+ *  dynamic resolution keeps the frames under, and the
+ *  smallest scale it lowers the frames to.
+ ***********************************************************/
+void RenderTarget::SetDynamicResolution(double targetMilliseconds, float minimumScale)
+{
+	m_targetTime = std::max(targetMilliseconds, 0.0);
+	m_minimumScale = std::max(g_ScaleStep, std::min(minimumScale, m_maximumScale));
+	m_settleFrames = g_ScaleSettleFrames;
+	m_fastFrames = 0;
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for adjusting the render scale by
+ *  the GPU time of a finished frame. A slow frame lowers
+ *  the scale at once, by as much as the pixel count has to
+ *  shrink for the frame to fit the target, the time being
+ *  mostly spent per pixel. The scale is only raised one step
+ *  at a time, after a run of frames with room to spare, so
+ *  it does not swing back and forth around the target.
+ ***********************************************************/
+void RenderTarget::UpdateScale(double frameMilliseconds)
+{
+	if ((m_targetTime <= 0.0) || (frameMilliseconds <= 0.0))
+	{
+		return;
+	}
+	if (m_settleFrames > 0)
+	{
+		m_settleFrames--;
+		return;
+	}
+
+	float scale = m_scale;
+	if (frameMilliseconds > m_targetTime * g_SlowFraction)
+	{
+		m_fastFrames = 0;
+		if (m_scale > m_minimumScale)
+		{
+			float fitScale = m_scale * (float)std::sqrt(m_targetTime * g_FitFraction / frameMilliseconds);
+			fitScale = std::max(fitScale, m_scale - g_MaximumScaleDrop);
+			scale = std::floor(fitScale / g_ScaleStep + 0.001f) * g_ScaleStep;
+		}
+	}
+	else if (frameMilliseconds < m_targetTime * g_FastFraction)
+	{
+		m_fastFrames++;
+		if ((m_fastFrames >= g_FastFrameCount) && (m_scale < m_maximumScale))
+		{
+			scale = m_scale + g_ScaleStep;
+			m_fastFrames = 0;
+		}
+	}
+	else
+	{
+		m_fastFrames = 0;
+	}
+
+	scale = std::max(m_minimumScale, std::min(scale, m_maximumScale));
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_settleFrames = g_ScaleSettleFrames;
+	}
+}
+
+/***********************************************************
+ *  GetRenderWidth()
+ *
+ *  This method is used for getting the width the frames
+ *  are rendered at.
+ ***********************************************************/
+int RenderTarget::GetRenderWidth() const
+{
+	return(ScaleSize(m_windowWidth, m_scale));
+}
+
+/***********************************************************
+ *  GetRenderHeight()
+ *
+ *  This method is used for getting the height the frames
+ *  are rendered at.
+ ***********************************************************/
+int RenderTarget::GetRenderHeight() const
+{
+	return(ScaleSize(m_windowHeight, m_scale));
+}
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.h
+// ============
+// render the scene into a multisampled offscreen framebuffer at a scaled
+// internal size, and resolve it onto the window
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  RenderTarget
+ *
+ *  This class holds a multisampled color and depth
+ *  framebuffer the size of the window, which the frames are
+ *  rendered into, and a single-sampled color framebuffer
+ *  the samples are resolved into. The frame is drawn into
+ *  the lower left part of the framebuffers, scaled down by
+ *  the render scale, and stretched onto the window when it
+ *  is resolved - so the scale can change every frame without
+ *  reallocating anything. With dynamic resolution, the
+ *  scale is lowered while the GPU time of the frames misses
+ *  the target frame time and raised again once there is
+ *  room, between the minimum scale and the largest one.
+ ***********************************************************/
+class RenderTarget
+{
+public:
+	// constructor
+	RenderTarget();
+	// destructor
+	~RenderTarget();
+
+	// create the framebuffers for a window of the passed in size,
+	// with the number of samples clamped to what the driver
+	// supports - 1 or less renders without multisampling
+	bool Create(int windowWidth, int windowHeight, int samples);
+	// delete the framebuffers
+	void Destroy();
+	// reallocate the framebuffers when the window changed size
+	bool Resize(int windowWidth, int windowHeight);
+
+	// bind the multisampled framebuffer and set the viewport to the
+	// internal size, for the frame to be rendered into
+	void Bind();
+	// resolve the samples of the rendered frame and stretch it onto
+	// the window, leaving the window framebuffer bound
+	void Resolve();
+
+	// fraction of the window size the frames are rendered at, and
+	// the largest one the dynamic resolution goes back up to
+	void SetScale(float scale);
+	float GetScale() const { return(m_scale); }
+	// lower the scale while the frames take longer than the passed
+	// in milliseconds, down to the minimum scale - a target of 0
+	// keeps the scale fixed
+	void SetDynamicResolution(double targetMilliseconds, float minimumScale);
+	// adjust the scale by the GPU milliseconds of a finished frame
+	void UpdateScale(double frameMilliseconds);
+
+	// size of the window and of the frames rendered into it
+	int GetWindowWidth() const { return(m_windowWidth); }
+	int GetWindowHeight() const { return(m_windowHeight); }
+	int GetRenderWidth() const;
+	int GetRenderHeight() const;
+	int GetSamples() const { return(m_samples); }
+
+private:
+	// multisampled framebuffer and its attachments
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	// single-sampled framebuffer the samples are resolved into
+	GLuint m_resolveFramebuffer;
+	GLuint m_resolveBuffer;
+	int m_samples;
+
+	int m_windowWidth;
+	int m_windowHeight;
+
+	// current and largest render scale
+	float m_scale;
+	float m_maximumScale;
+	// dynamic resolution settings, and the frames left before the
+	// scale is changed again
+	double m_targetTime;
+	float m_minimumScale;
+	int m_settleFrames;
+	// frames in a row that had room for a larger scale
+	int m_fastFrames;
+
+	// allocate the storage of the attachments for the window size
+	bool AllocateBuffers();
+};
@@ -0,0 +1,340 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.cpp
+// ============
+// hand out the per-frame dynamic data of the renderer from one buffer that
+// is split into a region per frame in flight
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// smallest alignment of the allocations, which keeps the
+	// vec4 columns of the matrices aligned
+	const GLsizeiptr g_MinimumAlignment = 16;
+	// time a fence is waited on before checking it again, in
+	// nanoseconds
+	const GLuint64 g_FenceTimeout = 1000000000;
+
+	// round a size up to a multiple of the alignment
+	GLsizeiptr AlignSize(GLsizeiptr size, GLsizeiptr alignment)
+	{
+		return(((size + alignment - 1) / alignment) * alignment);
+	}
+}
+
+/***********************************************************
+ *  RingBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RingBuffer::RingBuffer()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_bPersistent = false;
+	m_regionSize = 0;
+	m_frameSize = 0;
+	m_reservedSize = 0;
+	m_alignment = g_MinimumAlignment;
+	m_region = 0;
+	m_regionStart = 0;
+	m_head = 0;
+	m_committed = 0;
+	m_bFull = false;
+	m_waitCount = 0;
+
+	for (int i = 0; i < FRAME_REGIONS; i++)
+	{
+		m_fences[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~RingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RingBuffer::~RingBuffer()
+{
+	for (int i = 0; i < FRAME_REGIONS; i++)
+	{
+		WaitForRegion(i);
+	}
+	DeleteBuffer();
+}
+
+/***********************************************************
+ *  IsPersistentSupported()
+ *
+ *  This method is used for checking whether the context can
+ *  create immutable buffers that stay mapped while the GPU
+ *  reads from them.
+ ***********************************************************/
+bool RingBuffer::IsPersistentSupported()
+{
+	return(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the buffer, with room
+ *  in every region for the passed in number of bytes. The
+ *  allocations are aligned so that any of them can be bound
+ *  as a uniform block or as a shader storage block.
+ ***********************************************************/
+bool RingBuffer::Create(GLsizeiptr frameSize)
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	m_alignment = std::max(g_MinimumAlignment, (GLsizeiptr)alignment);
+	if (GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object)
+	{
+		alignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_alignment = std::max(m_alignment, (GLsizeiptr)alignment);
+	}
+
+	m_frameSize = frameSize;
+	return(CreateBuffer(AlignSize(m_frameSize + m_reservedSize, m_alignment)));
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room in every region for
+ *  the passed in number of bytes, on top of the ones asked
+ *  for when creating the buffer. The allocations of the
+ *  frame being written stay valid, so a larger buffer is
+ *  only created at the start of the next frame.
+ ***********************************************************/
+void RingBuffer::Reserve(GLsizeiptr size)
+{
+	// leave room for the padding between a few allocations
+	m_reservedSize = size + (m_alignment * 4);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting to allocate from the
+ *  region of the new frame, once the GPU has finished the
+ *  frame that last read it.
+ ***********************************************************/
+void RingBuffer::BeginFrame()
+{
+	m_waitCount = 0;
+
+	GLsizeiptr regionSize = AlignSize(m_frameSize + m_reservedSize, m_alignment);
+	if ((m_buffer != 0) && (regionSize > m_regionSize))
+	{
+		// none of the regions may be read while the buffer is replaced
+		for (int i = 0; i < FRAME_REGIONS; i++)
+		{
+			WaitForRegion(i);
+		}
+		CreateBuffer(regionSize);
+	}
+
+	WaitForRegion(m_region);
+
+	m_regionStart = m_regionSize * m_region;
+	m_head = m_regionStart;
+	m_committed = m_regionStart;
+	m_bFull = false;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for allocating a range of the region
+ *  of the current frame. The data written into it is read
+ *  by the draws of this frame, and the range is handed out
+ *  again three frames later.
+ ***********************************************************/
+bool RingBuffer::Allocate(GLsizeiptr size, ALLOCATION& allocation)
+{
+	allocation.pData = NULL;
+	allocation.offset = 0;
+	allocation.size = 0;
+
+	GLintptr offset = m_regionStart + AlignSize(m_head - m_regionStart, m_alignment);
+	if ((m_pMapped == NULL) || (offset + size > m_regionStart + m_regionSize))
+	{
+		// report a full region once per frame
+		if ((m_pMapped != NULL) && (m_bFull == false))
+		{
+			std::cout << "The " << m_regionSize << " bytes of the ring buffer frame are full, "
+				<< size << " more were asked for" << std::endl;
+			m_bFull = true;
+		}
+		return(false);
+	}
+
+	allocation.pData = m_pMapped + offset;
+	allocation.offset = offset;
+	allocation.size = size;
+	m_head = offset + size;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Commit()
+ *
+ *  This method is used for making the data written since
+ *  the last commit visible to the GPU. The coherent mapping
+ *  needs nothing more, while the copy in system memory is
+ *  uploaded into the region of the frame.
+ ***********************************************************/
+void RingBuffer::Commit()
+{
+	if ((m_bPersistent == false) && (m_buffer != 0) && (m_head > m_committed))
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glBufferSubData(
+			GL_COPY_WRITE_BUFFER,
+			m_committed,
+			m_head - m_committed,
+			&m_shadowCopy[m_committed]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	m_committed = m_head;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing a fence after the draws
+ *  of the frame, which tells when its region can be written
+ *  again, and moving on to the next region.
+ ***********************************************************/
+void RingBuffer::EndFrame()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	Commit();
+	if (m_fences[m_region] != 0)
+	{
+		glDeleteSync(m_fences[m_region]);
+	}
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_region = (m_region + 1) % FRAME_REGIONS;
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating the buffer with one
+ *  region of the passed in size per frame in flight. An
+ *  immutable buffer is mapped once for its whole lifetime,
+ *  a mutable one is written through a copy instead.
+ ***********************************************************/
+bool RingBuffer::CreateBuffer(GLsizeiptr regionSize)
+{
+	DeleteBuffer();
+
+	GLsizeiptr bufferSize = regionSize * FRAME_REGIONS;
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+
+	if (IsPersistentSupported())
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, NULL, flags);
+		m_pMapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, flags);
+		m_bPersistent = (m_pMapped != NULL);
+		if (m_bPersistent == false)
+		{
+			std::cout << "Could not map the ring buffer persistently, its data is uploaded instead" << std::endl;
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glDeleteBuffers(1, &m_buffer);
+			glGenBuffers(1, &m_buffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		}
+	}
+
+	if (m_bPersistent == false)
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, NULL, GL_DYNAMIC_DRAW);
+		m_shadowCopy.assign(bufferSize, 0);
+		m_pMapped = m_shadowCopy.data();
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	m_regionSize = regionSize;
+	m_regionStart = m_regionSize * m_region;
+	m_head = m_regionStart;
+	m_committed = m_regionStart;
+
+	return(m_buffer != 0);
+}
+
+/***********************************************************
+ *  DeleteBuffer()
+ *
+ *  This method is used for unmapping and deleting the buffer.
+ ***********************************************************/
+void RingBuffer::DeleteBuffer()
+{
+	if (m_buffer != 0)
+	{
+		if (m_bPersistent == true)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+
+	m_pMapped = NULL;
+	m_bPersistent = false;
+	m_shadowCopy.clear();
+	m_regionSize = 0;
+}
+
+/***********************************************************
+ *  WaitForRegion()
+ *
+ *  This method is used for waiting until the GPU is done
+ *  with the last frame written into a region. A wait that
+ *  does not return at once is counted, since it means the
+ *  CPU is more than the regions ahead of the GPU.
+ ***********************************************************/
+void RingBuffer::WaitForRegion(int region)
+{
+	if (m_fences[region] == 0)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(m_fences[region], 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		m_waitCount++;
+		do
+		{
+			result = glClientWaitSync(m_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "Could not wait for the fence of ring buffer region " << region << std::endl;
+	}
+
+	glDeleteSync(m_fences[region]);
+	m_fences[region] = 0;
+}
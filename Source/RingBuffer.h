@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.h
+// ============
+// hand out the per-frame dynamic data of the renderer from one buffer that
+// is split into a region per frame in flight
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  RingBuffer
+ *
+ *  This class owns a buffer with one region for each of the
+ *  frames that can be in flight at once. Every frame writes
+ *  its dynamic data, such as the camera block and the
+ *  instance attributes, into its own region, and a fence is
+ *  placed once the frame is submitted. A region is only
+ *  written again after its fence is signaled, so the GPU
+ *  never reads data that is being overwritten. The buffer
+ *  is persistently and coherently mapped when the context
+ *  supports it, so the data is written straight into the
+ *  memory the GPU reads. Otherwise it is written into a copy
+ *  in system memory and uploaded by Commit().
+ ***********************************************************/
+class RingBuffer
+{
+public:
+	// constructor
+	RingBuffer();
+	// destructor
+	~RingBuffer();
+
+	// number of frames that can be in flight at once
+	static const int FRAME_REGIONS = 3;
+
+	// a range of the region of the current frame
+	struct ALLOCATION
+	{
+		void* pData;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// whether the buffer can stay mapped while the GPU reads it
+	static bool IsPersistentSupported();
+
+	// create the buffer, with the passed in number of bytes for
+	// the small blocks written every frame, such as the camera
+	bool Create(GLsizeiptr frameSize);
+	// make room in every region for the passed in number of
+	// bytes on top of the small blocks, from the next frame on
+	void Reserve(GLsizeiptr size);
+
+	// wait until the region of the new frame is no longer read
+	// by the GPU, and start allocating from its beginning
+	void BeginFrame();
+	// allocate a range of the region of the current frame, the
+	// ranges are aligned for binding as uniform or storage blocks
+	bool Allocate(GLsizeiptr size, ALLOCATION& allocation);
+	// make the data written into the allocations visible to the
+	// GPU, which is only needed without a persistent mapping
+	void Commit();
+	// place the fence of the region of the current frame
+	void EndFrame();
+
+	// buffer the allocations are ranges of
+	GLuint GetBuffer() const { return(m_buffer); }
+	bool IsPersistent() const { return(m_bPersistent); }
+	// number of bytes allocated in the current frame, and the
+	// number of fences it had to wait on before writing
+	GLsizeiptr GetFrameBytes() const { return(m_head - m_regionStart); }
+	int GetWaitCount() const { return(m_waitCount); }
+
+private:
+	// buffer, its mapping and the size of each region
+	GLuint m_buffer;
+	unsigned char* m_pMapped;
+	bool m_bPersistent;
+	GLsizeiptr m_regionSize;
+	// copy of the buffer written without a persistent mapping
+	std::vector<unsigned char> m_shadowCopy;
+
+	// bytes asked for by Create() and by Reserve()
+	GLsizeiptr m_frameSize;
+	GLsizeiptr m_reservedSize;
+	// alignment of every allocation
+	GLsizeiptr m_alignment;
+
+	// region of the current frame, the next byte to allocate in
+	// it and the first byte not yet committed
+	int m_region;
+	GLintptr m_regionStart;
+	GLintptr m_head;
+	GLintptr m_committed;
+	bool m_bFull;
+
+	// fence of the last frame written into each region
+	GLsync m_fences[FRAME_REGIONS];
+	int m_waitCount;
+
+	// create the buffer with regions of the passed in size
+	bool CreateBuffer(GLsizeiptr regionSize);
+	// delete the buffer and its mapping
+	void DeleteBuffer();
+	// wait for the fence of a region and delete it
+	void WaitForRegion(int region);
+};
@@ -0,0 +1,400 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// load the layout of a scene from a binary file used in place, or from its
+// text form, and convert the text form into the binary one
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// "SCNE", marks the start of a binary scene file, and the
+	// version of the record layout it was written with
+	const uint32_t g_SceneMagic = 0x454E4353;
+	const uint32_t g_SceneVersion = 1;
+
+	// names of the meshes in the text form, in the order of the
+	// mesh types of the scene manager
+	const char* const g_MeshNames[] =
+	{
+		"plane",
+		"prism",
+		"box",
+		"box2",
+		"cylinder",
+		"cone",
+		"torus"
+	};
+	const int g_MeshCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+
+	// copy a word of the text form into a fixed-size field of a
+	// record, returns false when it does not fit
+	bool CopyName(const std::string& name, char* field, size_t fieldLength)
+	{
+		if (name.size() >= fieldLength)
+		{
+			return(false);
+		}
+
+		memset(field, 0, fieldLength);
+		memcpy(field, name.c_str(), name.size());
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pTextures = NULL;
+	m_textureCount = 0;
+	m_pMaterials = NULL;
+	m_materialCount = 0;
+	m_pNodes = NULL;
+	m_nodeCount = 0;
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for loading the records of a scene
+ *  file. A file starting with the binary header is mapped
+ *  and used in place, any other file is parsed as the text
+ *  form.
+ ***********************************************************/
+bool SceneFile::Open(const char* filename)
+{
+	Close();
+
+	uint32_t magic = 0;
+	if ((m_file.Open(filename) == true) && (m_file.GetSize() >= sizeof(magic)))
+	{
+		memcpy(&magic, m_file.GetData(), sizeof(magic));
+	}
+
+	bool bLoaded = false;
+	if (magic == g_SceneMagic)
+	{
+		bLoaded = MapBinary(filename);
+	}
+	else
+	{
+		m_file.Close();
+		bLoaded = ParseText(filename);
+	}
+
+	if (bLoaded == false)
+	{
+		Close();
+	}
+
+	return(bLoaded);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for freeing the records of the
+ *  loaded scene and unmapping the binary file.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_file.Close();
+	m_textures.clear();
+	m_materials.clear();
+	m_nodes.clear();
+
+	m_pTextures = NULL;
+	m_textureCount = 0;
+	m_pMaterials = NULL;
+	m_materialCount = 0;
+	m_pNodes = NULL;
+	m_nodeCount = 0;
+}
+
+/***********************************************************
+ *  GetMeshCount()
+ *
+ *  This method is used for getting the number of meshes
+ *  the nodes of a scene file can draw.
+ ***********************************************************/
+int SceneFile::GetMeshCount()
+{
+	return(g_MeshCount);
+}
+
+/***********************************************************
+ *  MapBinary()
+ *
+ *  This method is used for pointing the records at the
+ *  arrays of the mapped binary file. The arrays have to be
+ *  inside of the file and aligned for their records, and
+ *  the nodes have to refer to existing records, since they
+ *  are used without being copied.
+ ***********************************************************/
+bool SceneFile::MapBinary(const char* filename)
+{
+	BINARY_HEADER header;
+	if (m_file.GetSize() < sizeof(header))
+	{
+		std::cout << "Truncated scene file: " << filename << std::endl;
+		return(false);
+	}
+	memcpy(&header, m_file.GetData(), sizeof(header));
+	if (header.version != g_SceneVersion)
+	{
+		std::cout << "Scene file " << filename << " has version " << header.version
+			<< ", expected " << g_SceneVersion << std::endl;
+		return(false);
+	}
+
+	// the sizes are checked in 64 bits, so that large counts in a
+	// damaged file cannot wrap around
+	const uint64_t fileSize = m_file.GetSize();
+	if (((header.textureOffset % 4) != 0) || ((header.materialOffset % 4) != 0) || ((header.nodeOffset % 4) != 0) ||
+		(header.textureOffset + (uint64_t)header.textureCount * sizeof(TEXTURE_RECORD) > fileSize) ||
+		(header.materialOffset + (uint64_t)header.materialCount * sizeof(MATERIAL_RECORD) > fileSize) ||
+		(header.nodeOffset + (uint64_t)header.nodeCount * sizeof(NODE_RECORD) > fileSize))
+	{
+		std::cout << "Invalid record arrays in scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	m_pTextures = (const TEXTURE_RECORD*)(m_file.GetData() + header.textureOffset);
+	m_textureCount = (int)header.textureCount;
+	m_pMaterials = (const MATERIAL_RECORD*)(m_file.GetData() + header.materialOffset);
+	m_materialCount = (int)header.materialCount;
+	m_pNodes = (const NODE_RECORD*)(m_file.GetData() + header.nodeOffset);
+	m_nodeCount = (int)header.nodeCount;
+
+	// the names are used as strings, so they must be terminated
+	for (int i = 0; i < m_textureCount; i++)
+	{
+		if ((m_pTextures[i].filename[FILENAME_LENGTH - 1] != 0) || (m_pTextures[i].tag[TAG_LENGTH - 1] != 0))
+		{
+			std::cout << "Invalid texture record " << i << " in scene file: " << filename << std::endl;
+			return(false);
+		}
+	}
+	for (int i = 0; i < m_materialCount; i++)
+	{
+		if (m_pMaterials[i].tag[TAG_LENGTH - 1] != 0)
+		{
+			std::cout << "Invalid material record " << i << " in scene file: " << filename << std::endl;
+			return(false);
+		}
+	}
+	if (ValidateNodes() == false)
+	{
+		std::cout << "Invalid node records in scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ParseText()
+ *
+ *  This method is used for parsing the records of the text
+ *  form of a scene file. The tags of the nodes are resolved
+ *  into indices of the records defined above them.
+ ***********************************************************/
+bool SceneFile::ParseText(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if ((line.empty()) || (line[0] == '#') || (line.find_first_not_of(" \t\r") == std::string::npos))
+		{
+			continue;
+		}
+
+		std::istringstream values(line);
+		std::string type;
+		values >> type;
+
+		bool bValid = false;
+		if (type == "texture")
+		{
+			TEXTURE_RECORD texture;
+			std::string textureFile;
+			std::string tag;
+			values >> textureFile >> tag;
+			bValid = (!values.fail()) &&
+				(CopyName(textureFile, texture.filename, FILENAME_LENGTH)) &&
+				(CopyName(tag, texture.tag, TAG_LENGTH));
+			if (bValid)
+			{
+				m_textures.push_back(texture);
+			}
+		}
+		else if (type == "material")
+		{
+			MATERIAL_RECORD material;
+			std::string tag;
+			values >> tag
+				>> material.ambientColor[0] >> material.ambientColor[1] >> material.ambientColor[2]
+				>> material.ambientStrength
+				>> material.diffuseColor[0] >> material.diffuseColor[1] >> material.diffuseColor[2]
+				>> material.specularColor[0] >> material.specularColor[1] >> material.specularColor[2]
+				>> material.shininess;
+			bValid = (!values.fail()) && (CopyName(tag, material.tag, TAG_LENGTH));
+			if (bValid)
+			{
+				m_materials.push_back(material);
+			}
+		}
+		else if (type == "node")
+		{
+			NODE_RECORD node;
+			std::string meshName;
+			std::string textureTag;
+			std::string materialTag;
+			values >> meshName
+				>> node.scaleXYZ[0] >> node.scaleXYZ[1] >> node.scaleXYZ[2]
+				>> node.rotationDegrees[0] >> node.rotationDegrees[1] >> node.rotationDegrees[2]
+				>> node.positionXYZ[0] >> node.positionXYZ[1] >> node.positionXYZ[2]
+				>> textureTag >> materialTag;
+
+			node.mesh = g_MeshCount;
+			for (int i = 0; i < g_MeshCount; i++)
+			{
+				if (meshName == g_MeshNames[i])
+				{
+					node.mesh = i;
+				}
+			}
+
+			// the tags refer to the records defined so far
+			node.texture = -1;
+			for (unsigned int i = 0; i < m_textures.size(); i++)
+			{
+				if (textureTag == m_textures[i].tag)
+				{
+					node.texture = i;
+				}
+			}
+			node.material = -1;
+			for (unsigned int i = 0; i < m_materials.size(); i++)
+			{
+				if (materialTag == m_materials[i].tag)
+				{
+					node.material = i;
+				}
+			}
+
+			bValid = (!values.fail()) && (node.mesh < (uint32_t)g_MeshCount) &&
+				((node.texture >= 0) || (textureTag == "-")) &&
+				((node.material >= 0) || (materialTag == "-"));
+			if (bValid)
+			{
+				m_nodes.push_back(node);
+			}
+		}
+
+		if (bValid == false)
+		{
+			std::cout << "Invalid scene record on line " << lineNumber << " of " << filename << std::endl;
+			return(false);
+		}
+	}
+
+	m_pTextures = m_textures.data();
+	m_textureCount = (int)m_textures.size();
+	m_pMaterials = m_materials.data();
+	m_materialCount = (int)m_materials.size();
+	m_pNodes = m_nodes.data();
+	m_nodeCount = (int)m_nodes.size();
+
+	return(true);
+}
+
+/***********************************************************
+ *  ValidateNodes()
+ *
+ *  This method is used for checking that every node draws
+ *  a known mesh and refers to existing texture and material
+ *  records, or none.
+ ***********************************************************/
+bool SceneFile::ValidateNodes() const
+{
+	for (int i = 0; i < m_nodeCount; i++)
+	{
+		const NODE_RECORD& node = m_pNodes[i];
+
+		if ((node.mesh >= (uint32_t)g_MeshCount) ||
+			(node.texture < -1) || (node.texture >= m_textureCount) ||
+			(node.material < -1) || (node.material >= m_materialCount))
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteBinary()
+ *
+ *  This method is used for writing the loaded records into
+ *  a binary scene file, as the header followed by the
+ *  texture, material and node arrays.
+ ***********************************************************/
+bool SceneFile::WriteBinary(const char* filename) const
+{
+	BINARY_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = g_SceneMagic;
+	header.version = g_SceneVersion;
+	header.textureCount = (uint32_t)m_textureCount;
+	header.textureOffset = sizeof(header);
+	header.materialCount = (uint32_t)m_materialCount;
+	header.materialOffset = header.textureOffset + header.textureCount * sizeof(TEXTURE_RECORD);
+	header.nodeCount = (uint32_t)m_nodeCount;
+	header.nodeOffset = header.materialOffset + header.materialCount * sizeof(MATERIAL_RECORD);
+
+	FILE* pFile = fopen(filename, "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	fwrite(&header, sizeof(header), 1, pFile);
+	fwrite(m_pTextures, sizeof(TEXTURE_RECORD), m_textureCount, pFile);
+	fwrite(m_pMaterials, sizeof(MATERIAL_RECORD), m_materialCount, pFile);
+	fwrite(m_pNodes, sizeof(NODE_RECORD), m_nodeCount, pFile);
+	bool bWritten = (ferror(pFile) == 0);
+	fclose(pFile);
+
+	if (bWritten == false)
+	{
+		std::cout << "Could not write scene file: " << filename << std::endl;
+	}
+
+	return(bWritten);
+}
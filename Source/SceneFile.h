@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// load the layout of a scene from a binary file used in place, or from its
+// text form, and convert the text form into the binary one
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class holds the texture files, the materials and
+ *  the nodes of a scene as three arrays of fixed-size
+ *  records, which refer to each other by index. A binary
+ *  scene file is the header followed by the arrays, so it
+ *  is mapped into memory and the records are read straight
+ *  from the mapping, without being parsed or copied. The
+ *  text form has one record per line, and is parsed into
+ *  arrays of the same records:
+ *
+ *    texture <image file> <tag>
+ *    material <tag> <ambient r g b> <ambient strength>
+ *        <diffuse r g b> <specular r g b> <shininess>
+ *    node <mesh> <scale x y z> <rotation x y z> <position x y z>
+ *        <texture tag> <material tag>
+ *
+ *  Empty lines and lines starting with # are skipped, and a
+ *  tag of - leaves the node without a texture or material.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+
+	// longest image file name and tag, with the terminator
+	static const int FILENAME_LENGTH = 64;
+	static const int TAG_LENGTH = 32;
+
+	// an image file loaded as a texture of the scene
+	struct TEXTURE_RECORD
+	{
+		char filename[FILENAME_LENGTH];
+		char tag[TAG_LENGTH];
+	};
+
+	// the values of a material the nodes are drawn with
+	struct MATERIAL_RECORD
+	{
+		float ambientColor[3];
+		float ambientStrength;
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+		char tag[TAG_LENGTH];
+	};
+
+	// an object of the scene, with the index of its texture and
+	// material records, or -1 for none
+	struct NODE_RECORD
+	{
+		uint32_t mesh;
+		float scaleXYZ[3];
+		float rotationDegrees[3];
+		float positionXYZ[3];
+		int32_t texture;
+		int32_t material;
+	};
+
+	// load a scene file, which is read as the text form unless it
+	// starts with the binary header
+	bool Open(const char* filename);
+	// free the records, and unmap the binary file
+	void Close();
+
+	// write the loaded records into a binary scene file
+	bool WriteBinary(const char* filename) const;
+
+	// records of the loaded scene, which stay valid until the file
+	// is closed
+	int GetTextureCount() const { return(m_textureCount); }
+	const TEXTURE_RECORD* GetTextures() const { return(m_pTextures); }
+	int GetMaterialCount() const { return(m_materialCount); }
+	const MATERIAL_RECORD* GetMaterials() const { return(m_pMaterials); }
+	int GetNodeCount() const { return(m_nodeCount); }
+	const NODE_RECORD* GetNodes() const { return(m_pNodes); }
+
+	// whether the records are read in place from a binary file
+	bool IsMapped() const { return(m_file.IsOpen()); }
+
+	// number of meshes the nodes can draw, the mesh index of the
+	// records is in the order of the mesh types of the scene
+	static int GetMeshCount();
+
+private:
+	// layout of the header at the start of a binary scene file,
+	// the offsets are in bytes from the start of the file
+	struct BINARY_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t textureCount;
+		uint32_t textureOffset;
+		uint32_t materialCount;
+		uint32_t materialOffset;
+		uint32_t nodeCount;
+		uint32_t nodeOffset;
+	};
+
+	// the mapped binary file the records are read from
+	MappedFile m_file;
+	// records parsed from the text form
+	std::vector<TEXTURE_RECORD> m_textures;
+	std::vector<MATERIAL_RECORD> m_materials;
+	std::vector<NODE_RECORD> m_nodes;
+
+	// records of the loaded scene, in either of the two
+	const TEXTURE_RECORD* m_pTextures;
+	int m_textureCount;
+	const MATERIAL_RECORD* m_pMaterials;
+	int m_materialCount;
+	const NODE_RECORD* m_pNodes;
+	int m_nodeCount;
+
+	// point the records into the mapped binary file, after checking
+	// that they are inside of it and refer to each other correctly
+	bool MapBinary(const char* filename);
+	// parse the records of the text form
+	bool ParseText(const char* filename);
+	// whether the texture and material indices of the nodes are
+	// inside of their arrays
+	bool ValidateNodes() const;
+};
@@ -1,1358 +1,2711 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.cpp
-// ============
-// manage the preparing and rendering of 3D scenes - textures, materials, lighting
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-
-	// initialize the texture collection
-	for (int i = 0; i < 16; i++)
-	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
-	}
-	m_loadedTextures = 0;
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	// clear the allocated memory
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-	// destroy the created OpenGL textures
-	DestroyGLTextures();
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	unsigned int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationZ * rotationY * rotationX * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-			
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-/***********************************************************
-  *  DefineObjectMaterials()
-  *
-  *  This method is used for configuring the various material
-  *  settings for all of the objects within the 3D scene.
-  ***********************************************************/
-void SceneManager::DefineObjectMaterials()
-{
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
-
-	OBJECT_MATERIAL carbonMaterial;
-	carbonMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.01f);
-	carbonMaterial.ambientStrength = 0.4f;
-	carbonMaterial.diffuseColor = glm::vec3(0.05f, 0.05f, 0.05f);
-	carbonMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	carbonMaterial.shininess = 5.0f;
-	carbonMaterial.tag = "carbon";
-	m_objectMaterials.push_back(carbonMaterial);
-
-	OBJECT_MATERIAL plasticMaterial;
-	plasticMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	plasticMaterial.ambientStrength = 0.3f;
-	plasticMaterial.diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	plasticMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	plasticMaterial.shininess = 25.0f;
-	plasticMaterial.tag = "plastic";
-	m_objectMaterials.push_back(plasticMaterial);
-
-	OBJECT_MATERIAL fabricMaterial;
-	fabricMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.01f);
-	fabricMaterial.ambientStrength = 0.1f;
-	fabricMaterial.diffuseColor = glm::vec3(0.05f, 0.05f, 0.05f);
-	fabricMaterial.specularColor = glm::vec3(0.01f, 0.01f, 0.01f);
-	fabricMaterial.shininess = 5.0f;
-	fabricMaterial.tag = "fabric";
-	m_objectMaterials.push_back(fabricMaterial);
-
-	OBJECT_MATERIAL noteMaterial;
-	noteMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.2f);
-	noteMaterial.ambientStrength = 0.4f;
-	noteMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.4f);
-	noteMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	noteMaterial.shininess = 100.0f;
-	noteMaterial.tag = "note";
-	m_objectMaterials.push_back(noteMaterial);
-
-	OBJECT_MATERIAL woodMaterial;
-	woodMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.05f);
-	woodMaterial.ambientStrength = 0.1f;
-	woodMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.15f);
-	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.05f);
-	woodMaterial.shininess = 50.0f;
-	woodMaterial.tag = "wood";
-	m_objectMaterials.push_back(woodMaterial);
-
-	OBJECT_MATERIAL pencilMaterial;
-	pencilMaterial.ambientColor = glm::vec3(0.3f, 0.3f, 0.0f);
-	pencilMaterial.ambientStrength = 0.4f;
-	pencilMaterial.diffuseColor = glm::vec3(0.7f, 0.7f, 0.0f);
-	pencilMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.0f);
-	pencilMaterial.shininess = 10.0f;
-	pencilMaterial.tag = "pencil";
-	m_objectMaterials.push_back(pencilMaterial);
-
-	OBJECT_MATERIAL metalMaterial;
-	metalMaterial.ambientColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	metalMaterial.ambientStrength = 0.4f;
-	metalMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
-	metalMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.9f);
-	metalMaterial.shininess = 100.0f;
-	metalMaterial.tag = "metal";
-	m_objectMaterials.push_back(metalMaterial);
-
-	OBJECT_MATERIAL rubberMaterial;
-	rubberMaterial.ambientColor = glm::vec3(0.5f, 0.37f, 0.4f);
-	rubberMaterial.ambientStrength = 0.9f;
-	rubberMaterial.diffuseColor = glm::vec3(0.5f, 0.37f, 0.4f);
-	rubberMaterial.specularColor = glm::vec3(0.01f, 0.007f, 0.008f);
-	rubberMaterial.shininess = 10.0f;
-	rubberMaterial.tag = "rubber";
-	m_objectMaterials.push_back(rubberMaterial);
-
-}
-
-/***********************************************************
-* LoadSceneTextures()
-*
-* This method is used for preparing the 3D scene by loading
-* the shapes, textures in memory to support the 3D scene
-* rendering
-***********************************************************/
-void SceneManager::LoadSceneTextures()
-{
-	bool bReturn = false;
-
-	
-	bReturn = CreateGLTexture(
-		"textures/desktop.jpg", "desk"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/keyboard.jpg", "keyboard"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/rest.jpg", "rest"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/notebook.jpg", "notebook"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/metal.jpg", "metal"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/wood.jpg", "wood"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/pencil.jpg", "pencil"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/metal1.jpg", "metal1"
-	);
-
-	bReturn = CreateGLTexture(
-		"textures/eraser.jpg", "eraser"
-	);
-
-	BindGLTextures();
-
-}
-
-/***********************************************************
- *  SetupSceneLights()
- *
- *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
- ***********************************************************/
-void SceneManager::SetupSceneLights()
-{
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting, if no light sources have
-	// been added then the display window will be black - to use the 
-	// default OpenGL lighting then comment out the following line
-	//m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help                              ***/
-
-	m_pShaderManager->setVec3Value("directionalLight.direction", -5.0f, -5.0f, -4.0f);
-	m_pShaderManager->setVec3Value("directionalLight.ambient", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("directionalLight.specular", 0.6f, 0.6f, 0.6f);
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
-
-	m_pShaderManager->setVec3Value("pointLights[0].position", 0.0f, 8.0f, 1.0f);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", 0.4f, 0.4f, 0.3f);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", 0.8f, 0.8f, 0.7f);
-	m_pShaderManager->setVec3Value("pointLights[0].specular", 0.9f, 0.9f, 0.8f);
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
-
-
-	m_pShaderManager->setBoolValue("bUseLighting", true);
-}
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	DefineObjectMaterials();
-	LoadSceneTextures();
-	SetupSceneLights();
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadPrismMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadBoxMesh2();
-
-
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(15.0f, 1.0f, 5.0f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 4.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1, 1, 1, 1);
-	SetShaderMaterial("carbon");
-	SetShaderTexture("desk");
-
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/******************************************************************/
-
-	/*** Keyboard ***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(10.0f, 0.2f, 4.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 1.8f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.05f, 4.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderTexture("keyboard");
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawBoxMesh();
-
-
-	// draw the mesh with transformation values
-
-
-	/****************************************************************/
-
-	/*** Coaster ***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 0.05f, 1.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(7.0f, 0.0f, 4.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderTexture("rest");
-	SetShaderMaterial("fabric");
-
-	m_basicMeshes->DrawCylinderMesh(); 
-
-
-	// draw the mesh with transformation values
-
-
-	/****************************************************************/
-
-	/*** WristRest ***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(9.5f, 0.05f, 1.5f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.05f, 7.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawBoxMesh();
-
-	// top part
-	scaleXYZ = glm::vec3(9.4f, 0.15f, 1.4f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.1f, 7.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawBoxMesh();
-
-
-	/****************************************************************/
-
-	/*** Notebook ***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.8f, 0.1f, 6.0f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-9.0f, 0.05f, 4.5f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderTexture("notebook");
-	SetShaderMaterial("note");
-
-	m_basicMeshes->DrawBoxMesh2();
-
-
-	// draw the mesh with transformation values
-
-
-	/****************************************************************/
-
-	/*** Spirals ***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.1f, 0.1f, 0.05f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 4.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderTexture("metal");
-	SetShaderMaterial("metal");
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 4.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 4.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 4.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 4.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 5.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 5.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 5.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 5.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 5.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 6.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 6.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 6.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 6.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 6.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 7.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 7.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 7.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 3.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 3.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 3.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 3.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 3.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 2.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 2.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 2.4f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 2.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 2.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 1.8f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.4f, 0.05f, 1.6f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// draw the mesh with transformation values
-
-	/****************************************************************/
-
-	/*** Pencils ***/
-	/******************************************************************/
-	// set the XYZ scale for the pencil tips
-	scaleXYZ = glm::vec3(0.1f, 0.3f, 0.1f);
-
-	// set the XYZ rotation for the pencil tips
-	XrotationDegrees = -90.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-9.8f, 0.2f, 2.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderMaterial("wood");
-	SetShaderTexture("wood");
-
-	m_basicMeshes->DrawConeMesh();
-	// draw the mesh with transformation values
-
-	positionXYZ = glm::vec3(-10.3f, 0.2f, 2.7f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawConeMesh();
-
-	// set the XYZ scale for the pencil barrels
-	scaleXYZ = glm::vec3(0.1f, 3.253f, 0.1f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-7.5f, 0.2f, 4.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderMaterial("pencil");
-	SetShaderTexture("pencil");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	positionXYZ = glm::vec3(-8.0f, 0.2f, 5.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// set the XYZ scale for the metal connector
-	scaleXYZ = glm::vec3(0.105f, 0.3f, 0.105f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-7.3f, 0.2f, 4.7f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderMaterial("metal");
-	SetShaderTexture("metal1");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-7.8f, 0.2f, 5.2f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// set the XYZ scale for the eraser
-	scaleXYZ = glm::vec3(0.1f, 0.2f, 0.1f);
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-7.2f, 0.2f, 4.8f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1);
-	SetShaderMaterial("rubber");
-	SetShaderTexture("eraser");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-7.7f, 0.2f, 5.3f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************************************************************/
-
-}
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.cpp
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "TextureBaker.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UseTextureName = "bUseTexture";
+	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseInstancingName = "bUseInstancing";
+	// decoded textures uploaded per frame while loading
+	const int g_TextureUploadsPerFrame = 2;
+
+	// shader source the shader variants are compiled from, and the
+	// start of the file names their program binaries are saved under
+	const char* g_VertexShaderFile = "shaders/vertexShader.glsl";
+	const char* g_FragmentShaderFile = "shaders/fragmentShader.glsl";
+	const char* g_ShaderCachePrefix = "shaders/program_";
+
+	// width and height of each shadow cascade
+	const int g_ShadowMapResolution = 1024;
+
+	// projected sizes, in half heights of the viewport, below which
+	// the round meshes change to the middle and the coarsest level
+	// of detail, and how far past a threshold the size has to move
+	// before the level changes back
+	const float g_LodFineThreshold = 0.2f;
+	const float g_LodCoarseThreshold = 0.05f;
+	const float g_LodHysteresis = 0.2f;
+
+	// scene nodes and draw batches each worker thread job takes at
+	// once, small scenes fit in one chunk and stay on the calling
+	// thread
+	const int g_NodesPerJob = 4096;
+	const int g_BatchesPerJob = 16;
+	// starting size of the scratch memory of a frame, in bytes,
+	// which grows to the largest frame seen
+	const size_t g_FrameArenaSize = 256 * 1024;
+
+	// a prop of the desk that the stress scene is filled with - the
+	// mesh, its size and how it lies on the ground
+	struct STRESS_PROP
+	{
+		SceneManager::MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float height;
+	};
+	const STRESS_PROP g_StressProps[] =
+	{
+		{ SceneManager::MESH_BOX, glm::vec3(0.9f, 0.08f, 0.35f), 1.8f, 0.04f },			// keyboard
+		{ SceneManager::MESH_BOX2, glm::vec3(0.5f, 0.04f, 0.6f), 0.0f, 0.02f },			// notebook
+		{ SceneManager::MESH_TORUS, glm::vec3(0.25f, 0.25f, 0.12f), 90.0f, 0.25f },		// coil ring
+		{ SceneManager::MESH_CYLINDER, glm::vec3(0.05f, 0.8f, 0.05f), -90.0f, 0.05f },	// pencil
+		{ SceneManager::MESH_CONE, glm::vec3(0.05f, 0.15f, 0.05f), -90.0f, 0.05f },		// pencil tip
+		{ SceneManager::MESH_CYLINDER, glm::vec3(0.3f, 0.03f, 0.3f), 0.0f, 0.0f }		// coaster
+	};
+	const int g_StressPropCount = sizeof(g_StressProps) / sizeof(g_StressProps[0]);
+	// distance between the props of the stress scene, and the seed
+	// of its random placement, so every run gets the same scene
+	const float g_StressSpacing = 1.0f;
+	const unsigned int g_StressSeed = 330;
+
+	// file the generated meshes are cached in between launches
+	const char* g_MeshCacheFile = "meshcache.bin";
+
+	// image files of the scene textures and their tags
+	struct SCENE_TEXTURE
+	{
+		const char* filename;
+		const char* tag;
+	};
+	const SCENE_TEXTURE g_SceneTextures[] =
+	{
+		{ "textures/desktop.jpg", "desk" },
+		{ "textures/keyboard.jpg", "keyboard" },
+		{ "textures/rest.jpg", "rest" },
+		{ "textures/notebook.jpg", "notebook" },
+		{ "textures/metal.jpg", "metal" },
+		{ "textures/wood.jpg", "wood" },
+		{ "textures/pencil.jpg", "pencil" },
+		{ "textures/metal1.jpg", "metal1" },
+		{ "textures/eraser.jpg", "eraser" }
+	};
+	const int g_SceneTextureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(
+	ShaderManager *pShaderManager,
+	ShaderStateCache* pShaderState,
+	UniformBlocks* pUniformBlocks)
+{
+	m_pShaderManager = pShaderManager;
+	m_pShaderState = pShaderState;
+	m_pUniformBlocks = pUniformBlocks;
+	m_basicMeshes = new ShapeMeshes();
+	m_instancedMeshes = new InstancedMeshes();
+	m_pGpuCulling = new GpuCulling();
+	m_pLightClusters = new LightClusters();
+	m_pShaderVariants = new ShaderVariants(pUniformBlocks);
+	m_variantPrograms[0] = 0;
+	m_variantPrograms[1] = 0;
+	m_bShaderVariants = true;
+	m_baseProgram = 0;
+	m_pShadowCascades = new ShadowCascades();
+	m_depthProgram = 0;
+	m_shadowLightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_shadowUnit = 0;
+	m_shadowFirstCommand = 0;
+	m_shadowCommandCount = 0;
+	m_bShadows = true;
+	m_bMeshCache = true;
+	m_bBasicMeshesLoaded = false;
+	m_stressObjectCount = 0;
+	m_pRingBuffer = NULL;
+	m_bInstancesChanged = true;
+	m_bSharedInstancesCurrent = false;
+	m_ringInstanceFrames = RingBuffer::FRAME_REGIONS;
+	m_bShadowsValid = false;
+	m_pThreadPool = new ThreadPool();
+	m_pFrameArena = new FrameArena(g_FrameArenaSize);
+	m_pTextureLoader = new TextureLoader(m_pThreadPool);
+
+	// intern the uniform names once, so the per-frame uniform
+	// uploads do not look up any names
+	m_uniformIDs.model = m_pShaderState->GetUniformID(g_ModelName);
+	m_uniformIDs.objectColor = m_pShaderState->GetUniformID(g_ColorValueName);
+	m_uniformIDs.objectTexture = m_pShaderState->GetUniformID(g_TextureValueName);
+	m_uniformIDs.textureLayer = m_pShaderState->GetUniformID("textureLayer");
+	m_uniformIDs.useTexture = m_pShaderState->GetUniformID(g_UseTextureName);
+	m_uniformIDs.useInstancing = m_pShaderState->GetUniformID(g_UseInstancingName);
+	m_uniformIDs.UVscale = m_pShaderState->GetUniformID("UVscale");
+	m_uniformIDs.materialIndex = m_pShaderState->GetUniformID("materialIndex");
+	m_uniformIDs.clusterTileSize = m_pShaderState->GetUniformID("clusterTileSize");
+	m_uniformIDs.clusterDepthScale = m_pShaderState->GetUniformID("clusterDepthScale");
+	m_uniformIDs.clusterDepthBias = m_pShaderState->GetUniformID("clusterDepthBias");
+	m_uniformIDs.lightViewProjection = m_pShaderState->GetUniformID("lightViewProjection");
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		std::ostringstream name;
+		name << "shadowMatrices[" << i << "]";
+		m_uniformIDs.shadowMatrices[i] = m_pShaderState->GetUniformID(name.str().c_str());
+	}
+	m_uniformIDs.shadowSplitDepths = m_pShaderState->GetUniformID("shadowSplitDepths");
+
+	// initialize the texture collection
+	m_textureIDs.clear();
+	m_overflowUnit = 0;
+	m_overflowTexture = 0;
+	m_bTexturesPacked = false;
+	m_bTransformsDirty = false;
+	m_unsortedStateChanges = 0;
+	memset(&m_drawStats, 0, sizeof(m_drawStats));
+	m_submitMode = SUBMIT_INSTANCED;
+	for (int i = 0; i <= MESH_TORUS; i++)
+	{
+		for (int lod = 0; lod < MESH_LOD_LEVELS; lod++)
+		{
+			m_instancedMeshIDs[i][lod] = -1;
+		}
+		m_meshLodCount[i] = 1;
+		m_meshBounds[i].minimum = glm::vec3(0.0f);
+		m_meshBounds[i].maximum = glm::vec3(0.0f);
+	}
+	m_bFrustumCulling = true;
+	m_cullViewProjection = glm::mat4(1.0f);
+	m_bCullingValid = false;
+	m_visibleCount = 0;
+	memset(m_lodCounts, 0, sizeof(m_lodCounts));
+	m_bGpuCulling = false;
+	m_bIndirectForGpu = false;
+	m_lightingPath = LIGHTING_CLUSTERED;
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// clear the allocated memory
+	m_pShaderManager = NULL;
+	m_pShaderState = NULL;
+	m_pUniformBlocks = NULL;
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	delete m_pGpuCulling;
+	m_pGpuCulling = NULL;
+	delete m_pLightClusters;
+	m_pLightClusters = NULL;
+	delete m_pShaderVariants;
+	m_pShaderVariants = NULL;
+	delete m_pShadowCascades;
+	m_pShadowCascades = NULL;
+	delete m_instancedMeshes;
+	m_instancedMeshes = NULL;
+	// the loader waits for its decode jobs before the
+	// worker threads are stopped
+	delete m_pTextureLoader;
+	m_pTextureLoader = NULL;
+	delete m_pThreadPool;
+	m_pThreadPool = NULL;
+	delete m_pFrameArena;
+	m_pFrameArena = NULL;
+	// destroy the created OpenGL textures
+	DestroyGLTextures();
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, const std::string& tag)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	GLuint textureID = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// try to parse the image data from the specified image file
+	unsigned char* image = stbi_load(
+		filename,
+		&width,
+		&height,
+		&colorChannels,
+		0);
+
+	// if the image was successfully read from the image file
+	if (image)
+	{
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+		glGenTextures(1, &textureID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// if the loaded image is in RGB format
+		if (colorChannels == 3)
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, width, height, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+		// if the loaded image is in RGBA format - it supports transparency
+		else if (colorChannels == 4)
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+		else
+		{
+			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			return false;
+		}
+
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		// free the image data from local memory
+		stbi_image_free(image);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0); // Unbind the texture
+
+		// register the loaded texture and associate it with the special tag string
+		TEXTURE_INFO texture;
+		texture.ID = textureID;
+		texture.tag = tag;
+		texture.layer = 0;
+		texture.unit = -1;
+		m_textureIDs.push_back(texture);
+
+		return true;
+	}
+
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+/***********************************************************
+ *  CreateGLTextureAsync()
+ *
+ *  This method is used for loading textures from image files
+ *  in the background. The texture slot is taken right away
+ *  by a texture holding a placeholder image, and the image
+ *  is decoded on a worker thread and uploaded into the same
+ *  texture once it is ready.
+ ***********************************************************/
+bool SceneManager::CreateGLTextureAsync(const char* filename, const std::string& tag)
+{
+	GLuint textureID = m_pTextureLoader->LoadTexture(filename);
+
+	// register the loading texture and associate it with the special tag string
+	TEXTURE_INFO texture;
+	texture.ID = textureID;
+	texture.tag = tag;
+	texture.layer = 0;
+	texture.unit = -1;
+	m_textureIDs.push_back(texture);
+
+	return true;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots. Textures packed into the
+ *  same texture array share one slot. When there are more
+ *  texture arrays than slots, the last slot is shared by
+ *  the remaining ones, which are bound when drawn.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	GLint maxTextureUnits = 16;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+
+	// the last units are kept for the light cluster buffer
+	// textures and the shadow cascades, the one before them is
+	// shared by the texture arrays that do not get a unit of
+	// their own
+	m_lightClusterUnit = maxTextureUnits - LightClusters::TEXTURE_UNIT_COUNT;
+	m_shadowUnit = m_lightClusterUnit - 1;
+	m_overflowUnit = m_shadowUnit - 1;
+	m_overflowTexture = 0;
+
+	int unitCount = 0;
+	for (unsigned int i = 0; i < m_textureIDs.size(); i++)
+	{
+		// reuse the slot of an earlier layer of the same array
+		m_textureIDs[i].unit = -1;
+		for (unsigned int j = 0; (j < i) && (m_textureIDs[i].unit < 0); j++)
+		{
+			if (m_textureIDs[j].ID == m_textureIDs[i].ID)
+			{
+				m_textureIDs[i].unit = m_textureIDs[j].unit;
+			}
+		}
+		if (m_textureIDs[i].unit >= 0)
+		{
+			continue;
+		}
+
+		m_textureIDs[i].unit = unitCount;
+		if (unitCount < m_overflowUnit)
+		{
+			// bind textures on corresponding texture units
+			glActiveTexture(GL_TEXTURE0 + unitCount);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureIDs[i].ID);
+		}
+		unitCount++;
+	}
+
+	if (unitCount > m_overflowUnit)
+	{
+		std::cout << "Sharing the last texture slot between " << (unitCount - m_overflowUnit)
+			<< " texture arrays" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  PackGLTextures()
+ *
+ *  This method is used for packing the loaded textures that
+ *  have the same size and format into texture arrays, once
+ *  all of them have finished loading. The textures are then
+ *  bound again and the draw list is sorted by the arrays.
+ ***********************************************************/
+void SceneManager::PackGLTextures()
+{
+	std::vector<GLuint> textureIDs;
+	std::vector<int> layers;
+
+	for (unsigned int i = 0; i < m_textureIDs.size(); i++)
+	{
+		textureIDs.push_back(m_textureIDs[i].ID);
+	}
+
+	m_pTextureLoader->PackTextureArrays(textureIDs, layers);
+
+	for (unsigned int i = 0; i < m_textureIDs.size(); i++)
+	{
+		m_textureIDs[i].ID = textureIDs[i];
+		m_textureIDs[i].layer = layers[i];
+	}
+
+	BindGLTextures();
+	CompileDrawList();
+	m_bTexturesPacked = true;
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	for (unsigned int i = 0; i < m_textureIDs.size(); i++)
+	{
+		// the layers of an array share one texture, which is
+		// only deleted the first time
+		if (m_textureIDs[i].ID != 0)
+		{
+			GLuint textureID = m_textureIDs[i].ID;
+			glDeleteTextures(1, &textureID);
+
+			for (unsigned int j = i; j < m_textureIDs.size(); j++)
+			{
+				if (m_textureIDs[j].ID == textureID)
+				{
+					m_textureIDs[j].ID = 0;
+				}
+			}
+		}
+	}
+	m_textureIDs.clear();
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(const std::string& tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < (int)m_textureIDs.size()) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const std::string& tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < (int)m_textureIDs.size()) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	unsigned int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(bFound);
+}
+
+/***********************************************************
+ *  LoadMaterialTable()
+ *
+ *  This method is used for uploading all of the defined
+ *  materials into the material table uniform block, where
+ *  the draws select their material by index.
+ ***********************************************************/
+void SceneManager::LoadMaterialTable()
+{
+	std::vector<UniformBlocks::MATERIAL> materials;
+
+	for (unsigned int i = 0; i < m_objectMaterials.size(); i++)
+	{
+		UniformBlocks::MATERIAL material;
+
+		material.diffuseColor = m_objectMaterials[i].diffuseColor;
+		material.shininess = m_objectMaterials[i].shininess;
+		material.specularColor = m_objectMaterials[i].specularColor;
+		material.padding = 0.0f;
+		materials.push_back(material);
+	}
+
+	if (materials.size() > 0)
+	{
+		m_pUniformBlocks->SetMaterials(materials.data(), (int)materials.size());
+	}
+}
+
+/***********************************************************
+ *  FindTextureHandle()
+ *
+ *  This method is used for resolving the tag of a loaded
+ *  texture into a handle, so the per-frame code does not
+ *  need to search through the texture tags.
+ ***********************************************************/
+SceneManager::TextureHandle SceneManager::FindTextureHandle(const std::string& tag)
+{
+	// the handle is the texture slot the texture is bound to
+	return(FindTextureSlot(tag));
+}
+
+/***********************************************************
+ *  FindMaterialHandle()
+ *
+ *  This method is used for resolving the tag of a defined
+ *  material into a handle, so the per-frame code does not
+ *  need to search through the material tags.
+ ***********************************************************/
+SceneManager::MaterialHandle SceneManager::FindMaterialHandle(const std::string& tag)
+{
+	for (unsigned int index = 0; index < m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  BuildModelMatrix()
+ *
+ *  This method is used for calculating the model matrix
+ *  from the passed in transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::BuildModelMatrix(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	return(translation * rotationZ * rotationY * rotationX * scale);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+
+	modelView = BuildModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	if (NULL != m_pShaderState)
+	{
+		m_pShaderState->setMat4Value(m_uniformIDs.model, modelView);
+	}
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using a previously calculated model matrix.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	const glm::mat4& modelMatrix)
+{
+	if (NULL != m_pShaderState)
+	{
+		m_pShaderState->setMat4Value(m_uniformIDs.model, modelMatrix);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderState)
+	{
+		UseShaderVariant(false);
+		m_pShaderState->setBoolValue(m_uniformIDs.useTexture, false);
+		m_pShaderState->setVec4Value(m_uniformIDs.objectColor, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	SetShaderTexture(FindTextureHandle(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in handle into the shader,
+ *  or turning texturing off for an invalid handle.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	TextureHandle texture)
+{
+	if ((NULL != m_pShaderState) && (texture >= 0) && (texture < (int)m_textureIDs.size()))
+	{
+		const TEXTURE_INFO& textureInfo = m_textureIDs[texture];
+		int unit = textureInfo.unit;
+
+		// texture arrays without a slot of their own are
+		// bound to the shared slot when they are needed
+		if ((unit < 0) || (unit >= m_overflowUnit))
+		{
+			unit = m_overflowUnit;
+			if (m_overflowTexture != textureInfo.ID)
+			{
+				glActiveTexture(GL_TEXTURE0 + unit);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, textureInfo.ID);
+				m_overflowTexture = textureInfo.ID;
+			}
+		}
+
+		UseShaderVariant(true);
+		m_pShaderState->setBoolValue(m_uniformIDs.useTexture, true);
+		m_pShaderState->setSampler2DValue(m_uniformIDs.objectTexture, unit);
+		m_pShaderState->setIntValue(m_uniformIDs.textureLayer, textureInfo.layer);
+	}
+	else if (NULL != m_pShaderState)
+	{
+		// an object without a texture is drawn with its color, and
+		// not with the texture of the object drawn before it
+		UseShaderVariant(false);
+		m_pShaderState->setBoolValue(m_uniformIDs.useTexture, false);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderState)
+	{
+		m_pShaderState->setVec2Value(m_uniformIDs.UVscale, glm::vec2(u, v));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  associated with the passed in tag into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	SetShaderMaterial(FindMaterialHandle(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting the material associated
+ *  with the passed in handle from the shader material table.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	MaterialHandle material)
+{
+	// the material values are already in the material table,
+	// so only the index of the material needs to be passed in
+	if ((material >= 0) && (material < (int)m_objectMaterials.size()))
+	{
+		m_pShaderState->setIntValue(m_uniformIDs.materialIndex, material);
+	}
+}
+
+/***********************************************************
+ *  AddSceneNode()
+ *
+ *  This method is used for adding an object to the retained
+ *  3D scene. The returned node ID can be used for changing
+ *  the transformation values of the node later on.
+ ***********************************************************/
+int SceneManager::AddSceneNode(
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	const std::string& textureTag,
+	const std::string& materialTag)
+{
+	SCENE_NODE node;
+
+	node.mesh = mesh;
+	node.scaleXYZ = scaleXYZ;
+	node.XrotationDegrees = XrotationDegrees;
+	node.YrotationDegrees = YrotationDegrees;
+	node.ZrotationDegrees = ZrotationDegrees;
+	node.positionXYZ = positionXYZ;
+	node.textureTag = textureTag;
+	node.materialTag = materialTag;
+	node.texture = -1;
+	node.material = -1;
+	node.shader = 0;
+	node.sortKey = 0;
+	node.nodeID = (int)m_sceneNodes.size();
+
+	m_sceneNodes.push_back(node);
+
+	return(node.nodeID);
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used for packing the draw state of a
+ *  scene node into a 64-bit sort key. The most expensive
+ *  state to change is in the highest bits, so sorting the
+ *  keys groups the draws by shader, then texture, then
+ *  material, then mesh. The lowest 16 bits are unused.
+ ***********************************************************/
+uint64_t SceneManager::MakeSortKey(
+	int shader,
+	int textureSortID,
+	MaterialHandle material,
+	MESH_TYPE mesh)
+{
+	// the handles are offset by one so that "none" (-1) sorts first
+	uint64_t sortKey = 0;
+	sortKey |= ((uint64_t)(shader & 0xFF)) << 56;
+	sortKey |= ((uint64_t)((textureSortID + 1) & 0xFFFF)) << 40;
+	sortKey |= ((uint64_t)((material + 1) & 0xFFFF)) << 24;
+	sortKey |= ((uint64_t)(mesh & 0xFF)) << 16;
+
+	return(sortKey);
+}
+
+/***********************************************************
+ *  GetTextureSortID()
+ *
+ *  This method is used for getting the texture state of a
+ *  texture handle for the sort key. Textures in the same
+ *  texture array share the upper bits, so that they are
+ *  drawn next to each other.
+ ***********************************************************/
+int SceneManager::GetTextureSortID(TextureHandle texture) const
+{
+	if ((texture < 0) || (texture >= (int)m_textureIDs.size()))
+	{
+		return(-1);
+	}
+
+	return(((m_textureIDs[texture].unit + 1) << 8) | (m_textureIDs[texture].layer & 0xFF));
+}
+
+/***********************************************************
+ *  CountStateChanges()
+ *
+ *  This method is used for counting how many of the shader,
+ *  texture, material and mesh states differ between two
+ *  consecutive sort keys.
+ ***********************************************************/
+int SceneManager::CountStateChanges(uint64_t previousKey, uint64_t sortKey)
+{
+	const int fieldShifts[4] = { 56, 40, 24, 16 };
+	const uint64_t fieldMasks[4] = { 0xFF, 0xFFFF, 0xFFFF, 0xFF };
+	int stateChanges = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (((previousKey >> fieldShifts[i]) & fieldMasks[i]) !=
+			((sortKey >> fieldShifts[i]) & fieldMasks[i]))
+		{
+			stateChanges++;
+		}
+	}
+
+	return(stateChanges);
+}
+
+/***********************************************************
+ *  CompileDrawList()
+ *
+ *  This method is used for compiling the scene nodes into
+ *  the draw list. The nodes are sorted by their packed
+ *  state key, so that objects with the same shader, texture,
+ *  material and mesh are drawn back to back, and those that
+ *  can be instanced share one batch.
+ ***********************************************************/
+void SceneManager::CompileDrawList()
+{
+	// resolve the tags once, so the draw list only holds handles
+	for (unsigned int i = 0; i < m_sceneNodes.size(); i++)
+	{
+		SCENE_NODE& node = m_sceneNodes[i];
+
+		node.texture = FindTextureHandle(node.textureTag);
+		node.material = FindMaterialHandle(node.materialTag);
+		node.sortKey = MakeSortKey(node.shader, GetTextureSortID(node.texture), node.material, node.mesh);
+	}
+
+	// count the state changes of the order the nodes were
+	// defined in, which is what the sorting is measured against
+	m_unsortedStateChanges = 0;
+	for (unsigned int i = 0; i < m_sceneNodes.size(); i++)
+	{
+		if (i == 0)
+		{
+			m_unsortedStateChanges += 4;
+		}
+		else
+		{
+			m_unsortedStateChanges += CountStateChanges(
+				m_sceneNodes[i - 1].sortKey,
+				m_sceneNodes[i].sortKey);
+		}
+	}
+
+	// the stable sort keeps the defined order of the nodes
+	// for those that share the same state
+	std::stable_sort(m_sceneNodes.begin(), m_sceneNodes.end(),
+		[](const SCENE_NODE& nodeA, const SCENE_NODE& nodeB)
+		{
+			return(nodeA.sortKey < nodeB.sortKey);
+		});
+
+	m_nodeIndexByID.assign(m_sceneNodes.size(), -1);
+	m_drawList.clear();
+	for (unsigned int i = 0; i < m_sceneNodes.size(); i++)
+	{
+		const SCENE_NODE& node = m_sceneNodes[i];
+
+		m_nodeIndexByID[node.nodeID] = i;
+
+		// start a new batch whenever the state changes, every
+		// mesh can be instanced from the shared buffers
+		bool bNewBatch = true;
+		if (m_drawList.size() > 0)
+		{
+			bNewBatch = (m_drawList.back().sortKey != node.sortKey);
+		}
+
+		if (bNewBatch)
+		{
+			DRAW_BATCH batch;
+			batch.sortKey = node.sortKey;
+			batch.mesh = node.mesh;
+			batch.texture = node.texture;
+			batch.material = node.material;
+			batch.firstNode = i;
+			batch.nodeCount = 0;
+			m_drawList.push_back(batch);
+		}
+		m_drawList.back().nodeCount++;
+	}
+
+	// every model matrix needs to be calculated once
+	m_modelMatrices.assign(m_sceneNodes.size(), glm::mat4(1.0f));
+	m_worldBounds.assign(m_sceneNodes.size(), Frustum::BOUNDING_BOX());
+	m_nodeVisible.assign(m_sceneNodes.size(), 1);
+	m_nodeLod.assign(m_sceneNodes.size(), 0);
+	m_bCullingValid = false;
+	m_transformDirty.assign(m_sceneNodes.size(), 1);
+	m_bTransformsDirty = true;
+	// with a ring buffer the frames write their own copy of the
+	// instance attributes while they change, instead of the shared
+	// instance buffers being updated in place
+	if (NULL != m_pRingBuffer)
+	{
+		m_pRingBuffer->Reserve(
+			(sizeof(glm::mat4) + sizeof(InstancedMeshes::INSTANCE_DATA)) * m_modelMatrices.size());
+	}
+	m_instancedMeshes->ReserveInstances((int)m_modelMatrices.size());
+	UpdateTransforms();
+	EncodeDrawPackets();
+	BuildIndirectCommands();
+}
+
+/***********************************************************
+ *  BuildIndirectCommands()
+ *
+ *  This method is used for writing the material index and
+ *  texture layer of every scene node into the instance
+ *  buffer, and one draw command per batch into the indirect
+ *  buffer. Consecutive batches reading from the same texture
+ *  array are drawn together with one multi-draw call.
+ ***********************************************************/
+void SceneManager::BuildIndirectCommands()
+{
+	m_instanceData.resize(m_sceneNodes.size());
+	for (unsigned int i = 0; i < m_sceneNodes.size(); i++)
+	{
+		const SCENE_NODE& node = m_sceneNodes[i];
+
+		m_instanceData[i].materialIndex = (node.material >= 0) ? node.material : 0;
+		m_instanceData[i].textureLayer = 0;
+		if ((node.texture >= 0) && (node.texture < (int)m_textureIDs.size()))
+		{
+			m_instanceData[i].textureLayer = m_textureIDs[node.texture].layer;
+		}
+	}
+	if ((NULL == m_pRingBuffer) && (m_instanceData.size() > 0))
+	{
+		m_instancedMeshes->SetInstanceData(0, (int)m_instanceData.size(), m_instanceData.data());
+	}
+	m_bInstancesChanged = true;
+
+	m_indirectBatches.clear();
+	for (unsigned int i = 0; i < m_drawList.size(); i++)
+	{
+		const DRAW_BATCH& batch = m_drawList[i];
+
+		// the sampler cannot change inside of a multi-draw call,
+		// so a new one is needed whenever the texture array does
+		bool bNewBatch = true;
+		if (m_indirectBatches.size() > 0)
+		{
+			const INDIRECT_BATCH& last = m_indirectBatches.back();
+			bNewBatch = (last.texture < 0) || (batch.texture < 0) ||
+				(m_textureIDs[last.texture].ID != m_textureIDs[batch.texture].ID);
+		}
+
+		if (bNewBatch)
+		{
+			INDIRECT_BATCH indirectBatch;
+			indirectBatch.texture = batch.texture;
+			indirectBatch.firstBatch = i;
+			indirectBatch.batchCount = 0;
+			indirectBatch.firstCommand = 0;
+			indirectBatch.commandCount = 0;
+			indirectBatch.triangleCount = 0;
+			m_indirectBatches.push_back(indirectBatch);
+		}
+		m_indirectBatches.back().batchCount++;
+	}
+
+	// the compute shader culls the same batches on the GPU, with
+	// a command for each of their levels of detail - the surviving
+	// instances of each level are packed into a range of their own
+	if (m_pGpuCulling->IsReady())
+	{
+		std::vector<GpuCulling::CULL_BATCH> cullBatches(m_drawList.size() * MESH_LOD_LEVELS);
+		std::vector<GLuint> instanceBatches(m_sceneNodes.size(), 0);
+		for (unsigned int i = 0; i < m_drawList.size(); i++)
+		{
+			const DRAW_BATCH& batch = m_drawList[i];
+
+			for (int lod = 0; lod < MESH_LOD_LEVELS; lod++)
+			{
+				GpuCulling::CULL_BATCH& cullBatch = cullBatches[(i * MESH_LOD_LEVELS) + lod];
+				InstancedMeshes::DRAW_COMMAND command = m_instancedMeshes->MakeDrawCommand(
+					m_instancedMeshIDs[batch.mesh][lod],
+					(batch.firstNode * MESH_LOD_LEVELS) + (lod * batch.nodeCount),
+					batch.nodeCount);
+
+				cullBatch = GpuCulling::CULL_BATCH();
+				cullBatch.count = command.count;
+				cullBatch.firstIndex = command.firstIndex;
+				cullBatch.baseVertex = command.baseVertex;
+				cullBatch.firstInstance = command.baseInstance;
+				cullBatch.instanceCount = command.instanceCount;
+				cullBatch.lodCount = m_meshLodCount[batch.mesh];
+				cullBatch.boundsMin = glm::vec4(m_meshBounds[batch.mesh].minimum, 1.0f);
+				cullBatch.boundsMax = glm::vec4(m_meshBounds[batch.mesh].maximum, 1.0f);
+			}
+
+			for (int j = batch.firstNode; j < batch.firstNode + batch.nodeCount; j++)
+			{
+				instanceBatches[j] = i;
+			}
+		}
+		m_pGpuCulling->SetBatches(cullBatches, instanceBatches);
+	}
+
+	WriteIndirectCommands();
+}
+
+/***********************************************************
+ *  WriteIndirectCommands()
+ *
+ *  This method is used for writing the draw commands of the
+ *  visible objects into the indirect buffer. The objects of a
+ *  batch are next to each other in the instance buffers, so
+ *  every unbroken run of visible objects with the same level
+ *  of detail becomes a command. When culling on the GPU,
+ *  every level of every batch gets one command for the
+ *  compute shader to fill in the instance count of.
+ ***********************************************************/
+void SceneManager::WriteIndirectCommands()
+{
+	// the commands only live until they are uploaded, so they are
+	// written into the frame arena - every batch has at most one
+	// command per level, plus one for the shadow pass
+	int maxCommands = (int)m_drawList.size() * (MESH_LOD_LEVELS + 1);
+	InstancedMeshes::DRAW_COMMAND* pCommands = m_pFrameArena->Allocate<InstancedMeshes::DRAW_COMMAND>(maxCommands);
+	int commandCount = 0;
+
+	m_bIndirectForGpu = IsGpuCullingActive();
+	if (m_bIndirectForGpu)
+	{
+		for (unsigned int i = 0; i < m_indirectBatches.size(); i++)
+		{
+			m_indirectBatches[i].firstCommand = m_indirectBatches[i].firstBatch * MESH_LOD_LEVELS;
+			m_indirectBatches[i].commandCount = m_indirectBatches[i].batchCount * MESH_LOD_LEVELS;
+
+			// the drawn triangles are only known on the GPU, so every
+			// object is counted at the finest level of detail, which
+			// is the most the commands can draw
+			m_indirectBatches[i].triangleCount = 0;
+			for (int j = m_indirectBatches[i].firstBatch; j < m_indirectBatches[i].firstBatch + m_indirectBatches[i].batchCount; j++)
+			{
+				const DRAW_BATCH& batch = m_drawList[j];
+				m_indirectBatches[i].triangleCount +=
+					(m_instancedMeshes->GetIndexCount(m_instancedMeshIDs[batch.mesh][0]) / 3) * batch.nodeCount;
+			}
+		}
+		// the commands are filled in by every dispatch, until then
+		// they draw nothing
+		commandCount = (int)m_drawList.size() * MESH_LOD_LEVELS;
+		memset(pCommands, 0, sizeof(InstancedMeshes::DRAW_COMMAND) * commandCount);
+		AppendShadowCommands(pCommands, commandCount);
+		m_instancedMeshes->SetDrawCommands(pCommands, commandCount);
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_indirectBatches.size(); i++)
+	{
+		INDIRECT_BATCH& indirectBatch = m_indirectBatches[i];
+		indirectBatch.firstCommand = commandCount;
+		indirectBatch.triangleCount = 0;
+
+		for (int j = indirectBatch.firstBatch; j < indirectBatch.firstBatch + indirectBatch.batchCount; j++)
+		{
+			const std::vector<DRAW_PACKET>& packets = m_batchPackets[j];
+			for (unsigned int k = 0; k < packets.size(); k++)
+			{
+				const DRAW_PACKET& packet = packets[k];
+				InstancedMeshes::DRAW_COMMAND& command = pCommands[commandCount++];
+				command = m_instancedMeshes->MakeDrawCommand(
+					packet.meshID,
+					packet.firstNode,
+					packet.nodeCount);
+				indirectBatch.triangleCount += (command.count / 3) * packet.nodeCount;
+			}
+		}
+
+		indirectBatch.commandCount = commandCount - indirectBatch.firstCommand;
+	}
+
+	AppendShadowCommands(pCommands, commandCount);
+	m_instancedMeshes->SetDrawCommands(pCommands, commandCount);
+}
+
+/***********************************************************
+ *  AppendShadowCommands()
+ *
+ *  This method is used for adding a command per batch of
+ *  the draw list after the commands of the main pass, which
+ *  draws every object of the batch at the finest level of
+ *  detail. Objects outside of the camera view still cast
+ *  shadows into it, so these commands are never culled, and
+ *  the whole shadow pass takes one multi-draw call for each
+ *  cascade.
+ ***********************************************************/
+void SceneManager::AppendShadowCommands(InstancedMeshes::DRAW_COMMAND* pCommands, int& commandCount)
+{
+	m_shadowFirstCommand = commandCount;
+	for (unsigned int i = 0; i < m_drawList.size(); i++)
+	{
+		const DRAW_BATCH& batch = m_drawList[i];
+		pCommands[commandCount++] = m_instancedMeshes->MakeDrawCommand(
+			m_instancedMeshIDs[batch.mesh][0],
+			batch.firstNode,
+			batch.nodeCount);
+	}
+	m_shadowCommandCount = (int)m_drawList.size();
+}
+
+/***********************************************************
+ *  CullSceneNodes()
+ *
+ *  This method is used for testing the world space bounds of
+ *  every scene node against the view frustum of the camera
+ *  that was last set up by the view manager, and picking
+ *  the level of detail of the visible ones from their size
+ *  on the screen. This is only repeated when the camera or
+ *  an object has moved.
+ ***********************************************************/
+void SceneManager::CullSceneNodes()
+{
+	const UniformBlocks::CAMERA_BLOCK& camera = m_pUniformBlocks->GetCamera();
+	glm::mat4 viewProjection = camera.projection * camera.view;
+
+	// the visible count of the GPU pass lags a frame behind
+	if (IsGpuCullingActive())
+	{
+		m_visibleCount = m_pGpuCulling->GetVisibleCount();
+	}
+
+	if ((m_bCullingValid == true) && (viewProjection == m_cullViewProjection))
+	{
+		return;
+	}
+
+	Frustum frustum;
+	frustum.ExtractPlanes(viewProjection);
+
+	if (IsGpuCullingActive())
+	{
+		if (m_bIndirectForGpu == false)
+		{
+			WriteIndirectCommands();
+		}
+
+		// without culling every instance is inside of the planes
+		if (m_bFrustumCulling == false)
+		{
+			frustum = Frustum();
+		}
+		m_pGpuCulling->Dispatch(
+			frustum,
+			viewProjection,
+			camera.projection[1][1],
+			m_instancedMeshes->GetInstanceBuffer(),
+			m_instancedMeshes->GetInstanceOffset(),
+			m_instancedMeshes->GetInstanceDataBuffer(),
+			m_instancedMeshes->GetInstanceDataOffset(),
+			m_instancedMeshes->GetIndirectBuffer());
+
+		m_cullViewProjection = viewProjection;
+		m_bCullingValid = true;
+		return;
+	}
+
+	// the nodes are tested in chunks on the worker threads, which
+	// each count the visible nodes at every level of their chunk
+	int nodeCount = (int)m_worldBounds.size();
+	int chunkCount = ThreadPool::GetChunkCount(nodeCount, g_NodesPerJob);
+	int* pChunkCounts = m_pFrameArena->Allocate<int>(chunkCount * (MESH_LOD_LEVELS + 1), 0);
+	m_pThreadPool->ParallelFor(nodeCount, g_NodesPerJob,
+		[this, &frustum, &viewProjection, &camera, pChunkCounts](int chunk, int first, int last)
+		{
+			int* pCounts = &pChunkCounts[chunk * (MESH_LOD_LEVELS + 1)];
+			for (int i = first; i < last; i++)
+			{
+				const Frustum::BOUNDING_BOX& box = m_worldBounds[i];
+
+				bool bVisible = true;
+				if (m_bFrustumCulling == true)
+				{
+					bVisible = frustum.IsBoxVisible(box);
+				}
+
+				m_nodeVisible[i] = bVisible ? 1 : 0;
+				if (bVisible == false)
+				{
+					continue;
+				}
+				pCounts[MESH_LOD_LEVELS]++;
+
+				// the projected size is the radius of the box over its
+				// distance, in half heights of the viewport - the meshes
+				// drawn through ShapeMeshes only have the one level
+				int lodCount = m_meshLodCount[m_sceneNodes[i].mesh];
+				if (m_submitMode == SUBMIT_NAIVE)
+				{
+					lodCount = 1;
+				}
+
+				glm::vec3 center = (box.minimum + box.maximum) * 0.5f;
+				float radius = glm::length(box.maximum - box.minimum) * 0.5f;
+				float clipW = (viewProjection * glm::vec4(center, 1.0f)).w;
+				float projectedSize = (radius * camera.projection[1][1]) / std::max(clipW, 0.0001f);
+
+				int lod = SelectLod(projectedSize, m_nodeLod[i], lodCount);
+				m_nodeLod[i] = (unsigned char)lod;
+				pCounts[lod]++;
+			}
+		});
+
+	m_visibleCount = 0;
+	memset(m_lodCounts, 0, sizeof(m_lodCounts));
+	for (int chunk = 0; chunk < chunkCount; chunk++)
+	{
+		const int* pCounts = &pChunkCounts[chunk * (MESH_LOD_LEVELS + 1)];
+		for (int lod = 0; lod < MESH_LOD_LEVELS; lod++)
+		{
+			m_lodCounts[lod] += pCounts[lod];
+		}
+		m_visibleCount += pCounts[MESH_LOD_LEVELS];
+	}
+
+	EncodeDrawPackets();
+
+	if (m_submitMode == SUBMIT_INDIRECT)
+	{
+		WriteIndirectCommands();
+	}
+
+	m_cullViewProjection = viewProjection;
+	m_bCullingValid = true;
+}
+
+/***********************************************************
+ *  SelectLod()
+ *
+ *  This method is used for picking the level of detail for
+ *  a projected size. The search starts from the level the
+ *  object was drawn with last, and only moves to another
+ *  level once the size is past its threshold by the
+ *  hysteresis fraction, so that objects sitting close to a
+ *  threshold do not flicker between two levels. The same
+ *  selection is made by the culling compute shader.
+ ***********************************************************/
+int SceneManager::SelectLod(float projectedSize, int lod, int lodCount)
+{
+	const float thresholds[MESH_LOD_LEVELS - 1] = { g_LodFineThreshold, g_LodCoarseThreshold };
+
+	lod = std::min(lod, lodCount - 1);
+	while ((lod > 0) && (projectedSize > thresholds[lod - 1] * (1.0f + g_LodHysteresis)))
+	{
+		lod--;
+	}
+	while ((lod + 1 < lodCount) && (projectedSize < thresholds[lod] * (1.0f - g_LodHysteresis)))
+	{
+		lod++;
+	}
+
+	return(lod);
+}
+
+/***********************************************************
+ *  FindDrawRun()
+ *
+ *  This method is used for finding the next unbroken run of
+ *  visible objects in a batch that are drawn with the same
+ *  level of detail, starting at the passed in node. Runs
+ *  can be drawn with one instanced draw or indirect command
+ *  since their instances are next to each other. The node
+ *  is moved past the run, and false is returned once the
+ *  end of the batch is reached.
+ ***********************************************************/
+bool SceneManager::FindDrawRun(
+	const DRAW_BATCH& batch,
+	int& node,
+	int& firstNode,
+	int& nodeCount,
+	int& lod) const
+{
+	int lastNode = batch.firstNode + batch.nodeCount;
+
+	while ((node < lastNode) && (m_nodeVisible[node] == 0))
+	{
+		node++;
+	}
+	if (node >= lastNode)
+	{
+		return(false);
+	}
+
+	firstNode = node;
+	lod = m_nodeLod[node];
+	while ((node < lastNode) && (m_nodeVisible[node] != 0) && (m_nodeLod[node] == lod))
+	{
+		node++;
+	}
+	nodeCount = node - firstNode;
+
+	return(true);
+}
+
+/***********************************************************
+ *  EncodeDrawPackets()
+ *
+ *  This method is used for encoding the draw packets of
+ *  every batch of the draw list from the last culling - one
+ *  packet per run of visible objects at the same level of
+ *  detail. The batches are split into chunks for the worker
+ *  threads, each writing the packets of its own batches, so
+ *  the packet stream is in draw list order with no merging
+ *  left for the GL thread, which only replays it.
+ ***********************************************************/
+void SceneManager::EncodeDrawPackets()
+{
+	m_batchPackets.resize(m_drawList.size());
+	m_pThreadPool->ParallelFor((int)m_drawList.size(), g_BatchesPerJob,
+		[this](int /*chunk*/, int first, int last)
+		{
+			for (int i = first; i < last; i++)
+			{
+				const DRAW_BATCH& batch = m_drawList[i];
+				std::vector<DRAW_PACKET>& packets = m_batchPackets[i];
+				packets.clear();
+
+				int node = batch.firstNode;
+				DRAW_PACKET packet;
+				int lod = 0;
+				while (FindDrawRun(batch, node, packet.firstNode, packet.nodeCount, lod))
+				{
+					packet.meshID = m_instancedMeshIDs[batch.mesh][lod];
+					packets.push_back(packet);
+				}
+			}
+		});
+}
+
+/***********************************************************
+ *  IsGpuCullingActive()
+ *
+ *  This method is used for checking whether the culling of
+ *  the indirect draws is done by the compute shader pass.
+ ***********************************************************/
+bool SceneManager::IsGpuCullingActive() const
+{
+	return((m_bGpuCulling == true) &&
+		(m_submitMode == SUBMIT_INDIRECT) &&
+		(m_pGpuCulling->IsReady() == true));
+}
+
+/***********************************************************
+ *  IsRedrawNeeded()
+ *
+ *  This method is used for checking whether rendering the
+ *  next frame would change anything on the scene side, for
+ *  when frames are only rendered on demand. Changes of the
+ *  camera are tracked by the view manager.
+ ***********************************************************/
+bool SceneManager::IsRedrawNeeded() const
+{
+	return((m_bTexturesPacked == false) ||
+		(m_bTransformsDirty == true) ||
+		(m_bCullingValid == false));
+}
+
+/***********************************************************
+ *  SetGpuCulling()
+ *
+ *  This method is used for choosing whether the indirect
+ *  draws are culled by the compute shader pass, when it
+ *  could be loaded, instead of on the CPU.
+ ***********************************************************/
+void SceneManager::SetGpuCulling(bool bGpuCulling)
+{
+	m_bGpuCulling = bGpuCulling;
+	m_bCullingValid = false;
+	m_bIndirectForGpu = false;
+	// the per-node visibility is not kept by the GPU pass
+	m_nodeVisible.assign(m_nodeVisible.size(), 1);
+}
+
+/***********************************************************
+ *  SetFrustumCulling()
+ *
+ *  This method is used for choosing whether the objects
+ *  outside of the view frustum are skipped when drawing.
+ ***********************************************************/
+void SceneManager::SetFrustumCulling(bool bFrustumCulling)
+{
+	m_bFrustumCulling = bFrustumCulling;
+	m_bCullingValid = false;
+}
+
+/***********************************************************
+ *  SetSubmitMode()
+ *
+ *  This method is used for choosing how the draw list is
+ *  submitted to OpenGL. The indirect mode falls back to
+ *  the instanced mode when multi-draw indirect is missing.
+ ***********************************************************/
+void SceneManager::SetSubmitMode(SUBMIT_MODE submitMode)
+{
+	if ((submitMode == SUBMIT_INDIRECT) && (InstancedMeshes::IsIndirectSupported() == false))
+	{
+		std::cout << "Multi-draw indirect is not supported, using instanced draws" << std::endl;
+		submitMode = SUBMIT_INSTANCED;
+	}
+
+	// the basic meshes are only needed by the naive path
+	if ((submitMode == SUBMIT_NAIVE) && (m_bBasicMeshesLoaded == false))
+	{
+		m_basicMeshes->LoadPlaneMesh();
+		m_basicMeshes->LoadPrismMesh();
+		m_basicMeshes->LoadBoxMesh();
+		m_basicMeshes->LoadCylinderMesh();
+		m_basicMeshes->LoadConeMesh();
+		m_basicMeshes->LoadTorusMesh();
+		m_basicMeshes->LoadBoxMesh2();
+		m_bBasicMeshesLoaded = true;
+	}
+
+	m_submitMode = submitMode;
+	m_bCullingValid = false;
+	m_bIndirectForGpu = false;
+}
+
+/***********************************************************
+ *  UpdateTransforms()
+ *
+ *  This method is used for recalculating the model matrices
+ *  of the scene nodes whose transformation values changed
+ *  since the last frame. When nothing moved, no matrix math
+ *  is done at all.
+ ***********************************************************/
+void SceneManager::UpdateTransforms()
+{
+	if (m_bTransformsDirty == false)
+	{
+		return;
+	}
+
+	// the matrices are built on the worker threads, each chunk of
+	// nodes finding the range of its own changed nodes
+	int nodeCount = (int)m_sceneNodes.size();
+	int chunkCount = ThreadPool::GetChunkCount(nodeCount, g_NodesPerJob);
+	int* chunkFirstDirty = m_pFrameArena->Allocate<int>(chunkCount, -1);
+	int* chunkLastDirty = m_pFrameArena->Allocate<int>(chunkCount, -1);
+	m_pThreadPool->ParallelFor(nodeCount, g_NodesPerJob,
+		[this, chunkFirstDirty, chunkLastDirty](int chunk, int first, int last)
+		{
+			for (int i = first; i < last; i++)
+			{
+				if (m_transformDirty[i] == 0)
+				{
+					continue;
+				}
+
+				const SCENE_NODE& node = m_sceneNodes[i];
+				m_modelMatrices[i] = BuildModelMatrix(
+					node.scaleXYZ,
+					node.XrotationDegrees,
+					node.YrotationDegrees,
+					node.ZrotationDegrees,
+					node.positionXYZ);
+				m_worldBounds[i] = Frustum::TransformBox(m_meshBounds[node.mesh], m_modelMatrices[i]);
+				m_transformDirty[i] = 0;
+
+				if (chunkFirstDirty[chunk] < 0)
+				{
+					chunkFirstDirty[chunk] = i;
+				}
+				chunkLastDirty[chunk] = i;
+			}
+		});
+
+	int firstDirty = -1;
+	int lastDirty = -1;
+	for (int chunk = 0; chunk < chunkCount; chunk++)
+	{
+		if (chunkFirstDirty[chunk] < 0)
+		{
+			continue;
+		}
+		if (firstDirty < 0)
+		{
+			firstDirty = chunkFirstDirty[chunk];
+		}
+		lastDirty = chunkLastDirty[chunk];
+	}
+
+	// the instance buffer mirrors the cached model matrices,
+	// so only the changed range needs to be copied into it, a
+	// ring buffer gets all of them while they change instead
+	if (firstDirty >= 0)
+	{
+		m_bInstancesChanged = true;
+		if (NULL == m_pRingBuffer)
+		{
+			m_instancedMeshes->SetInstanceMatrices(
+				firstDirty,
+				(lastDirty - firstDirty) + 1,
+				&m_modelMatrices[firstDirty]);
+		}
+
+		// the moved objects need to be tested again, and their
+		// shadows rendered again
+		m_bCullingValid = false;
+		m_bShadowsValid = false;
+	}
+
+	m_bTransformsDirty = false;
+}
+
+/***********************************************************
+ *  WriteFrameInstances()
+ *
+ *  This method is used for copying the cached model matrix
+ *  and the draw values of every scene node into the ring
+ *  buffer region of this frame, and pointing the instance
+ *  attributes and the culling pass at the copy. The region
+ *  is not written again until the GPU is done with this
+ *  frame, so nothing waits on the draws that read the last
+ *  one. The copy is only made while the instances change:
+ *  once they stayed the same for a frame, and no frame in
+ *  flight reads the shared instance buffers any more, they
+ *  are written into those once and drawn from there, until
+ *  the next change.
+ ***********************************************************/
+void SceneManager::WriteFrameInstances()
+{
+	if ((NULL == m_pRingBuffer) || (m_modelMatrices.size() == 0))
+	{
+		return;
+	}
+
+	bool bChanged = m_bInstancesChanged;
+	m_bInstancesChanged = false;
+	if (bChanged == true)
+	{
+		m_bSharedInstancesCurrent = false;
+	}
+	if (m_bSharedInstancesCurrent == true)
+	{
+		return;
+	}
+
+	// a region that is out of room also falls back to the shared
+	// instance buffers, even if that waits on the GPU
+	RingBuffer::ALLOCATION matrices;
+	RingBuffer::ALLOCATION instanceData;
+	if (((bChanged == false) && (m_ringInstanceFrames >= RingBuffer::FRAME_REGIONS)) ||
+		(m_pRingBuffer->Allocate(sizeof(glm::mat4) * m_modelMatrices.size(), matrices) == false) ||
+		(m_pRingBuffer->Allocate(sizeof(InstancedMeshes::INSTANCE_DATA) * m_instanceData.size(), instanceData) == false))
+	{
+		m_instancedMeshes->SetInstanceMatrices(0, (int)m_modelMatrices.size(), m_modelMatrices.data());
+		m_instancedMeshes->SetInstanceData(0, (int)m_instanceData.size(), m_instanceData.data());
+		m_instancedMeshes->SetInstanceSource(0, 0, 0);
+		m_bSharedInstancesCurrent = true;
+		m_ringInstanceFrames = 0;
+		return;
+	}
+
+	memcpy(matrices.pData, m_modelMatrices.data(), matrices.size);
+	memcpy(instanceData.pData, m_instanceData.data(), instanceData.size);
+	m_pRingBuffer->Commit();
+
+	m_instancedMeshes->SetInstanceSource(
+		m_pRingBuffer->GetBuffer(),
+		matrices.offset,
+		instanceData.offset);
+	m_ringInstanceFrames++;
+}
+
+/***********************************************************
+ *  UpdateLightClusters()
+ *
+ *  This method is used for sorting the point lights into
+ *  the clusters of the camera that was last set up by the
+ *  view manager, and setting the values the shader needs
+ *  to find the cluster of each fragment.
+ ***********************************************************/
+void SceneManager::UpdateLightClusters()
+{
+	const UniformBlocks::CAMERA_BLOCK& camera = m_pUniformBlocks->GetCamera();
+
+	GLint viewport[4] = { 0, 0, 1, 1 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	m_pLightClusters->Update(camera.view, camera.projection, viewport[2], viewport[3]);
+
+	m_pShaderState->setVec2Value(m_uniformIDs.clusterTileSize, m_pLightClusters->GetTileSize());
+	m_pShaderState->setFloatValue(m_uniformIDs.clusterDepthScale, m_pLightClusters->GetDepthScale());
+	m_pShaderState->setFloatValue(m_uniformIDs.clusterDepthBias, m_pLightClusters->GetDepthBias());
+}
+
+/***********************************************************
+ *  LoadShaderVariants()
+ *
+ *  This method is used for compiling the shader programs
+ *  the scene is drawn with, one for untextured and one for
+ *  textured draws, with the lighting features of the scene
+ *  as constants, and the depth-only one for the shadow
+ *  pass. When the scene variants cannot be built, the
+ *  program loaded by the shader manager is kept, which
+ *  branches on the same features at runtime.
+ ***********************************************************/
+void SceneManager::LoadShaderVariants(const UniformBlocks::LIGHT_BLOCK& lights, bool bLighting)
+{
+	m_baseProgram = m_pShaderState->GetProgramID();
+	m_variantPrograms[0] = 0;
+	m_variantPrograms[1] = 0;
+	m_depthProgram = 0;
+
+	bool bSourceLoaded = m_pShaderVariants->LoadSource(g_VertexShaderFile, g_FragmentShaderFile);
+	if (bSourceLoaded == true)
+	{
+		m_pShaderVariants->SetBinaryCachePrefix(g_ShaderCachePrefix);
+
+		// the shadow pass needs the depth-only variant, whether or
+		// not the main pass uses variants
+		if (m_pShadowCascades->IsReady())
+		{
+			m_depthProgram = m_pShaderVariants->GetProgram(
+				MakeVariantDefines(lights, bLighting, false) + "#define DEPTH_ONLY 1\n");
+		}
+	}
+	m_pShaderState->setBoolValue("bUseShadows", m_depthProgram != 0);
+
+	if ((m_bShaderVariants == false) || (bSourceLoaded == false))
+	{
+		return;
+	}
+
+	m_variantPrograms[0] = m_pShaderVariants->GetProgram(MakeVariantDefines(lights, bLighting, false));
+	m_variantPrograms[1] = m_pShaderVariants->GetProgram(MakeVariantDefines(lights, bLighting, true));
+
+	// both variants are needed, or the runtime branches are used
+	if ((m_variantPrograms[0] == 0) || (m_variantPrograms[1] == 0))
+	{
+		m_variantPrograms[0] = 0;
+		m_variantPrograms[1] = 0;
+		return;
+	}
+
+	std::cout << "INFO: Shader variants ready, " << m_pShaderVariants->GetCompiledCount()
+		<< " compiled and " << m_pShaderVariants->GetCachedCount() << " loaded from the cache" << std::endl;
+}
+
+/***********************************************************
+ *  MakeVariantDefines()
+ *
+ *  This method is used for writing the block of defines
+ *  that turns the lighting features of the scene into
+ *  constants of a shader variant.
+ ***********************************************************/
+std::string SceneManager::MakeVariantDefines(
+	const UniformBlocks::LIGHT_BLOCK& lights,
+	bool bLighting,
+	bool bTextured) const
+{
+	// the variants loop over the active point lights only, which
+	// fill the first slots of the light block
+	int pointLightCount = 0;
+	while ((pointLightCount < TOTAL_POINT_LIGHTS) && lights.pointLights[pointLightCount].bActive)
+	{
+		pointLightCount++;
+	}
+
+	std::ostringstream defines;
+	defines << "#define SHADER_VARIANT 1\n"
+		<< "#define VARIANT_LIGHTING " << (bLighting ? 1 : 0) << "\n"
+		<< "#define VARIANT_TEXTURE " << (bTextured ? 1 : 0) << "\n"
+		<< "#define VARIANT_CLUSTERED_LIGHTING " << ((m_lightingPath == LIGHTING_CLUSTERED) ? 1 : 0) << "\n"
+		<< "#define VARIANT_SHADOWS " << ((m_depthProgram != 0) ? 1 : 0) << "\n"
+		<< "#define VARIANT_DIRECTIONAL_LIGHT " << (lights.directionalLight.bActive ? 1 : 0) << "\n"
+		<< "#define VARIANT_SPOT_LIGHT " << (lights.spotLight.bActive ? 1 : 0) << "\n"
+		<< "#define VARIANT_POINT_LIGHTS " << pointLightCount << "\n";
+
+	return(defines.str());
+}
+
+/***********************************************************
+ *  UseShaderVariant()
+ *
+ *  This method is used for switching to the shader variant
+ *  for the next draws. The shader state cache brings the
+ *  uniform values of the variant up to date.
+ ***********************************************************/
+void SceneManager::UseShaderVariant(bool bTextured)
+{
+	GLuint programID = m_variantPrograms[bTextured ? 1 : 0];
+	if (programID != 0)
+	{
+		m_pShaderState->UseProgram(programID);
+	}
+}
+
+/***********************************************************
+ *  RenderShadowMaps()
+ *
+ *  This method is used for rendering the depth of the scene
+ *  from the directional light into every shadow cascade,
+ *  with the depth-only program. The cascades are only
+ *  rendered again when the camera or an object has moved.
+ ***********************************************************/
+void SceneManager::RenderShadowMaps()
+{
+	if ((m_depthProgram == 0) || (m_pShadowCascades->IsReady() == false))
+	{
+		return;
+	}
+
+	const UniformBlocks::CAMERA_BLOCK& camera = m_pUniformBlocks->GetCamera();
+	bool bFitted = m_pShadowCascades->Update(camera.view, camera.projection, m_shadowLightDirection);
+	if ((bFitted == false) && (m_bShadowsValid == true))
+	{
+		return;
+	}
+
+	m_pShaderState->UseProgram(m_depthProgram);
+	m_pShaderState->setBoolValue(m_uniformIDs.useInstancing, true);
+
+	// push the depth away from the light a little, against
+	// surfaces shadowing themselves
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		m_pShadowCascades->BeginCascade(i);
+		m_pShaderState->setMat4Value(m_uniformIDs.lightViewProjection, m_pShadowCascades->GetLightViewProjection(i));
+		DrawShadowCasters();
+	}
+	m_pShadowCascades->EndCascades();
+	glDisable(GL_POLYGON_OFFSET_FILL);
+
+	// the main pass finds the cascade of each fragment from these
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		m_pShaderState->setMat4Value(m_uniformIDs.shadowMatrices[i], m_pShadowCascades->GetShadowMatrix(i));
+	}
+	m_pShaderState->setVec4Value(m_uniformIDs.shadowSplitDepths, m_pShadowCascades->GetSplitDepths());
+
+	// go back to a program of the main pass
+	m_pShaderState->UseProgram((m_variantPrograms[1] != 0) ? m_variantPrograms[1] : m_baseProgram);
+
+	m_bShadowsValid = true;
+}
+
+/***********************************************************
+ *  DrawShadowCasters()
+ *
+ *  This method is used for drawing every object of the
+ *  draw list into the bound shadow cascade, visible or not.
+ *  With multi-draw indirect it is a single call reading the
+ *  shadow commands, otherwise one instanced call per batch.
+ ***********************************************************/
+void SceneManager::DrawShadowCasters()
+{
+	if (m_submitMode == SUBMIT_INDIRECT)
+	{
+		m_instancedMeshes->DrawIndirect(m_shadowFirstCommand, m_shadowCommandCount);
+		m_drawStats.shadowDrawCalls++;
+	}
+	else
+	{
+		for (unsigned int i = 0; i < m_drawList.size(); i++)
+		{
+			const DRAW_BATCH& batch = m_drawList[i];
+			m_instancedMeshes->DrawMeshInstanced(
+				m_instancedMeshIDs[batch.mesh][0],
+				batch.firstNode,
+				batch.nodeCount);
+			m_drawStats.shadowDrawCalls++;
+		}
+	}
+
+	// every object is drawn at the finest level of detail
+	for (unsigned int i = 0; i < m_drawList.size(); i++)
+	{
+		const DRAW_BATCH& batch = m_drawList[i];
+		m_drawStats.triangles +=
+			(m_instancedMeshes->GetIndexCount(m_instancedMeshIDs[batch.mesh][0]) / 3) * batch.nodeCount;
+	}
+}
+
+/***********************************************************
+ *  SetNodeTransform()
+ *
+ *  This method is used for changing the transformation
+ *  values of a scene node. The model matrix is flagged so
+ *  it is recalculated before the next frame is drawn.
+ ***********************************************************/
+void SceneManager::SetNodeTransform(
+	int nodeID,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((nodeID < 0) || (nodeID >= (int)m_nodeIndexByID.size()))
+	{
+		return;
+	}
+
+	int index = m_nodeIndexByID[nodeID];
+	SCENE_NODE& node = m_sceneNodes[index];
+
+	node.scaleXYZ = scaleXYZ;
+	node.XrotationDegrees = XrotationDegrees;
+	node.YrotationDegrees = YrotationDegrees;
+	node.ZrotationDegrees = ZrotationDegrees;
+	node.positionXYZ = positionXYZ;
+
+	m_transformDirty[index] = 1;
+	m_bTransformsDirty = true;
+}
+
+/***********************************************************
+ *  DrawBatch()
+ *
+ *  This method is used for drawing every object of a batch
+ *  from the draw list that is inside of the view frustum,
+ *  using instanced draw calls unless every object is to be
+ *  drawn on its own.
+ ***********************************************************/
+void SceneManager::DrawBatch(const DRAW_BATCH& batch, const std::vector<DRAW_PACKET>& packets)
+{
+	if (m_submitMode != SUBMIT_NAIVE)
+	{
+		// the model matrices are read from the instance buffer,
+		// with one draw call per packet
+		m_pShaderState->setBoolValue(m_uniformIDs.useInstancing, true);
+
+		for (unsigned int i = 0; i < packets.size(); i++)
+		{
+			const DRAW_PACKET& packet = packets[i];
+			m_instancedMeshes->DrawMeshInstanced(packet.meshID, packet.firstNode, packet.nodeCount);
+			m_drawStats.drawCalls++;
+			m_drawStats.triangles +=
+				(m_instancedMeshes->GetIndexCount(packet.meshID) / 3) * packet.nodeCount;
+		}
+		return;
+	}
+
+	// the basic meshes are the finest level of the instanced ones
+	int triangleCount = m_instancedMeshes->GetIndexCount(m_instancedMeshIDs[batch.mesh][0]) / 3;
+
+	m_pShaderState->setBoolValue(m_uniformIDs.useInstancing, false);
+	for (unsigned int j = 0; j < packets.size(); j++)
+	{
+		const DRAW_PACKET& packet = packets[j];
+		for (int i = packet.firstNode; i < packet.firstNode + packet.nodeCount; i++)
+		{
+			SetTransformations(m_modelMatrices[i]);
+
+			switch (batch.mesh)
+			{
+			case MESH_PLANE:
+				m_basicMeshes->DrawPlaneMesh();
+				break;
+			case MESH_PRISM:
+				m_basicMeshes->DrawPrismMesh();
+				break;
+			case MESH_BOX:
+				m_basicMeshes->DrawBoxMesh();
+				break;
+			case MESH_BOX2:
+				m_basicMeshes->DrawBoxMesh2();
+				break;
+			case MESH_CYLINDER:
+				m_basicMeshes->DrawCylinderMesh();
+				break;
+			case MESH_CONE:
+				m_basicMeshes->DrawConeMesh();
+				break;
+			case MESH_TORUS:
+				m_basicMeshes->DrawTorusMesh();
+				break;
+			default:
+				break;
+			}
+			m_drawStats.drawCalls++;
+			m_drawStats.triangles += triangleCount;
+		}
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+/***********************************************************
+  *  DefineObjectMaterials()
+  *
+  *  This method is used for configuring the various material
+  *  settings for all of the objects within the 3D scene.
+  ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	/*** STUDENTS - add the code BELOW for defining object materials. ***/
+	/*** There is no limit to the number of object materials that can ***/
+	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
+
+	OBJECT_MATERIAL carbonMaterial;
+	carbonMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.01f);
+	carbonMaterial.ambientStrength = 0.4f;
+	carbonMaterial.diffuseColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	carbonMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	carbonMaterial.shininess = 5.0f;
+	carbonMaterial.tag = "carbon";
+	m_objectMaterials.push_back(carbonMaterial);
+
+	OBJECT_MATERIAL plasticMaterial;
+	plasticMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	plasticMaterial.ambientStrength = 0.3f;
+	plasticMaterial.diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	plasticMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	plasticMaterial.shininess = 25.0f;
+	plasticMaterial.tag = "plastic";
+	m_objectMaterials.push_back(plasticMaterial);
+
+	OBJECT_MATERIAL fabricMaterial;
+	fabricMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.01f);
+	fabricMaterial.ambientStrength = 0.1f;
+	fabricMaterial.diffuseColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	fabricMaterial.specularColor = glm::vec3(0.01f, 0.01f, 0.01f);
+	fabricMaterial.shininess = 5.0f;
+	fabricMaterial.tag = "fabric";
+	m_objectMaterials.push_back(fabricMaterial);
+
+	OBJECT_MATERIAL noteMaterial;
+	noteMaterial.ambientColor = glm::vec3(0.01f, 0.01f, 0.2f);
+	noteMaterial.ambientStrength = 0.4f;
+	noteMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	noteMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	noteMaterial.shininess = 100.0f;
+	noteMaterial.tag = "note";
+	m_objectMaterials.push_back(noteMaterial);
+
+	OBJECT_MATERIAL woodMaterial;
+	woodMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.05f);
+	woodMaterial.ambientStrength = 0.1f;
+	woodMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.15f);
+	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.05f);
+	woodMaterial.shininess = 50.0f;
+	woodMaterial.tag = "wood";
+	m_objectMaterials.push_back(woodMaterial);
+
+	OBJECT_MATERIAL pencilMaterial;
+	pencilMaterial.ambientColor = glm::vec3(0.3f, 0.3f, 0.0f);
+	pencilMaterial.ambientStrength = 0.4f;
+	pencilMaterial.diffuseColor = glm::vec3(0.7f, 0.7f, 0.0f);
+	pencilMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.0f);
+	pencilMaterial.shininess = 10.0f;
+	pencilMaterial.tag = "pencil";
+	m_objectMaterials.push_back(pencilMaterial);
+
+	OBJECT_MATERIAL metalMaterial;
+	metalMaterial.ambientColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	metalMaterial.ambientStrength = 0.4f;
+	metalMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	metalMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.9f);
+	metalMaterial.shininess = 100.0f;
+	metalMaterial.tag = "metal";
+	m_objectMaterials.push_back(metalMaterial);
+
+	OBJECT_MATERIAL rubberMaterial;
+	rubberMaterial.ambientColor = glm::vec3(0.5f, 0.37f, 0.4f);
+	rubberMaterial.ambientStrength = 0.9f;
+	rubberMaterial.diffuseColor = glm::vec3(0.5f, 0.37f, 0.4f);
+	rubberMaterial.specularColor = glm::vec3(0.01f, 0.007f, 0.008f);
+	rubberMaterial.shininess = 10.0f;
+	rubberMaterial.tag = "rubber";
+	m_objectMaterials.push_back(rubberMaterial);
+
+}
+
+/***********************************************************
+* LoadSceneTextures()
+*
+* This method is used for preparing the 3D scene by loading
+* the shapes, textures in memory to support the 3D scene
+* rendering
+***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	// the images are decoded in parallel on the worker threads,
+	// the scene is drawn with placeholders until they are ready
+	for (unsigned int i = 0; i < m_textureFiles.size(); i++)
+	{
+		CreateGLTextureAsync(m_textureFiles[i].filename.c_str(), m_textureFiles[i].tag);
+	}
+
+	BindGLTextures();
+
+}
+
+/***********************************************************
+ *  DefineSceneTextures()
+ *
+ *  This method is used for defining the image files of the
+ *  textures of the desk scene, and the tags the scene nodes
+ *  refer to them by.
+ ***********************************************************/
+void SceneManager::DefineSceneTextures()
+{
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		TEXTURE_FILE textureFile;
+		textureFile.filename = g_SceneTextures[i].filename;
+		textureFile.tag = g_SceneTextures[i].tag;
+		m_textureFiles.push_back(textureFile);
+	}
+}
+
+/***********************************************************
+ *  BakeSceneTextures()
+ *
+ *  This method is used for baking every scene texture into
+ *  a compressed DDS file next to its image file. The baked
+ *  files are picked up in place of the images on the next
+ *  launch.
+ ***********************************************************/
+bool SceneManager::BakeSceneTextures()
+{
+	bool bSuccess = true;
+
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		std::string bakedFile = TextureBaker::GetBakedFilename(g_SceneTextures[i].filename);
+
+		if (TextureBaker::BakeTexture(g_SceneTextures[i].filename, bakedFile.c_str()) == false)
+		{
+			bSuccess = false;
+		}
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  There are up to 4 light sources.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting, if no light sources have
+	// been added then the display window will be black - to use the 
+	// default OpenGL lighting then comment out the following line
+	//m_pShaderManager->setBoolValue(g_UseLightingName, true);
+
+	/*** STUDENTS - add the code BELOW for setting up light sources ***/
+	/*** Up to four light sources can be defined. Refer to the code ***/
+	/*** in the OpenGL Sample for help                              ***/
+
+	// all of the light sources are uploaded together into
+	// the light uniform block, unused ones are left inactive
+	UniformBlocks::LIGHT_BLOCK lights = UniformBlocks::LIGHT_BLOCK();
+
+	lights.directionalLight.vector = glm::vec3(-5.0f, -5.0f, -4.0f);
+	lights.directionalLight.ambient = glm::vec3(0.8f, 0.8f, 0.8f);
+	lights.directionalLight.diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+	lights.directionalLight.specular = glm::vec3(0.6f, 0.6f, 0.6f);
+	lights.directionalLight.bActive = true;
+
+	// the point lights - a radius of zero reaches the whole scene,
+	// lights with a radius fade out and only cost the fragments
+	// they reach when the clustered lighting is used
+	std::vector<LightClusters::POINT_LIGHT> pointLights;
+	LightClusters::POINT_LIGHT pointLight;
+	pointLight.position = glm::vec3(0.0f, 8.0f, 1.0f);
+	pointLight.radius = 0.0f;
+	pointLight.ambient = glm::vec3(0.4f, 0.4f, 0.3f);
+	pointLight.diffuse = glm::vec3(0.8f, 0.8f, 0.7f);
+	pointLight.specular = glm::vec3(0.9f, 0.9f, 0.8f);
+	pointLights.push_back(pointLight);
+
+	// the forward lighting only has slots for the first lights
+	for (unsigned int i = 0; (i < pointLights.size()) && (i < TOTAL_POINT_LIGHTS); i++)
+	{
+		lights.pointLights[i].vector = pointLights[i].position;
+		lights.pointLights[i].ambient = pointLights[i].ambient;
+		lights.pointLights[i].diffuse = pointLights[i].diffuse;
+		lights.pointLights[i].specular = pointLights[i].specular;
+		lights.pointLights[i].bActive = true;
+	}
+
+	m_pUniformBlocks->SetLights(lights);
+
+	// every point light is sorted into the clusters of the view
+	m_pLightClusters->CreateBuffers();
+	m_pLightClusters->SetLights(pointLights);
+	m_pLightClusters->BindTextures(m_lightClusterUnit);
+	// the samplers are set for both paths, since samplers of
+	// different types must never share a texture unit
+	m_pShaderState->setSampler2DValue("clusterLights", m_lightClusterUnit);
+	m_pShaderState->setSampler2DValue("clusterGrid", m_lightClusterUnit + 1);
+	m_pShaderState->setSampler2DValue("clusterLightIndices", m_lightClusterUnit + 2);
+	m_pShaderState->setBoolValue("bUseClusteredLighting", m_lightingPath == LIGHTING_CLUSTERED);
+
+	m_pShaderState->setBoolValue("bUseLighting", true);
+
+	// the directional light casts shadows into cascades fitted
+	// around the camera view
+	m_shadowLightDirection = lights.directionalLight.vector;
+	if ((m_bShadows == true) && (lights.directionalLight.bActive != 0) &&
+		(m_pShadowCascades->CreateTargets(g_ShadowMapResolution) == true))
+	{
+		m_pShadowCascades->BindTexture(m_shadowUnit);
+	}
+	m_pShaderState->setSampler2DValue("shadowMap", m_shadowUnit);
+
+	// the draws switch between programs compiled for these lights
+	LoadShaderVariants(lights, true);
+}
+
+/***********************************************************
+ *  DefineSceneNodes()
+ *
+ *  This method is used for adding all of the objects of the
+ *  3D scene as nodes, each with the mesh to draw, the
+ *  transformation values and the texture and material tags.
+ ***********************************************************/
+void SceneManager::DefineSceneNodes()
+{
+	/*** Desk ***/
+	AddSceneNode(
+		MESH_PLANE,
+		glm::vec3(15.0f, 1.0f, 5.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.0f, 4.0f),
+		"desk", "carbon");
+
+	/*** Keyboard ***/
+	AddSceneNode(
+		MESH_BOX,
+		glm::vec3(10.0f, 0.2f, 4.0f),
+		1.8f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.05f, 4.0f),
+		"keyboard", "plastic");
+
+	/*** Coaster ***/
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(1.0f, 0.05f, 1.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(7.0f, 0.0f, 4.0f),
+		"rest", "fabric");
+
+	/*** WristRest ***/
+	AddSceneNode(
+		MESH_BOX,
+		glm::vec3(9.5f, 0.05f, 1.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.05f, 7.0f),
+		"rest", "fabric");
+	// top part
+	AddSceneNode(
+		MESH_BOX,
+		glm::vec3(9.4f, 0.15f, 1.4f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.1f, 7.0f),
+		"rest", "fabric");
+
+	/*** Notebook ***/
+	AddSceneNode(
+		MESH_BOX2,
+		glm::vec3(4.8f, 0.1f, 6.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-9.0f, 0.05f, 4.5f),
+		"notebook", "note");
+
+	/*** Spirals ***/
+	// 30 coil rings spaced evenly along the spine of the notebook
+	for (int i = 0; i < 30; i++)
+	{
+		AddSceneNode(
+			MESH_TORUS,
+			glm::vec3(0.1f, 0.1f, 0.05f),
+			0.0f, 0.0f, 0.0f,
+			glm::vec3(-11.4f, 0.05f, 1.6f + (0.2f * i)),
+			"metal", "metal");
+	}
+
+	/*** Pencils ***/
+	// pencil tips
+	AddSceneNode(
+		MESH_CONE,
+		glm::vec3(0.1f, 0.3f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-9.8f, 0.2f, 2.2f),
+		"wood", "wood");
+	AddSceneNode(
+		MESH_CONE,
+		glm::vec3(0.1f, 0.3f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-10.3f, 0.2f, 2.7f),
+		"wood", "wood");
+	// pencil barrels
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.1f, 3.253f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-7.5f, 0.2f, 4.5f),
+		"pencil", "pencil");
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.1f, 3.253f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-8.0f, 0.2f, 5.0f),
+		"pencil", "pencil");
+	// metal connectors
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.105f, 0.3f, 0.105f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-7.3f, 0.2f, 4.7f),
+		"metal1", "metal");
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.105f, 0.3f, 0.105f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-7.8f, 0.2f, 5.2f),
+		"metal1", "metal");
+	// erasers
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.1f, 0.2f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-7.2f, 0.2f, 4.8f),
+		"eraser", "rubber");
+	AddSceneNode(
+		MESH_CYLINDER,
+		glm::vec3(0.1f, 0.2f, 0.1f),
+		-90.0f, 45.0f, 0.0f,
+		glm::vec3(-7.7f, 0.2f, 5.3f),
+		"eraser", "rubber");
+}
+
+/***********************************************************
+ *  DefineSceneFileTables()
+ *
+ *  This method is used for defining the object materials
+ *  and the texture image files from the records of a loaded
+ *  scene file, in place of the ones of the desk scene.
+ ***********************************************************/
+void SceneManager::DefineSceneFileTables(const SceneFile& sceneFile)
+{
+	const SceneFile::MATERIAL_RECORD* pMaterials = sceneFile.GetMaterials();
+	for (int i = 0; i < sceneFile.GetMaterialCount(); i++)
+	{
+		const SceneFile::MATERIAL_RECORD& record = pMaterials[i];
+
+		OBJECT_MATERIAL material;
+		material.ambientColor = glm::vec3(record.ambientColor[0], record.ambientColor[1], record.ambientColor[2]);
+		material.ambientStrength = record.ambientStrength;
+		material.diffuseColor = glm::vec3(record.diffuseColor[0], record.diffuseColor[1], record.diffuseColor[2]);
+		material.specularColor = glm::vec3(record.specularColor[0], record.specularColor[1], record.specularColor[2]);
+		material.shininess = record.shininess;
+		material.tag = record.tag;
+		m_objectMaterials.push_back(material);
+	}
+
+	const SceneFile::TEXTURE_RECORD* pTextures = sceneFile.GetTextures();
+	for (int i = 0; i < sceneFile.GetTextureCount(); i++)
+	{
+		TEXTURE_FILE textureFile;
+		textureFile.filename = pTextures[i].filename;
+		textureFile.tag = pTextures[i].tag;
+		m_textureFiles.push_back(textureFile);
+	}
+}
+
+/***********************************************************
+ *  DefineSceneFileNodes()
+ *
+ *  This method is used for adding the node records of a
+ *  loaded scene file as the objects of the 3D scene. The
+ *  records are read straight from the mapped file, and
+ *  refer to their texture and material by record index.
+ ***********************************************************/
+void SceneManager::DefineSceneFileNodes(const SceneFile& sceneFile)
+{
+	const SceneFile::TEXTURE_RECORD* pTextures = sceneFile.GetTextures();
+	const SceneFile::MATERIAL_RECORD* pMaterials = sceneFile.GetMaterials();
+	const SceneFile::NODE_RECORD* pNodes = sceneFile.GetNodes();
+	const int nodeCount = sceneFile.GetNodeCount();
+
+	m_sceneNodes.reserve(m_sceneNodes.size() + nodeCount);
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const SceneFile::NODE_RECORD& node = pNodes[i];
+
+		AddSceneNode(
+			(MESH_TYPE)node.mesh,
+			glm::vec3(node.scaleXYZ[0], node.scaleXYZ[1], node.scaleXYZ[2]),
+			node.rotationDegrees[0], node.rotationDegrees[1], node.rotationDegrees[2],
+			glm::vec3(node.positionXYZ[0], node.positionXYZ[1], node.positionXYZ[2]),
+			(node.texture >= 0) ? pTextures[node.texture].tag : "",
+			(node.material >= 0) ? pMaterials[node.material].tag : "");
+	}
+
+	std::cout << "INFO: " << nodeCount << " nodes " << (sceneFile.IsMapped() ? "mapped from " : "parsed from ")
+		<< m_sceneFilename << std::endl;
+}
+
+/***********************************************************
+ *  DefineStressSceneNodes()
+ *
+ *  This method is used for filling the scene with copies of
+ *  the desk props instead of the desk, laid out on a square
+ *  grid around the desk with one prop per cell, on a ground
+ *  plane covering the grid. The prop, its rotation, size and
+ *  place in the cell, and its texture and material are all
+ *  picked at random, from a fixed seed so that the scene is
+ *  the same on every run and every platform.
+ ***********************************************************/
+void SceneManager::DefineStressSceneNodes()
+{
+	std::mt19937 random(g_StressSeed);
+	// a float from 0 to 1 with 24 random bits, the distributions
+	// of the standard library differ between platforms
+	auto randomUnit = [&random]()
+		{
+			return((float)(random() >> 8) * (1.0f / 16777216.0f));
+		};
+
+	int gridSize = (int)std::ceil(std::sqrt((float)m_stressObjectCount));
+	float halfSize = 0.5f * g_StressSpacing * gridSize;
+	glm::vec3 center = glm::vec3(0.0f, 0.0f, 4.0f);
+
+	/*** Ground ***/
+	AddSceneNode(
+		MESH_PLANE,
+		glm::vec3(halfSize, 1.0f, halfSize),
+		0.0f, 0.0f, 0.0f,
+		center,
+		"desk", "carbon");
+
+	/*** Props ***/
+	for (int i = 0; i < m_stressObjectCount; i++)
+	{
+		const STRESS_PROP& prop = g_StressProps[random() % g_StressPropCount];
+		// a scene file may leave out the textures or materials
+		std::string textureTag;
+		std::string materialTag;
+		if (m_textureFiles.size() > 0)
+		{
+			textureTag = m_textureFiles[random() % m_textureFiles.size()].tag;
+		}
+		if (m_objectMaterials.size() > 0)
+		{
+			materialTag = m_objectMaterials[random() % m_objectMaterials.size()].tag;
+		}
+
+		float scale = 0.75f + (0.5f * randomUnit());
+		float yRotation = 360.0f * randomUnit();
+		glm::vec3 position = center + glm::vec3(
+			(((i % gridSize) + 0.2f + (0.6f * randomUnit())) * g_StressSpacing) - halfSize,
+			prop.height * scale,
+			(((i / gridSize) + 0.2f + (0.6f * randomUnit())) * g_StressSpacing) - halfSize);
+
+		AddSceneNode(
+			prop.mesh,
+			prop.scaleXYZ * scale,
+			prop.XrotationDegrees, yRotation, 0.0f,
+			position,
+			textureTag, materialTag);
+	}
+
+	std::cout << "INFO: stress scene of " << m_stressObjectCount << " props on a "
+		<< gridSize << "x" << gridSize << " grid" << std::endl;
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// the materials, textures and nodes come from the scene file
+	// when one is passed in, the binary form is mapped and its
+	// records are read in place until the nodes are added
+	SceneFile sceneFile;
+	bool bSceneFile = false;
+	if (m_sceneFilename.empty() == false)
+	{
+		bSceneFile = sceneFile.Open(m_sceneFilename.c_str());
+		if (bSceneFile == false)
+		{
+			std::cout << "Drawing the desk scene instead of " << m_sceneFilename << std::endl;
+		}
+	}
+
+	m_objectMaterials.clear();
+	m_textureFiles.clear();
+	if (bSceneFile)
+	{
+		DefineSceneFileTables(sceneFile);
+	}
+	else
+	{
+		DefineObjectMaterials();
+		DefineSceneTextures();
+	}
+	LoadMaterialTable();
+	LoadSceneTextures();
+	SetupSceneLights();
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene - the basic meshes are only
+	// drawn by the naive submit path, and are loaded when it
+	// is chosen
+
+	// the same meshes are generated into one shared buffer, so
+	// that repeated objects, such as the spiral coil rings of the
+	// notebook, and even the whole scene can be drawn at once,
+	// and are mapped in from the mesh cache after the first launch
+	if (m_bMeshCache)
+	{
+		m_instancedMeshes->OpenMeshCache(g_MeshCacheFile);
+	}
+	m_instancedMeshIDs[MESH_PLANE][0] = m_instancedMeshes->LoadPlaneMesh();
+	m_instancedMeshIDs[MESH_PRISM][0] = m_instancedMeshes->LoadPrismMesh();
+	m_instancedMeshIDs[MESH_BOX][0] = m_instancedMeshes->LoadBoxMesh();
+	m_instancedMeshIDs[MESH_BOX2][0] = m_instancedMeshIDs[MESH_BOX][0];
+
+	// the round meshes get coarser levels of detail, for when
+	// they only cover a few pixels of the screen
+	const int roundSegments[MESH_LOD_LEVELS] = { 36, 16, 8 };
+	const int torusMainSegments[MESH_LOD_LEVELS] = { 30, 18, 10 };
+	const int torusTubeSegments[MESH_LOD_LEVELS] = { 30, 12, 6 };
+	for (int lod = 0; lod < MESH_LOD_LEVELS; lod++)
+	{
+		m_instancedMeshIDs[MESH_CYLINDER][lod] = m_instancedMeshes->LoadCylinderMesh(roundSegments[lod]);
+		m_instancedMeshIDs[MESH_CONE][lod] = m_instancedMeshes->LoadConeMesh(roundSegments[lod]);
+		m_instancedMeshIDs[MESH_TORUS][lod] = m_instancedMeshes->LoadTorusMesh(0.1f, torusMainSegments[lod], torusTubeSegments[lod]);
+	}
+	m_instancedMeshes->UploadMeshes();
+	m_meshLodCount[MESH_CYLINDER] = MESH_LOD_LEVELS;
+	m_meshLodCount[MESH_CONE] = MESH_LOD_LEVELS;
+	m_meshLodCount[MESH_TORUS] = MESH_LOD_LEVELS;
+
+	// the meshes with a single level use it for every level
+	for (int i = 0; i <= MESH_TORUS; i++)
+	{
+		for (int lod = m_meshLodCount[i]; lod < MESH_LOD_LEVELS; lod++)
+		{
+			m_instancedMeshIDs[i][lod] = m_instancedMeshIDs[i][0];
+		}
+	}
+
+	// the bounds of the generated meshes are used for culling
+	// the objects drawn with either set of meshes
+	for (int i = 0; i <= MESH_TORUS; i++)
+	{
+		m_instancedMeshes->GetMeshBounds(
+			m_instancedMeshIDs[i][0],
+			m_meshBounds[i].minimum,
+			m_meshBounds[i].maximum);
+	}
+
+	// submit the whole scene with multi-draw indirect calls
+	// when they are supported
+	SetSubmitMode(SUBMIT_INDIRECT);
+	// and cull it with a compute shader when that is supported
+	if (m_pGpuCulling->LoadShader("shaders/cullComputeShader.glsl"))
+	{
+		m_pGpuCulling->SetLodSelection(g_LodFineThreshold, g_LodCoarseThreshold, g_LodHysteresis);
+		SetGpuCulling(true);
+	}
+
+	// fill the retained scene and compile it into the draw
+	// list, so nothing but the draw calls is left per frame
+	m_sceneNodes.clear();
+	if (m_stressObjectCount > 0)
+	{
+		DefineStressSceneNodes();
+	}
+	else if (bSceneFile)
+	{
+		DefineSceneFileNodes(sceneFile);
+	}
+	else
+	{
+		DefineSceneNodes();
+	}
+	CompileDrawList();
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  walking the draw list compiled from the scene nodes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// the scratch memory of the last frame is handed out again
+	m_pFrameArena->Reset();
+
+	// upload the textures that finished loading in the background
+	m_pTextureLoader->ProcessUploads(g_TextureUploadsPerFrame);
+	// once they are all loaded, pack them into texture arrays
+	if ((m_bTexturesPacked == false) && (m_pTextureLoader->GetPendingCount() == 0))
+	{
+		PackGLTextures();
+	}
+
+	// only the nodes that moved since the last frame
+	// get their model matrices recalculated
+	UpdateTransforms();
+	// every pass of this frame reads the instances from its own
+	// region of the ring buffer
+	WriteFrameInstances();
+	// skip the objects that are outside of the camera view
+	CullSceneNodes();
+	// find the point lights reaching each part of the view
+	if (m_lightingPath == LIGHTING_CLUSTERED)
+	{
+		UpdateLightClusters();
+	}
+
+	memset(&m_drawStats, 0, sizeof(m_drawStats));
+
+	// the depth from the directional light, before the main pass
+	// that reads it
+	RenderShadowMaps();
+
+	if (m_submitMode == SUBMIT_INDIRECT)
+	{
+		// the material index and texture layer of every object
+		// are read from the instance buffer, only the texture
+		// array has to be bound per multi-draw call
+		m_pShaderState->setBoolValue(m_uniformIDs.useInstancing, true);
+		for (unsigned int i = 0; i < m_indirectBatches.size(); i++)
+		{
+			const INDIRECT_BATCH& batch = m_indirectBatches[i];
+			if (batch.commandCount == 0)
+			{
+				continue;
+			}
+
+			SetShaderTexture(batch.texture);
+			if (IsGpuCullingActive())
+			{
+				// the surviving instances were packed by the culling pass
+				m_instancedMeshes->DrawIndirect(
+					batch.firstCommand,
+					batch.commandCount,
+					m_pGpuCulling->GetCulledInstanceBuffer(),
+					m_pGpuCulling->GetCulledInstanceDataBuffer());
+			}
+			else
+			{
+				m_instancedMeshes->DrawIndirect(batch.firstCommand, batch.commandCount);
+			}
+			m_drawStats.drawCalls++;
+			m_drawStats.triangles += batch.triangleCount;
+			// only the texture array is bound per multi-draw call
+			m_drawStats.stateChanges++;
+		}
+	}
+	else
+	{
+		for (unsigned int i = 0; i < m_drawList.size(); i++)
+		{
+			const DRAW_BATCH& batch = m_drawList[i];
+
+			// count the state that differs from the previous batch
+			if (i == 0)
+			{
+				m_drawStats.stateChanges += 4;
+			}
+			else
+			{
+				m_drawStats.stateChanges += CountStateChanges(
+					m_drawList[i - 1].sortKey,
+					batch.sortKey);
+			}
+
+			SetShaderTexture(batch.texture);
+			SetShaderMaterial(batch.material);
+
+			DrawBatch(batch, m_batchPackets[i]);
+		}
+	}
+
+	m_drawStats.batches = (int)m_drawList.size();
+	// the unsorted count is of the shader, texture, material and
+	// mesh changes between batches, which the multi-draw calls
+	// don't bind, so it is only compared against direct drawing
+	if (m_submitMode != SUBMIT_INDIRECT)
+	{
+		m_drawStats.stateChangesAvoided = m_unsortedStateChanges - m_drawStats.stateChanges;
+	}
+	m_drawStats.visibleObjects = m_visibleCount;
+	m_drawStats.culledObjects = (int)m_sceneNodes.size() - m_visibleCount;
+	if (IsGpuCullingActive() == false)
+	{
+		memcpy(m_drawStats.lodObjects, m_lodCounts, sizeof(m_lodCounts));
+	}
+}
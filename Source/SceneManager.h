@@ -1,117 +1,557 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.h
-// ============
-// manage the preparing and rendering of 3D scenes - textures, materials, lighting
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	// properties for object materials
-	struct OBJECT_MATERIAL
-	{
-		glm::vec3 ambientColor;
-		float ambientStrength;
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
-	void RenderScene();
-
-	// pre-set light sources for 3D scene
-	void SetupSceneLights();
-	// loads textures from image files
-	void LoadSceneTextures();
-	// pre-define the object materials for lighting
-	void DefineObjectMaterials();
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.h
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShaderStateCache.h"
+#include "UniformBlocks.h"
+#include "ShapeMeshes.h"
+#include "InstancedMeshes.h"
+#include "FrameArena.h"
+#include "Frustum.h"
+#include "GpuCulling.h"
+#include "LightClusters.h"
+#include "ShaderVariants.h"
+#include "ShadowCascades.h"
+#include "RingBuffer.h"
+#include "SceneFile.h"
+#include "ThreadPool.h"
+#include "TextureLoader.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(
+		ShaderManager *pShaderManager,
+		ShaderStateCache* pShaderState,
+		UniformBlocks* pUniformBlocks);
+	// destructor
+	~SceneManager();
+
+	// handles for a loaded texture slot and a defined material,
+	// resolved once from their tags when the scene is prepared
+	typedef int TextureHandle;
+	typedef int MaterialHandle;
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+		// layer of the texture array holding the texture
+		int layer;
+		// index of the texture array among the bound ones
+		int unit;
+	};
+
+	// properties for object materials
+	struct OBJECT_MATERIAL
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	// types of the basic meshes that scene nodes can draw
+	enum MESH_TYPE
+	{
+		MESH_PLANE,
+		MESH_PRISM,
+		MESH_BOX,
+		MESH_BOX2,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_TORUS
+	};
+
+	// properties for an object of the retained 3D scene
+	struct SCENE_NODE
+	{
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float YrotationDegrees;
+		float ZrotationDegrees;
+		glm::vec3 positionXYZ;
+		std::string textureTag;
+		std::string materialTag;
+		// handles resolved from the tags
+		TextureHandle texture;
+		MaterialHandle material;
+		// shader program the node is drawn with
+		int shader;
+		// packed draw state the draw list is sorted by
+		uint64_t sortKey;
+		// ID returned when the node was added
+		int nodeID;
+	};
+
+	// ways of submitting the draw list to OpenGL
+	enum SUBMIT_MODE
+	{
+		SUBMIT_NAIVE,		// one draw call per object
+		SUBMIT_INSTANCED,	// one instanced draw call per batch
+		SUBMIT_INDIRECT		// one multi-draw call per texture array
+	};
+
+	// ways of evaluating the point lights of the scene
+	enum LIGHTING_PATH
+	{
+		LIGHTING_FORWARD,	// every fragment loops over the fixed light slots
+		LIGHTING_CLUSTERED	// every fragment loops over the lights of its cluster
+	};
+
+	// objects drawn back to back with the same mesh, texture
+	// and material - a range of the sorted scene nodes
+	struct DRAW_BATCH
+	{
+		uint64_t sortKey;
+		MESH_TYPE mesh;
+		TextureHandle texture;
+		MaterialHandle material;
+		int firstNode;
+		int nodeCount;
+	};
+
+	// a run of visible objects of a batch drawn with the same level
+	// of detail, encoded by the worker threads for the GL thread to
+	// replay - their model matrices are the cached ones of the run
+	struct DRAW_PACKET
+	{
+		int meshID;
+		int firstNode;
+		int nodeCount;
+	};
+
+	// batches of the draw list drawn with one texture array
+	// bound, and their commands in the indirect buffer
+	struct INDIRECT_BATCH
+	{
+		TextureHandle texture;
+		int firstBatch;
+		int batchCount;
+		int firstCommand;
+		int commandCount;
+		// triangles drawn by the commands, or the most they can
+		// draw when the culling is done on the GPU
+		int triangleCount;
+	};
+
+	// draw state changes of the last rendered frame
+	struct DRAW_STATS
+	{
+		int batches;
+		int drawCalls;
+		int stateChanges;
+		// state changes saved by sorting the draw list, only
+		// counted when the batches are drawn directly
+		int stateChangesAvoided;
+		int visibleObjects;
+		int culledObjects;
+		// visible objects at each level of detail, only known
+		// when the culling is done on the CPU
+		int lodObjects[MESH_LOD_LEVELS];
+		// draw calls of the shadow pass, only made when the
+		// camera or an object moved
+		int shadowDrawCalls;
+		// triangles submitted by the scene and shadow passes, the
+		// scene pass counts every object at its finest level when
+		// culling on the GPU
+		int triangles;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to the uniform state cache in front of the shader manager
+	ShaderStateCache* m_pShaderState;
+	// pointer to the uniform buffers shared by the shader programs
+	UniformBlocks* m_pUniformBlocks;
+	// interned IDs of the uniforms that are set every frame
+	struct UNIFORM_IDS
+	{
+		int model;
+		int objectColor;
+		int objectTexture;
+		int textureLayer;
+		int useTexture;
+		int useInstancing;
+		int UVscale;
+		int materialIndex;
+		int clusterTileSize;
+		int clusterDepthScale;
+		int clusterDepthBias;
+		int lightViewProjection;
+		int shadowMatrices[SHADOW_CASCADES];
+		int shadowSplitDepths;
+	};
+	UNIFORM_IDS m_uniformIDs;
+	// pointer to basic shapes object, and whether its meshes are
+	// loaded
+	ShapeMeshes* m_basicMeshes;
+	bool m_bBasicMeshesLoaded;
+	// pointer to the shapes that are drawn with instancing, and
+	// whether they are cached between launches
+	InstancedMeshes* m_instancedMeshes;
+	bool m_bMeshCache;
+	// worker threads for the background jobs of the scene
+	ThreadPool* m_pThreadPool;
+	// scratch memory of the frame, such as the culling results
+	// of the worker threads and the indirect commands
+	FrameArena* m_pFrameArena;
+	// background loader for the scene textures
+	TextureLoader* m_pTextureLoader;
+	// loaded textures info
+	std::vector<TEXTURE_INFO> m_textureIDs;
+	// texture unit shared by the textures that do not have a
+	// unit of their own, and the texture bound to it
+	int m_overflowUnit;
+	GLuint m_overflowTexture;
+	// first of the texture units the light cluster buffer
+	// textures are bound to, after all of the scene textures
+	int m_lightClusterUnit;
+	// texture unit the shadow cascades are bound to
+	int m_shadowUnit;
+	// set once the loaded textures are packed into arrays
+	bool m_bTexturesPacked;
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// image files of the scene textures and their tags
+	struct TEXTURE_FILE
+	{
+		std::string filename;
+		std::string tag;
+	};
+	std::vector<TEXTURE_FILE> m_textureFiles;
+	// objects of the retained 3D scene
+	std::vector<SCENE_NODE> m_sceneNodes;
+	// sorted batches compiled from the scene nodes
+	std::vector<DRAW_BATCH> m_drawList;
+	// draw packets of every batch of the draw list, encoded again
+	// whenever the culling changes
+	std::vector<std::vector<DRAW_PACKET> > m_batchPackets;
+	// index of each scene node in the sorted order, by node ID
+	std::vector<int> m_nodeIndexByID;
+	// cached model matrices of the scene nodes, in the same
+	// order as the sorted nodes
+	std::vector<glm::mat4> m_modelMatrices;
+	// whether the model matrix of each scene node is out of date
+	std::vector<unsigned char> m_transformDirty;
+	// whether any model matrix is out of date
+	bool m_bTransformsDirty;
+	// state changes the scene would need when drawn in the order
+	// the nodes were defined, compared against the sorted order
+	int m_unsortedStateChanges;
+	// draw state changes of the last rendered frame
+	DRAW_STATS m_drawStats;
+	// how the draw list is submitted
+	SUBMIT_MODE m_submitMode;
+	// IDs of the meshes in the shared buffers, by mesh type and
+	// level of detail, and the number of levels of each type
+	int m_instancedMeshIDs[MESH_TORUS + 1][MESH_LOD_LEVELS];
+	int m_meshLodCount[MESH_TORUS + 1];
+	// ranges of the indirect buffer, in draw order
+	std::vector<INDIRECT_BATCH> m_indirectBatches;
+	// object space bounds of the meshes, by mesh type
+	Frustum::BOUNDING_BOX m_meshBounds[MESH_TORUS + 1];
+	// world space bounds of the scene nodes, in the same order
+	// as the cached model matrices
+	std::vector<Frustum::BOUNDING_BOX> m_worldBounds;
+	// whether each scene node is inside of the view frustum
+	std::vector<unsigned char> m_nodeVisible;
+	// level of detail each scene node is drawn with
+	std::vector<unsigned char> m_nodeLod;
+	// visible scene nodes at each level of detail
+	int m_lodCounts[MESH_LOD_LEVELS];
+	// whether objects outside of the view frustum are skipped
+	bool m_bFrustumCulling;
+	// view-projection matrix the visibility was tested with,
+	// and whether the visibility is still up to date
+	glm::mat4 m_cullViewProjection;
+	bool m_bCullingValid;
+	// objects found inside of the view frustum
+	int m_visibleCount;
+	// compute shader pass culling the indirect draws on the GPU,
+	// whether it is to be used, and whether the indirect buffer
+	// holds the per-batch commands it writes into
+	GpuCulling* m_pGpuCulling;
+	bool m_bGpuCulling;
+	bool m_bIndirectForGpu;
+	// point lights sorted into clusters of the view, and how
+	// the point lights are evaluated
+	LightClusters* m_pLightClusters;
+	LIGHTING_PATH m_lightingPath;
+	// shader programs compiled with the features of the scene,
+	// for untextured and textured draws
+	ShaderVariants* m_pShaderVariants;
+	GLuint m_variantPrograms[2];
+	bool m_bShaderVariants;
+	// program loaded by the shader manager, used when there are
+	// no variants
+	GLuint m_baseProgram;
+	// depth of the scene from the directional light, rendered
+	// with a depth-only program from a command per batch that
+	// follows the commands of the main pass
+	ShadowCascades* m_pShadowCascades;
+	GLuint m_depthProgram;
+	glm::vec3 m_shadowLightDirection;
+	int m_shadowFirstCommand;
+	int m_shadowCommandCount;
+	bool m_bShadows;
+	bool m_bShadowsValid;
+	// number of generated objects replacing the desk scene, 0 for
+	// the desk scene itself
+	int m_stressObjectCount;
+	// scene file the layout is loaded from instead of the desk
+	// scene, empty for the desk scene
+	std::string m_sceneFilename;
+	// per-frame allocator the instance attributes are written
+	// into, and the draw values of every scene node they are
+	// written from along with the cached model matrices
+	RingBuffer* m_pRingBuffer;
+	std::vector<InstancedMeshes::INSTANCE_DATA> m_instanceData;
+	// whether the matrices or draw values changed since the last
+	// frame, whether the shared instance buffers hold the current
+	// ones and are drawn from, and the frames since any frame read
+	// the shared instance buffers
+	bool m_bInstancesChanged;
+	bool m_bSharedInstancesCurrent;
+	int m_ringInstanceFrames;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, const std::string& tag);
+	// load texture from image file in the background, drawing a
+	// placeholder texture until it has finished loading
+	bool CreateGLTextureAsync(const char* filename, const std::string& tag);
+
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// pack the loaded textures of the same size into texture arrays
+	void PackGLTextures();
+	// draw state of a texture for the sort key
+	int GetTextureSortID(TextureHandle texture) const;
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+	// upload the defined materials into the material table
+	void LoadMaterialTable();
+	// find a defined material by tag
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+	// resolve the tags into handles for the per-frame methods
+	TextureHandle FindTextureHandle(const std::string& tag);
+	MaterialHandle FindMaterialHandle(const std::string& tag);
+
+	// calculate the model matrix from the
+	// transformation values
+	glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// set a previously calculated model matrix
+	// into the transform buffer
+	void SetTransformations(
+		const glm::mat4& modelMatrix);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		const std::string& textureTag);
+	void SetShaderTexture(
+		TextureHandle texture);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		MaterialHandle material);
+
+	// add an object to the retained 3D scene, returns the node ID
+	int AddSceneNode(
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		const std::string& textureTag,
+		const std::string& materialTag);
+	// pack the draw state of a scene node into its sort key
+	static uint64_t MakeSortKey(int shader, int textureSortID, MaterialHandle material, MESH_TYPE mesh);
+	// count the state changes between consecutive sort keys
+	static int CountStateChanges(uint64_t previousKey, uint64_t sortKey);
+	// compile the scene nodes into the sorted draw list
+	void CompileDrawList();
+	// draw the visible runs of objects of a batch from the draw list
+	void DrawBatch(const DRAW_BATCH& batch, const std::vector<DRAW_PACKET>& packets);
+	// write the draw list into the per-instance draw values
+	// and group its batches by texture array
+	void BuildIndirectCommands();
+	// write the visible objects into the indirect buffer
+	void WriteIndirectCommands();
+	// add a command drawing every object of each batch, for the
+	// shadow pass
+	void AppendShadowCommands(InstancedMeshes::DRAW_COMMAND* pCommands, int& commandCount);
+	// test the scene nodes against the view frustum of the camera
+	void CullSceneNodes();
+	// whether the culling is done by the compute shader pass
+	bool IsGpuCullingActive() const;
+	// pick the level of detail for a projected size
+	static int SelectLod(float projectedSize, int lod, int lodCount);
+	// find the next run of visible objects of a batch that are
+	// drawn with the same level of detail, starting at node
+	bool FindDrawRun(
+		const DRAW_BATCH& batch,
+		int& node,
+		int& firstNode,
+		int& nodeCount,
+		int& lod) const;
+	// encode the draw packets of every batch from the culling
+	// results, on the worker threads
+	void EncodeDrawPackets();
+	// recalculate the out of date model matrices
+	void UpdateTransforms();
+	// write the instance attributes of every scene node into the
+	// ring buffer region of this frame while they change, or into
+	// the shared instance buffers once they stopped changing
+	void WriteFrameInstances();
+	// sort the point lights into the clusters of the camera view
+	void UpdateLightClusters();
+	// compile the shader variants for the lights of the scene
+	void LoadShaderVariants(const UniformBlocks::LIGHT_BLOCK& lights, bool bLighting);
+	// block of defines for a shader variant
+	std::string MakeVariantDefines(
+		const UniformBlocks::LIGHT_BLOCK& lights,
+		bool bLighting,
+		bool bTextured) const;
+	// switch to the shader variant for the next draws
+	void UseShaderVariant(bool bTextured);
+	// render the shadow cascades of the directional light, when
+	// the camera or an object moved
+	void RenderShadowMaps();
+	// draw every object of the scene into the bound shadow cascade
+	void DrawShadowCasters();
+
+public:
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	void RenderScene();
+
+	// pre-set light sources for 3D scene
+	void SetupSceneLights();
+	// loads textures from image files
+	void LoadSceneTextures();
+	// bake the scene textures into compressed files, run offline
+	static bool BakeSceneTextures();
+	// pre-define the object materials for lighting
+	void DefineObjectMaterials();
+	// pre-define the image files of the scene textures
+	void DefineSceneTextures();
+	// add the objects of the 3D scene as scene nodes
+	void DefineSceneNodes();
+	// take the materials and textures of a loaded scene file
+	void DefineSceneFileTables(const SceneFile& sceneFile);
+	// add the nodes of a loaded scene file as scene nodes
+	void DefineSceneFileNodes(const SceneFile& sceneFile);
+	// add a grid of copies of the desk props as scene nodes
+	void DefineStressSceneNodes();
+
+	// change the transformation values of a scene node, its
+	// model matrix is recalculated before the next draw
+	void SetNodeTransform(
+		int nodeID,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// draw state changes of the last rendered frame
+	const DRAW_STATS& GetDrawStats() const { return(m_drawStats); }
+
+	// choose how the draw list is submitted
+	void SetSubmitMode(SUBMIT_MODE submitMode);
+	SUBMIT_MODE GetSubmitMode() const { return(m_submitMode); }
+
+	// choose whether objects outside of the view are skipped
+	void SetFrustumCulling(bool bFrustumCulling);
+	// choose whether the indirect draws are culled on the GPU
+	void SetGpuCulling(bool bGpuCulling);
+
+	// choose how the point lights are evaluated, before the
+	// scene is prepared
+	void SetLightingPath(LIGHTING_PATH lightingPath) { m_lightingPath = lightingPath; }
+	LIGHTING_PATH GetLightingPath() const { return(m_lightingPath); }
+	// choose whether the draws use shader variants compiled for
+	// the scene, or branch on the features at runtime, before the
+	// scene is prepared
+	void SetShaderVariants(bool bShaderVariants) { m_bShaderVariants = bShaderVariants; }
+	// choose whether the directional light casts shadows, before
+	// the scene is prepared
+	void SetShadows(bool bShadows) { m_bShadows = bShadows; }
+	// choose whether the generated meshes are mapped in from the
+	// mesh cache, or always generated, before the scene is prepared
+	void SetMeshCache(bool bMeshCache) { m_bMeshCache = bMeshCache; }
+	// replace the desk scene with the passed in number of copies
+	// of its props for stress testing, before the scene is prepared
+	void SetStressScene(int objectCount) { m_stressObjectCount = objectCount; }
+	// load the materials, textures and nodes from the passed in
+	// scene file instead of the desk scene, before the scene is
+	// prepared
+	void SetSceneFile(const char* filename) { m_sceneFilename = filename; }
+	// write the instance attributes into the passed in ring buffer
+	// every frame, before the scene is prepared
+	void SetRingBuffer(RingBuffer* pRingBuffer) { m_pRingBuffer = pRingBuffer; }
+
+	// number of objects in the scene
+	int GetObjectCount() const { return((int)m_sceneNodes.size()); }
+	// scratch memory of the frame, for the profiler counters
+	const FrameArena& GetFrameArena() const { return(*m_pFrameArena); }
+	// whether the next frame differs from the last one on the scene
+	// side - textures still loading, moved objects or culling that
+	// has to be redone
+	bool IsRedrawNeeded() const;
 };
\ No newline at end of file
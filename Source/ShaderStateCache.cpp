@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderstatecache.cpp
+// ============
+// remember the location and the last value set into each shader uniform,
+// so that name lookups and uploads of unchanged values can be skipped, for
+// every shader program the scene switches between
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderStateCache.h"
+
+#include <cstring>
+
+/***********************************************************
+ *  ShaderStateCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderStateCache::ShaderStateCache(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_programID = 0;
+	m_currentProgram = -1;
+	m_uploadCount = 0;
+	m_skippedCount = 0;
+}
+
+/***********************************************************
+ *  ~ShaderStateCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderStateCache::~ShaderStateCache()
+{
+	m_pShaderManager = NULL;
+	m_uniforms.clear();
+	m_uniformIDs.clear();
+	m_programs.clear();
+}
+
+/***********************************************************
+ *  GetUniformID()
+ *
+ *  This method is used for interning a uniform name into an
+ *  ID. The same name always returns the same ID, and the ID
+ *  stays valid when the shader program is reloaded.
+ ***********************************************************/
+int ShaderStateCache::GetUniformID(const char* name)
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_uniformIDs.find(name);
+	if (found != m_uniformIDs.end())
+	{
+		return(found->second);
+	}
+
+	CACHED_UNIFORM uniform;
+	uniform.name = name;
+	uniform.type = VALUE_INT;
+	uniform.value.size = 0;
+
+	int uniformID = (int)m_uniforms.size();
+	m_uniforms.push_back(uniform);
+	m_uniformIDs[uniform.name] = uniformID;
+
+	// the programs that are already loaded get the new uniform too
+	UNIFORM_VALUE noValue;
+	noValue.size = 0;
+	for (unsigned int i = 0; i < m_programs.size(); i++)
+	{
+		m_programs[i].locations.push_back(glGetUniformLocation(m_programs[i].programID, name));
+		m_programs[i].values.push_back(noValue);
+	}
+
+	return(uniformID);
+}
+
+/***********************************************************
+ *  LoadUniformLocations()
+ *
+ *  This method is used for looking up the location of every
+ *  interned uniform in the shader program that is currently
+ *  in use. The values held by the program are forgotten,
+ *  since a new program starts with its own uniform values.
+ ***********************************************************/
+void ShaderStateCache::LoadUniformLocations()
+{
+	GLint programID = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &programID);
+	m_programID = (GLuint)programID;
+	m_currentProgram = -1;
+
+	if (m_programID != 0)
+	{
+		m_currentProgram = FindProgram(m_programID);
+		LoadProgramLocations(m_programs[m_currentProgram]);
+	}
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for switching to another shader
+ *  program. Every uniform value that was set while another
+ *  program was in use is uploaded into this one, so the
+ *  programs can be swapped between draws without setting
+ *  all of the values again.
+ ***********************************************************/
+void ShaderStateCache::UseProgram(GLuint programID)
+{
+	if ((programID == 0) || (programID == m_programID))
+	{
+		return;
+	}
+
+	glUseProgram(programID);
+	m_programID = programID;
+	m_currentProgram = FindProgram(programID);
+
+	for (unsigned int i = 0; i < m_uniforms.size(); i++)
+	{
+		const UNIFORM_VALUE& value = m_uniforms[i].value;
+		const UNIFORM_VALUE& uploaded = m_programs[m_currentProgram].values[i];
+		if ((value.size > 0) &&
+			((uploaded.size != value.size) || (memcmp(uploaded.data, value.data, value.size) != 0)))
+		{
+			UploadValue(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  FindProgram()
+ *
+ *  This method is used for finding the uniforms of a shader
+ *  program, looking up their locations the first time the
+ *  program is used.
+ ***********************************************************/
+int ShaderStateCache::FindProgram(GLuint programID)
+{
+	for (unsigned int i = 0; i < m_programs.size(); i++)
+	{
+		if (m_programs[i].programID == programID)
+		{
+			return(i);
+		}
+	}
+
+	PROGRAM_UNIFORMS program;
+	program.programID = programID;
+	LoadProgramLocations(program);
+	m_programs.push_back(program);
+
+	return((int)m_programs.size() - 1);
+}
+
+/***********************************************************
+ *  LoadProgramLocations()
+ *
+ *  This method is used for looking up the location of every
+ *  interned uniform in a shader program, and forgetting the
+ *  values the program holds.
+ ***********************************************************/
+void ShaderStateCache::LoadProgramLocations(PROGRAM_UNIFORMS& program)
+{
+	UNIFORM_VALUE noValue;
+	noValue.size = 0;
+
+	program.locations.resize(m_uniforms.size());
+	program.values.assign(m_uniforms.size(), noValue);
+	for (unsigned int i = 0; i < m_uniforms.size(); i++)
+	{
+		program.locations[i] = glGetUniformLocation(program.programID, m_uniforms[i].name.c_str());
+	}
+}
+
+/***********************************************************
+ *  SetValue()
+ *
+ *  This method is used for remembering the passed in value
+ *  of a uniform, and uploading it into the program in use
+ *  when the program does not already hold the same value.
+ ***********************************************************/
+void ShaderStateCache::SetValue(int uniformID, VALUE_TYPE type, const void* value, unsigned int size)
+{
+	if ((uniformID < 0) || (uniformID >= (int)m_uniforms.size()))
+	{
+		return;
+	}
+
+	CACHED_UNIFORM& uniform = m_uniforms[uniformID];
+	uniform.type = type;
+	memcpy(uniform.value.data, value, size);
+	uniform.value.size = size;
+
+	if (m_currentProgram < 0)
+	{
+		return;
+	}
+
+	const UNIFORM_VALUE& uploaded = m_programs[m_currentProgram].values[uniformID];
+	if ((uploaded.size == size) && (memcmp(uploaded.data, value, size) == 0))
+	{
+		m_skippedCount++;
+		return;
+	}
+
+	UploadValue(uniformID);
+}
+
+/***********************************************************
+ *  UploadValue()
+ *
+ *  This method is used for uploading the last set value of
+ *  a uniform into the program in use.
+ ***********************************************************/
+void ShaderStateCache::UploadValue(int uniformID)
+{
+	PROGRAM_UNIFORMS& program = m_programs[m_currentProgram];
+	const CACHED_UNIFORM& uniform = m_uniforms[uniformID];
+	GLint location = program.locations[uniformID];
+
+	program.values[uniformID] = uniform.value;
+	m_uploadCount++;
+
+	// uniforms the program does not use have no location
+	if (location < 0)
+	{
+		return;
+	}
+
+	const GLint* intData = (const GLint*)uniform.value.data;
+	const GLfloat* floatData = (const GLfloat*)uniform.value.data;
+	switch (uniform.type)
+	{
+	case VALUE_INT:
+		glUniform1i(location, intData[0]);
+		break;
+	case VALUE_FLOAT:
+		glUniform1f(location, floatData[0]);
+		break;
+	case VALUE_VEC2:
+		glUniform2fv(location, 1, floatData);
+		break;
+	case VALUE_VEC3:
+		glUniform3fv(location, 1, floatData);
+		break;
+	case VALUE_VEC4:
+		glUniform4fv(location, 1, floatData);
+		break;
+	case VALUE_MAT4:
+		glUniformMatrix4fv(location, 1, GL_FALSE, floatData);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  setBoolValue()
+ *
+ *  This method is used for setting a bool uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setBoolValue(int uniformID, bool value)
+{
+	// bools are stored as ints in the shader
+	setIntValue(uniformID, value ? 1 : 0);
+}
+
+/***********************************************************
+ *  setIntValue()
+ *
+ *  This method is used for setting an int uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setIntValue(int uniformID, int value)
+{
+	SetValue(uniformID, VALUE_INT, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  setFloatValue()
+ *
+ *  This method is used for setting a float uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setFloatValue(int uniformID, float value)
+{
+	SetValue(uniformID, VALUE_FLOAT, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  setSampler2DValue()
+ *
+ *  This method is used for setting the texture unit of a
+ *  sampler uniform into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setSampler2DValue(int uniformID, int value)
+{
+	setIntValue(uniformID, value);
+}
+
+/***********************************************************
+ *  setVec2Value()
+ *
+ *  This method is used for setting a vec2 uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setVec2Value(int uniformID, const glm::vec2& value)
+{
+	SetValue(uniformID, VALUE_VEC2, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  setVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setVec3Value(int uniformID, const glm::vec3& value)
+{
+	SetValue(uniformID, VALUE_VEC3, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  setVec4Value()
+ *
+ *  This method is used for setting a vec4 uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setVec4Value(int uniformID, const glm::vec4& value)
+{
+	SetValue(uniformID, VALUE_VEC4, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  setMat4Value()
+ *
+ *  This method is used for setting a mat4 uniform value
+ *  into the shader when it has changed.
+ ***********************************************************/
+void ShaderStateCache::setMat4Value(int uniformID, const glm::mat4& value)
+{
+	SetValue(uniformID, VALUE_MAT4, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  set*Value(name)
+ *
+ *  These methods are used for setting a uniform value by
+ *  name. The name is interned on every call, so they are
+ *  meant for load-time code rather than per-frame code.
+ ***********************************************************/
+void ShaderStateCache::setBoolValue(const char* name, bool value)
+{
+	setBoolValue(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setIntValue(const char* name, int value)
+{
+	setIntValue(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setFloatValue(const char* name, float value)
+{
+	setFloatValue(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setSampler2DValue(const char* name, int value)
+{
+	setSampler2DValue(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setVec2Value(const char* name, const glm::vec2& value)
+{
+	setVec2Value(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setVec3Value(const char* name, const glm::vec3& value)
+{
+	setVec3Value(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setVec3Value(const char* name, float x, float y, float z)
+{
+	setVec3Value(GetUniformID(name), glm::vec3(x, y, z));
+}
+
+void ShaderStateCache::setVec4Value(const char* name, const glm::vec4& value)
+{
+	setVec4Value(GetUniformID(name), value);
+}
+
+void ShaderStateCache::setMat4Value(const char* name, const glm::mat4& value)
+{
+	setMat4Value(GetUniformID(name), value);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting all of the values the
+ *  programs are remembered to hold, so the next set of each
+ *  one is uploaded.
+ ***********************************************************/
+void ShaderStateCache::Invalidate()
+{
+	for (unsigned int i = 0; i < m_programs.size(); i++)
+	{
+		for (unsigned int j = 0; j < m_programs[i].values.size(); j++)
+		{
+			m_programs[i].values[j].size = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for resetting the per-frame counters
+ *  of issued and skipped uniform uploads.
+ ***********************************************************/
+void ShaderStateCache::BeginFrame()
+{
+	m_uploadCount = 0;
+	m_skippedCount = 0;
+}
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderstatecache.h
+// ============
+// remember the location and the last value set into each shader uniform,
+// so that name lookups and uploads of unchanged values can be skipped, for
+// every shader program the scene switches between
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  ShaderStateCache
+ *
+ *  This class sits between the scene code and the shader
+ *  manager. Uniform names are interned once into IDs, and
+ *  the location of each one is looked up once per shader
+ *  program. A value is only uploaded when it is different
+ *  from the one already in the shader. The values are
+ *  shared by all of the programs, so switching to another
+ *  program uploads the values it has not seen yet.
+ ***********************************************************/
+class ShaderStateCache
+{
+public:
+	// constructor
+	ShaderStateCache(ShaderManager* pShaderManager);
+	// destructor
+	~ShaderStateCache();
+
+	// intern a uniform name into an ID for the set methods,
+	// meant to be called at load time rather than per frame
+	int GetUniformID(const char* name);
+	// look up the uniform locations in the shader program that
+	// is currently in use - call after the program is loaded
+	void LoadUniformLocations();
+	// shader program the uniform locations were looked up in
+	GLuint GetProgramID() const { return(m_programID); }
+	// switch to another shader program, looking up its uniform
+	// locations the first time and bringing its values up to date
+	void UseProgram(GLuint programID);
+
+	// set the uniform values into the shader, when changed
+	void setBoolValue(int uniformID, bool value);
+	void setIntValue(int uniformID, int value);
+	void setFloatValue(int uniformID, float value);
+	void setSampler2DValue(int uniformID, int value);
+	void setVec2Value(int uniformID, const glm::vec2& value);
+	void setVec3Value(int uniformID, const glm::vec3& value);
+	void setVec4Value(int uniformID, const glm::vec4& value);
+	void setMat4Value(int uniformID, const glm::mat4& value);
+
+	// set the uniform values by name, for load-time convenience
+	void setBoolValue(const char* name, bool value);
+	void setIntValue(const char* name, int value);
+	void setFloatValue(const char* name, float value);
+	void setSampler2DValue(const char* name, int value);
+	void setVec2Value(const char* name, const glm::vec2& value);
+	void setVec3Value(const char* name, const glm::vec3& value);
+	void setVec3Value(const char* name, float x, float y, float z);
+	void setVec4Value(const char* name, const glm::vec4& value);
+	void setMat4Value(const char* name, const glm::mat4& value);
+
+	// forget all remembered values, needed whenever the shader
+	// uniforms are changed without going through this class
+	void Invalidate();
+
+	// reset the per-frame upload counters
+	void BeginFrame();
+	// number of uniform uploads issued during this frame
+	int GetUploadCount() const { return(m_uploadCount); }
+	// number of uniform uploads skipped during this frame
+	int GetSkippedCount() const { return(m_skippedCount); }
+
+private:
+	// type of a uniform value, to upload it again into other programs
+	enum VALUE_TYPE
+	{
+		VALUE_INT,
+		VALUE_FLOAT,
+		VALUE_VEC2,
+		VALUE_VEC3,
+		VALUE_VEC4,
+		VALUE_MAT4
+	};
+
+	// a uniform value - large enough for a mat4
+	struct UNIFORM_VALUE
+	{
+		unsigned char data[sizeof(glm::mat4)];
+		unsigned int size;
+	};
+
+	// name, type and last set value of a uniform
+	struct CACHED_UNIFORM
+	{
+		std::string name;
+		VALUE_TYPE type;
+		UNIFORM_VALUE value;
+	};
+
+	// location and uploaded value of every uniform in a program
+	struct PROGRAM_UNIFORMS
+	{
+		GLuint programID;
+		std::vector<GLint> locations;
+		std::vector<UNIFORM_VALUE> values;
+	};
+
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// shader program the uniform locations were looked up in
+	GLuint m_programID;
+	// name and last set value of each uniform, by ID
+	std::vector<CACHED_UNIFORM> m_uniforms;
+	// uniform IDs, by name
+	std::unordered_map<std::string, int> m_uniformIDs;
+	// uniforms of every program that has been used, and the
+	// index of the one in use
+	std::vector<PROGRAM_UNIFORMS> m_programs;
+	int m_currentProgram;
+	// uniform uploads issued and skipped during this frame
+	int m_uploadCount;
+	int m_skippedCount;
+
+	// find the uniforms of a program, adding them when it is
+	// used for the first time
+	int FindProgram(GLuint programID);
+	// look up the locations of all the uniforms in a program, and
+	// forget the values it holds
+	void LoadProgramLocations(PROGRAM_UNIFORMS& program);
+	// remember the value of the uniform, and upload it into the
+	// program in use when it does not hold the same value
+	void SetValue(int uniformID, VALUE_TYPE type, const void* value, unsigned int size);
+	// upload the last set value of a uniform into the program in use
+	void UploadValue(int uniformID);
+};
@@ -0,0 +1,420 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compile variants of the scene shader program from the same GLSL source,
+// with the active features injected as defines, and keep the compiled
+// programs on disk so that later startups can skip the GLSL compilation
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+#include "UniformBlocks.h"
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// "PBIN", marks the start of a saved program binary
+	const uint32_t g_BinaryMagic = 0x4E494250;
+}
+
+/***********************************************************
+ *  ShaderVariants()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderVariants::ShaderVariants(UniformBlocks* pUniformBlocks)
+{
+	m_pUniformBlocks = pUniformBlocks;
+	m_compiledCount = 0;
+	m_cachedCount = 0;
+}
+
+/***********************************************************
+ *  ~ShaderVariants()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderVariants::~ShaderVariants()
+{
+	std::map<std::string, GLuint>::iterator program;
+	for (program = m_programs.begin(); program != m_programs.end(); program++)
+	{
+		if (program->second != 0)
+		{
+			glDeleteProgram(program->second);
+		}
+	}
+	m_programs.clear();
+	for (unsigned int i = 0; i < m_retiredPrograms.size(); i++)
+	{
+		glDeleteProgram(m_retiredPrograms[i]);
+	}
+	m_retiredPrograms.clear();
+	m_pUniformBlocks = NULL;
+}
+
+/***********************************************************
+ *  IsBinaryCacheSupported()
+ *
+ *  This method is used for checking whether the driver can
+ *  hand out linked programs and load them back, with at
+ *  least one binary format.
+ ***********************************************************/
+bool ShaderVariants::IsBinaryCacheSupported()
+{
+	if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+	{
+		return(false);
+	}
+
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+	return(formatCount > 0);
+}
+
+/***********************************************************
+ *  LoadSource()
+ *
+ *  This method is used for reading the vertex and fragment
+ *  shader source that all of the variants are compiled
+ *  from. The programs compiled from the previous source are
+ *  kept until the class is destroyed.
+ ***********************************************************/
+bool ShaderVariants::LoadSource(const char* vertexFile, const char* fragmentFile)
+{
+	std::ifstream vertexStream(vertexFile);
+	std::ifstream fragmentStream(fragmentFile);
+	if (!vertexStream.is_open() || !fragmentStream.is_open())
+	{
+		std::cout << "Could not open shader files: " << vertexFile << ", " << fragmentFile << std::endl;
+		return(false);
+	}
+
+	std::stringstream vertexContents;
+	std::stringstream fragmentContents;
+	vertexContents << vertexStream.rdbuf();
+	fragmentContents << fragmentStream.rdbuf();
+	m_vertexSource = vertexContents.str();
+	m_fragmentSource = fragmentContents.str();
+
+	// the variants are compiled again from the new source
+	std::map<std::string, GLuint>::iterator program;
+	for (program = m_programs.begin(); program != m_programs.end(); program++)
+	{
+		if (program->second != 0)
+		{
+			m_retiredPrograms.push_back(program->second);
+		}
+	}
+	m_programs.clear();
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method is used for getting the program of the
+ *  variant with the passed in block of defines. The first
+ *  time a variant is asked for, it is loaded from the
+ *  binary cache, or compiled from the source and saved into
+ *  the cache. Its uniform blocks are connected to their
+ *  binding points either way.
+ ***********************************************************/
+GLuint ShaderVariants::GetProgram(const std::string& defines)
+{
+	std::map<std::string, GLuint>::const_iterator found = m_programs.find(defines);
+	if (found != m_programs.end())
+	{
+		return(found->second);
+	}
+
+	if (m_vertexSource.empty() || m_fragmentSource.empty())
+	{
+		return(0);
+	}
+
+	bool bUseCache = (!m_cachePrefix.empty() && IsBinaryCacheSupported());
+	uint64_t hash = HashVariant(defines);
+	char filename[512];
+	snprintf(filename, sizeof(filename), "%s%016llx.bin", m_cachePrefix.c_str(), (unsigned long long)hash);
+
+	GLuint programID = 0;
+	if (bUseCache == true)
+	{
+		programID = LoadBinary(filename, hash);
+		if (programID != 0)
+		{
+			m_cachedCount++;
+		}
+	}
+	if (programID == 0)
+	{
+		programID = CompileProgram(defines);
+		if ((programID != 0) && (bUseCache == true))
+		{
+			SaveBinary(filename, hash, programID);
+		}
+	}
+
+	if ((programID != 0) && (NULL != m_pUniformBlocks))
+	{
+		m_pUniformBlocks->BindProgram(programID);
+	}
+
+	// failed variants are remembered too, so they are not
+	// compiled again on every draw
+	m_programs[defines] = programID;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling both shader stages
+ *  with the passed in block of defines, and linking them
+ *  into a program that the driver can hand out as a binary.
+ ***********************************************************/
+GLuint ShaderVariants::CompileProgram(const std::string& defines)
+{
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, m_vertexSource, defines);
+	GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, m_fragmentSource, defines);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+	{
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(programID, vertexShader);
+	glAttachShader(programID, fragmentShader);
+	glLinkProgram(programID);
+	glDetachShader(programID, vertexShader);
+	glDetachShader(programID, fragmentShader);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[512];
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not link shader variant:\n" << defines << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	m_compiledCount++;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  CompileShader()
+ *
+ *  This method is used for compiling one shader stage of a
+ *  variant, with the block of defines injected into it.
+ ***********************************************************/
+GLuint ShaderVariants::CompileShader(GLenum type, const std::string& source, const std::string& defines)
+{
+	std::string variantSource = InjectDefines(source, defines);
+	const char* sourceText = variantSource.c_str();
+
+	GLuint shaderID = glCreateShader(type);
+	glShaderSource(shaderID, 1, &sourceText, NULL);
+	glCompileShader(shaderID);
+
+	GLint success = 0;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[512];
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not compile "
+			<< ((type == GL_VERTEX_SHADER) ? "vertex" : "fragment")
+			<< " shader variant:\n" << defines << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  InjectDefines()
+ *
+ *  This method is used for placing the block of defines
+ *  after the #version line, which has to stay the first
+ *  line of the shader. A #line directive follows, so the
+ *  compile errors keep the line numbers of the source file.
+ ***********************************************************/
+std::string ShaderVariants::InjectDefines(const std::string& source, const std::string& defines)
+{
+	size_t lineEnd = 0;
+	size_t version = source.find("#version");
+	if (version != std::string::npos)
+	{
+		lineEnd = source.find('\n', version);
+		lineEnd = (lineEnd == std::string::npos) ? source.size() : lineEnd + 1;
+	}
+
+	// count the lines up to the insertion point
+	int line = 1;
+	for (size_t i = 0; i < lineEnd; i++)
+	{
+		if (source[i] == '\n')
+		{
+			line++;
+		}
+	}
+
+	std::ostringstream result;
+	result << source.substr(0, lineEnd);
+	if ((lineEnd > 0) && (source[lineEnd - 1] != '\n'))
+	{
+		result << "\n";
+	}
+	result << defines << "#line " << line << "\n" << source.substr(lineEnd);
+
+	return(result.str());
+}
+
+/***********************************************************
+ *  HashVariant()
+ *
+ *  This method is used for hashing everything a program
+ *  binary depends on with 64 bit FNV-1a. A driver update or
+ *  an edit of the shader source changes the hash, so stale
+ *  binaries are never loaded back.
+ ***********************************************************/
+uint64_t ShaderVariants::HashVariant(const std::string& defines) const
+{
+	const char* vendor = (const char*)glGetString(GL_VENDOR);
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+
+	std::string parts[6] = {
+		(NULL != vendor) ? vendor : "",
+		(NULL != renderer) ? renderer : "",
+		(NULL != version) ? version : "",
+		m_vertexSource,
+		m_fragmentSource,
+		defines };
+
+	uint64_t hash = 14695981039346656037ULL;
+	for (int i = 0; i < 6; i++)
+	{
+		// the terminating zero keeps the parts apart
+		const char* text = parts[i].c_str();
+		for (size_t j = 0; j <= parts[i].size(); j++)
+		{
+			hash ^= (unsigned char)text[j];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  LoadBinary()
+ *
+ *  This method is used for loading a program from a saved
+ *  program binary. The driver is free to reject a binary it
+ *  saved before, in which case the variant gets compiled
+ *  from source again.
+ ***********************************************************/
+GLuint ShaderVariants::LoadBinary(const std::string& filename, uint64_t hash)
+{
+	MappedFile file;
+	if (file.Open(filename.c_str()) == false)
+	{
+		return(0);
+	}
+
+	BINARY_HEADER header;
+	if (file.GetSize() < sizeof(header))
+	{
+		return(0);
+	}
+	memcpy(&header, file.GetData(), sizeof(header));
+	if ((header.magic != g_BinaryMagic) ||
+		(header.hash != hash) ||
+		(header.length != file.GetSize() - sizeof(header)))
+	{
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, header.format, file.GetData() + sizeof(header), header.length);
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveBinary()
+ *
+ *  This method is used for saving a linked program into the
+ *  binary cache, behind a header holding its format and the
+ *  hash it was saved under.
+ ***********************************************************/
+void ShaderVariants::SaveBinary(const std::string& filename, uint64_t hash, GLuint programID)
+{
+	GLint length = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> binary(length);
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(programID, length, &written, &format, &binary[0]);
+	if (written <= 0)
+	{
+		return;
+	}
+
+	BINARY_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = g_BinaryMagic;
+	header.format = format;
+	header.length = (uint32_t)written;
+	header.hash = hash;
+
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (NULL == file)
+	{
+		std::cout << "Could not write shader binary: " << filename << std::endl;
+		return;
+	}
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(&binary[0], 1, written, file);
+	fclose(file);
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compile variants of the scene shader program from the same GLSL source,
+// with the active features injected as defines, and keep the compiled
+// programs on disk so that later startups can skip the GLSL compilation
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class UniformBlocks;
+
+/***********************************************************
+ *  ShaderVariants
+ *
+ *  This class reads the vertex and fragment shader source
+ *  once, and compiles a program for each block of defines
+ *  it is asked for. The defines are placed right after the
+ *  #version line, so features the variant does not use are
+ *  removed by the compiler instead of being branched over
+ *  for every fragment. When the driver supports program
+ *  binaries, each linked program is saved, and loaded back
+ *  the next time the same variant is asked for.
+ ***********************************************************/
+class ShaderVariants
+{
+public:
+	// constructor
+	ShaderVariants(UniformBlocks* pUniformBlocks);
+	// destructor
+	~ShaderVariants();
+
+	// whether linked programs can be saved and loaded back
+	static bool IsBinaryCacheSupported();
+
+	// read the shader source files the variants are compiled from
+	bool LoadSource(const char* vertexFile, const char* fragmentFile);
+	// start of the file names the program binaries are saved under,
+	// the binary cache is not used when no prefix is set
+	void SetBinaryCachePrefix(const char* prefix) { m_cachePrefix = prefix; }
+
+	// get the program compiled with the passed in block of
+	// defines, compiling it on first use - returns 0 when the
+	// variant cannot be built
+	GLuint GetProgram(const std::string& defines);
+
+	// number of variants compiled from source and loaded from
+	// the binary cache
+	int GetCompiledCount() const { return(m_compiledCount); }
+	int GetCachedCount() const { return(m_cachedCount); }
+
+private:
+	// layout of the header in front of a saved program binary
+	struct BINARY_HEADER
+	{
+		uint32_t magic;
+		uint32_t format;
+		uint32_t length;
+		uint32_t reserved;
+		uint64_t hash;
+	};
+
+	// pointer to the uniform blocks the programs are connected to
+	UniformBlocks* m_pUniformBlocks;
+	// shader source the variants are compiled from
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	// start of the file names of the program binaries
+	std::string m_cachePrefix;
+	// compiled programs, by their block of defines
+	std::map<std::string, GLuint> m_programs;
+	// programs compiled from a previous source, which the callers
+	// may still be using, deleted when the class is destroyed
+	std::vector<GLuint> m_retiredPrograms;
+	// number of variants compiled and loaded from the binary cache
+	int m_compiledCount;
+	int m_cachedCount;
+
+	// compile and link a variant from the shader source
+	GLuint CompileProgram(const std::string& defines);
+	// compile one shader stage of a variant
+	static GLuint CompileShader(GLenum type, const std::string& source, const std::string& defines);
+	// place the block of defines after the #version line
+	static std::string InjectDefines(const std::string& source, const std::string& defines);
+
+	// hash of everything the program binary depends on - the
+	// driver, the shader source and the defines
+	uint64_t HashVariant(const std::string& defines) const;
+	// load a program from the binary cache, 0 when it is missing
+	// or was saved by another driver
+	GLuint LoadBinary(const std::string& filename, uint64_t hash);
+	// save a linked program into the binary cache
+	void SaveBinary(const std::string& filename, uint64_t hash, GLuint programID);
+};
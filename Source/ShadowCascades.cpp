@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowcascades.cpp
+// ============
+// render the scene depth from the directional light into cascaded shadow
+// maps, each one fitted around a slice of the camera view
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowCascades.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// furthest view depth that still receives shadows
+	const float g_ShadowDistance = 30.0f;
+	// blend between logarithmic and even splits of the view depth
+	const float g_SplitLambda = 0.75f;
+	// distance behind each cascade that objects still cast
+	// shadows into it from
+	const float g_ShadowCasterRange = 20.0f;
+}
+
+/***********************************************************
+ *  ShadowCascades()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowCascades::ShadowCascades()
+{
+	m_depthTexture = 0;
+	m_framebuffer = 0;
+	m_resolution = 0;
+	m_previousFramebuffer = 0;
+	m_previousViewport[0] = 0;
+	m_previousViewport[1] = 0;
+	m_previousViewport[2] = 0;
+	m_previousViewport[3] = 0;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_bFitted = false;
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		m_lightViewProjections[i] = glm::mat4(1.0f);
+		m_shadowMatrices[i] = glm::mat4(1.0f);
+	}
+	m_splitDepths = glm::vec4(0.0f);
+}
+
+/***********************************************************
+ *  ~ShadowCascades()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowCascades::~ShadowCascades()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_depthTexture != 0)
+	{
+		glDeleteTextures(1, &m_depthTexture);
+		m_depthTexture = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the depth texture array
+ *  with a layer per cascade, and the framebuffer the layers
+ *  are rendered into. The texture compares against the
+ *  depth it is sampled with, and filters the results of
+ *  neighboring texels, and everything outside of the
+ *  cascades reads as lit.
+ ***********************************************************/
+bool ShadowCascades::CreateTargets(int resolution)
+{
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	glGenTextures(1, &m_depthTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthTexture);
+	glTexImage3D(
+		GL_TEXTURE_2D_ARRAY,
+		0,
+		GL_DEPTH_COMPONENT24,
+		resolution,
+		resolution,
+		SHADOW_CASCADES,
+		0,
+		GL_DEPTH_COMPONENT,
+		GL_FLOAT,
+		NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	const GLfloat border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// only depth is rendered into the framebuffer
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexture, 0, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Could not create the shadow map framebuffer, status " << status << std::endl;
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteTextures(1, &m_depthTexture);
+		m_framebuffer = 0;
+		m_depthTexture = 0;
+		return(false);
+	}
+
+	m_resolution = resolution;
+	m_bFitted = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for splitting the view of the passed
+ *  in camera into a slice per cascade, and fitting the
+ *  light space projection of each cascade around its slice.
+ *  Nothing is done when the camera and the light are the
+ *  same as the last time.
+ ***********************************************************/
+bool ShadowCascades::Update(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& lightDirection)
+{
+	if ((m_bFitted == true) &&
+		(view == m_view) &&
+		(projection == m_projection) &&
+		(lightDirection == m_lightDirection))
+	{
+		return(false);
+	}
+
+	// the near and far distances of the projection, for both
+	// perspective and orthographic projections
+	float nearDistance = 0.1f;
+	float farDistance = 100.0f;
+	if (projection[3][3] == 0.0f)
+	{
+		nearDistance = projection[3][2] / (projection[2][2] - 1.0f);
+		farDistance = projection[3][2] / (projection[2][2] + 1.0f);
+	}
+	else
+	{
+		nearDistance = (projection[3][2] + 1.0f) / projection[2][2];
+		farDistance = (projection[3][2] - 1.0f) / projection[2][2];
+	}
+	nearDistance = std::max(nearDistance, 0.0001f);
+	farDistance = std::max(farDistance, nearDistance * 2.0f);
+	float shadowDistance = std::min(farDistance, nearDistance + g_ShadowDistance);
+
+	// the corners of the view on the near and the far plane,
+	// in world space - every point of a corner ray between them
+	// is at a view depth that is a linear blend of the two
+	glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		float x = (i & 1) ? 1.0f : -1.0f;
+		float y = (i & 2) ? 1.0f : -1.0f;
+		glm::vec4 nearCorner = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farCorner = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+		farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+	}
+
+	m_lightDirection = lightDirection;
+	float sliceStart = nearDistance;
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		// the nearer cascades cover less of the view, so that the
+		// shadow texels are spread evenly over the screen
+		float portion = (float)(i + 1) / SHADOW_CASCADES;
+		float logSplit = nearDistance * pow(shadowDistance / nearDistance, portion);
+		float evenSplit = nearDistance + ((shadowDistance - nearDistance) * portion);
+		float sliceEnd = (g_SplitLambda * logSplit) + ((1.0f - g_SplitLambda) * evenSplit);
+
+		float startBlend = (sliceStart - nearDistance) / (farDistance - nearDistance);
+		float endBlend = (sliceEnd - nearDistance) / (farDistance - nearDistance);
+		glm::vec3 corners[8];
+		for (int j = 0; j < 4; j++)
+		{
+			corners[j] = nearCorners[j] + ((farCorners[j] - nearCorners[j]) * startBlend);
+			corners[j + 4] = nearCorners[j] + ((farCorners[j] - nearCorners[j]) * endBlend);
+		}
+
+		FitCascade(i, corners);
+		m_splitDepths[i] = sliceEnd;
+		sliceStart = sliceEnd;
+	}
+	// the components past the last cascade are never reached
+	for (int i = SHADOW_CASCADES; i < 4; i++)
+	{
+		m_splitDepths[i] = sliceStart;
+	}
+
+	m_view = view;
+	m_projection = projection;
+	m_bFitted = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FitCascade()
+ *
+ *  This method is used for fitting the light space
+ *  projection of a cascade around the bounding sphere of
+ *  its slice of the view. The sphere does not change size
+ *  as the camera turns, and the projection is moved in
+ *  whole texels, so the shadow edges do not shimmer when
+ *  the camera moves.
+ ***********************************************************/
+void ShadowCascades::FitCascade(int cascade, const glm::vec3* corners)
+{
+	glm::vec3 center(0.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		center = center + corners[i];
+	}
+	center = center * (1.0f / 8.0f);
+
+	float radius = 0.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		radius = std::max(radius, glm::length(corners[i] - center));
+	}
+	radius = ceil(radius * 16.0f) / 16.0f;
+
+	glm::vec3 direction = glm::normalize(m_lightDirection);
+	glm::vec3 up = (fabs(direction.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+	// the light looks at the center of the slice from far enough
+	// back to also catch the objects casting shadows into it
+	glm::vec3 eye = center - (direction * (radius + g_ShadowCasterRange));
+	glm::mat4 lightView = glm::lookAt(eye, center, up);
+	glm::mat4 lightProjection = glm::ortho(
+		-radius, radius,
+		-radius, radius,
+		0.0f, (2.0f * radius) + g_ShadowCasterRange);
+
+	// move the projection so the world origin lands on a texel
+	glm::vec4 origin = (lightProjection * lightView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	float texelsX = origin.x * (m_resolution * 0.5f);
+	float texelsY = origin.y * (m_resolution * 0.5f);
+	lightProjection[3][0] += (floor(texelsX + 0.5f) - texelsX) * (2.0f / m_resolution);
+	lightProjection[3][1] += (floor(texelsY + 0.5f) - texelsY) * (2.0f / m_resolution);
+
+	m_lightViewProjections[cascade] = lightProjection * lightView;
+
+	// from clip space into the 0 to 1 range of texture space
+	glm::mat4 textureSpace(0.5f);
+	textureSpace[3] = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+	m_shadowMatrices[cascade] = textureSpace * m_lightViewProjections[cascade];
+}
+
+/***********************************************************
+ *  BeginCascade()
+ *
+ *  This method is used for rendering into the layer of a
+ *  cascade, clearing its depth. The render target is the
+ *  one in use before the first cascade is remembered.
+ ***********************************************************/
+void ShadowCascades::BeginCascade(int cascade)
+{
+	if (cascade == 0)
+	{
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexture, 0, cascade);
+	glViewport(0, 0, m_resolution, m_resolution);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+/***********************************************************
+ *  EndCascades()
+ *
+ *  This method is used for going back to the render target
+ *  and the viewport in use before the first cascade.
+ ***********************************************************/
+void ShadowCascades::EndCascades()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)m_previousFramebuffer);
+	glViewport(
+		m_previousViewport[0],
+		m_previousViewport[1],
+		m_previousViewport[2],
+		m_previousViewport[3]);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding the depth texture array
+ *  to the passed in texture unit.
+ ***********************************************************/
+void ShadowCascades::BindTexture(int unit)
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthTexture);
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowcascades.h
+// ============
+// render the scene depth from the directional light into cascaded shadow
+// maps, each one fitted around a slice of the camera view
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// number of shadow cascades, this value needs to match the one
+// in the shader code
+#define SHADOW_CASCADES 3
+
+/***********************************************************
+ *  ShadowCascades
+ *
+ *  This class splits the camera view into slices by depth,
+ *  the nearer slices being shorter, and fits a light space
+ *  projection around each of them. The depth of the scene
+ *  from the light is rendered into one layer of a depth
+ *  texture array per cascade, which the fragment shader
+ *  compares against with hardware filtering for PCF.
+ ***********************************************************/
+class ShadowCascades
+{
+public:
+	// constructor
+	ShadowCascades();
+	// destructor
+	~ShadowCascades();
+
+	// create the depth texture array and the framebuffer, with
+	// the passed in width and height for every cascade
+	bool CreateTargets(int resolution);
+	bool IsReady() const { return(m_framebuffer != 0); }
+
+	// fit the cascades around the view of the passed in camera,
+	// returns false when nothing changed since the last fitting
+	bool Update(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& lightDirection);
+
+	// render target the depth of a cascade is rendered into
+	void BeginCascade(int cascade);
+	// go back to the render target in use before the first cascade
+	void EndCascades();
+	// bind the depth texture array to the passed in texture unit
+	void BindTexture(int unit);
+
+	// light space transform the depth of a cascade is rendered with
+	const glm::mat4& GetLightViewProjection(int cascade) const { return(m_lightViewProjections[cascade]); }
+	// transforms from world space into the texture space of each
+	// cascade, and the view depths the cascades end at
+	const glm::mat4& GetShadowMatrix(int cascade) const { return(m_shadowMatrices[cascade]); }
+	const glm::vec4& GetSplitDepths() const { return(m_splitDepths); }
+
+private:
+	// depth texture array with a layer per cascade, and the
+	// framebuffer the layers are attached to in turn
+	GLuint m_depthTexture;
+	GLuint m_framebuffer;
+	int m_resolution;
+	// render target and viewport to go back to after the cascades
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+
+	// camera and light the cascades were last fitted for
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	glm::vec3 m_lightDirection;
+	bool m_bFitted;
+
+	// light space transforms and the texture space transforms
+	// of every cascade, and the view depths they end at
+	glm::mat4 m_lightViewProjections[SHADOW_CASCADES];
+	glm::mat4 m_shadowMatrices[SHADOW_CASCADES];
+	glm::vec4 m_splitDepths;
+
+	// fit the light space projection of a cascade around the
+	// corners of its slice of the view
+	void FitCascade(int cascade, const glm::vec3* corners);
+};
@@ -0,0 +1,442 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturebaker.cpp
+// ============
+// bake texture images offline into block compressed DDS files that hold
+// every mipmap level, ready to be uploaded without any decoding
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureBaker.h"
+
+#include "stb_image.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(TextureBaker::DDS_HEADER) == 124, "DDS header must be 124 bytes");
+
+// declaration of global variables
+namespace
+{
+	const uint32_t DDS_MAGIC = 0x20534444;			// "DDS "
+	const uint32_t DDSD_CAPS = 0x1;
+	const uint32_t DDSD_HEIGHT = 0x2;
+	const uint32_t DDSD_WIDTH = 0x4;
+	const uint32_t DDSD_PIXELFORMAT = 0x1000;
+	const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	const uint32_t DDSD_LINEARSIZE = 0x80000;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDSCAPS_COMPLEX = 0x8;
+	const uint32_t DDSCAPS_TEXTURE = 0x1000;
+	const uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+	// pack an 8-bit color into 5:6:5 bits
+	uint16_t PackColor565(int r, int g, int b)
+	{
+		return((uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)));
+	}
+
+	// expand 5:6:5 bits back into an 8-bit color
+	void UnpackColor565(uint16_t color, int rgb[3])
+	{
+		rgb[0] = ((color >> 11) & 0x1F) * 255 / 31;
+		rgb[1] = ((color >> 5) & 0x3F) * 255 / 63;
+		rgb[2] = (color & 0x1F) * 255 / 31;
+	}
+}
+
+/***********************************************************
+ *  GetBakedFilename()
+ *
+ *  This method is used for getting the name of the baked
+ *  file that belongs to an image file.
+ ***********************************************************/
+std::string TextureBaker::GetBakedFilename(const std::string& imageFile)
+{
+	size_t extension = imageFile.find_last_of('.');
+	size_t directory = imageFile.find_last_of("/\\");
+
+	if ((extension == std::string::npos) ||
+		((directory != std::string::npos) && (extension < directory)))
+	{
+		return(imageFile + ".dds");
+	}
+
+	return(imageFile.substr(0, extension) + ".dds");
+}
+
+/***********************************************************
+ *  GetLevelSize()
+ *
+ *  This method is used for getting the number of bytes that
+ *  one mipmap level takes in the passed in format. Levels
+ *  smaller than a block still take a full block.
+ ***********************************************************/
+uint32_t TextureBaker::GetLevelSize(uint32_t fourCC, uint32_t width, uint32_t height)
+{
+	uint32_t blockSize = (fourCC == FOURCC_DXT1) ? 8 : 16;
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+
+	if (blocksWide < 1)
+		blocksWide = 1;
+	if (blocksHigh < 1)
+		blocksHigh = 1;
+
+	return(blocksWide * blocksHigh * blockSize);
+}
+
+/***********************************************************
+ *  BakeTexture()
+ *
+ *  This method is used for reading an image file, building
+ *  its full mipmap chain and writing all of the levels block
+ *  compressed into a DDS file. The image is flipped the same
+ *  way as when it is loaded directly, so the baked texture
+ *  maps onto the meshes exactly like the original.
+ ***********************************************************/
+bool TextureBaker::BakeTexture(const char* imageFile, const char* bakedFile)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// always expand to RGBA, the source channel count decides
+	// whether the alpha needs to be kept
+	unsigned char* image = stbi_load(imageFile, &width, &height, &colorChannels, 4);
+	if (NULL == image)
+	{
+		std::cout << "Could not load image:" << imageFile << std::endl;
+		return(false);
+	}
+
+	bool bWithAlpha = false;
+	if (colorChannels == 4)
+	{
+		for (int i = 0; (i < width * height) && (bWithAlpha == false); i++)
+		{
+			bWithAlpha = (image[(i * 4) + 3] != 255);
+		}
+	}
+	uint32_t fourCC = bWithAlpha ? FOURCC_DXT5 : FOURCC_DXT1;
+
+	std::vector<unsigned char> level(image, image + (width * height * 4));
+	stbi_image_free(image);
+
+	FILE* file = fopen(bakedFile, "wb");
+	if (NULL == file)
+	{
+		std::cout << "Could not write baked texture:" << bakedFile << std::endl;
+		return(false);
+	}
+
+	// one level per halving of the larger dimension, down to 1x1
+	uint32_t mipMapCount = 1;
+	for (int size = (width > height) ? width : height; size > 1; size /= 2)
+	{
+		mipMapCount++;
+	}
+
+	DDS_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = height;
+	header.width = width;
+	header.pitchOrLinearSize = GetLevelSize(fourCC, width, height);
+	header.mipMapCount = mipMapCount;
+	header.pixelFormat.size = sizeof(DDS_PIXELFORMAT);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = fourCC;
+	header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	fwrite(&DDS_MAGIC, sizeof(DDS_MAGIC), 1, file);
+	fwrite(&header, sizeof(header), 1, file);
+
+	int levelWidth = width;
+	int levelHeight = height;
+	std::vector<unsigned char> blocks;
+	std::vector<unsigned char> nextLevel;
+	for (uint32_t i = 0; i < mipMapCount; i++)
+	{
+		CompressLevel(level.data(), levelWidth, levelHeight, bWithAlpha, blocks);
+		fwrite(blocks.data(), 1, blocks.size(), file);
+
+		if (i + 1 < mipMapCount)
+		{
+			int nextWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+			int nextHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+
+			DownsampleImage(level, levelWidth, levelHeight, nextLevel, nextWidth, nextHeight);
+			level.swap(nextLevel);
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+	}
+
+	bool bSuccess = (ferror(file) == 0);
+	fclose(file);
+
+	if (bSuccess)
+	{
+		std::cout << "Baked texture:" << bakedFile << ", width:" << width << ", height:" << height
+			<< ", levels:" << mipMapCount << ", format:" << (bWithAlpha ? "BC3" : "BC1") << std::endl;
+	}
+	else
+	{
+		std::cout << "Could not write baked texture:" << bakedFile << std::endl;
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  DownsampleImage()
+ *
+ *  This method is used for averaging each 2x2 group of
+ *  pixels into one pixel of the next mipmap level. Edges of
+ *  odd sized images reuse the last row or column.
+ ***********************************************************/
+void TextureBaker::DownsampleImage(
+	const std::vector<unsigned char>& source,
+	int width,
+	int height,
+	std::vector<unsigned char>& target,
+	int targetWidth,
+	int targetHeight)
+{
+	target.resize(targetWidth * targetHeight * 4);
+
+	for (int y = 0; y < targetHeight; y++)
+	{
+		int y0 = y * 2;
+		int y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+		if (y0 >= height)
+			y0 = y1 = height - 1;
+
+		for (int x = 0; x < targetWidth; x++)
+		{
+			int x0 = x * 2;
+			int x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+			if (x0 >= width)
+				x0 = x1 = width - 1;
+
+			for (int c = 0; c < 4; c++)
+			{
+				int sum = source[((y0 * width) + x0) * 4 + c] +
+					source[((y0 * width) + x1) * 4 + c] +
+					source[((y1 * width) + x0) * 4 + c] +
+					source[((y1 * width) + x1) * 4 + c];
+				target[((y * targetWidth) + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CompressLevel()
+ *
+ *  This method is used for splitting an image level into
+ *  4x4 blocks and compressing each one. Blocks that hang
+ *  over the edge of the image repeat the edge pixels.
+ ***********************************************************/
+void TextureBaker::CompressLevel(
+	const unsigned char* pixels,
+	int width,
+	int height,
+	bool bWithAlpha,
+	std::vector<unsigned char>& blocks)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	int blockSize = bWithAlpha ? 16 : 8;
+
+	blocks.resize(blocksWide * blocksHigh * blockSize);
+
+	unsigned char block[64];
+	unsigned char* output = blocks.data();
+	for (int by = 0; by < blocksHigh; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			for (int py = 0; py < 4; py++)
+			{
+				int y = (by * 4) + py;
+				if (y >= height)
+					y = height - 1;
+
+				for (int px = 0; px < 4; px++)
+				{
+					int x = (bx * 4) + px;
+					if (x >= width)
+						x = width - 1;
+
+					memcpy(&block[((py * 4) + px) * 4], &pixels[((y * width) + x) * 4], 4);
+				}
+			}
+
+			if (bWithAlpha)
+			{
+				CompressAlphaBlock(block, output);
+				output += 8;
+			}
+			CompressColorBlock(block, output);
+			output += 8;
+		}
+	}
+}
+
+/***********************************************************
+ *  CompressColorBlock()
+ *
+ *  This method is used for compressing the colors of a 4x4
+ *  block. The end points are the corners of the bounding box
+ *  of the block colors, and every pixel picks the closest of
+ *  the four colors interpolated between them.
+ ***********************************************************/
+void TextureBaker::CompressColorBlock(const unsigned char block[64], unsigned char* output)
+{
+	int minColor[3] = { 255, 255, 255 };
+	int maxColor[3] = { 0, 0, 0 };
+
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int value = block[(i * 4) + c];
+			if (value < minColor[c])
+				minColor[c] = value;
+			if (value > maxColor[c])
+				maxColor[c] = value;
+		}
+	}
+
+	// pull the end points in a little, which lowers the error
+	// of the pixels in between them
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	uint16_t color0 = PackColor565(maxColor[0], maxColor[1], maxColor[2]);
+	uint16_t color1 = PackColor565(minColor[0], minColor[1], minColor[2]);
+	// the four color mode is selected by the first end point
+	// being the larger one
+	if (color0 < color1)
+	{
+		uint16_t swap = color0;
+		color0 = color1;
+		color1 = swap;
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int palette[4][3];
+		UnpackColor565(color0, palette[0]);
+		UnpackColor565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = ((2 * palette[0][c]) + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + (2 * palette[1][c])) / 3;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			int bestError = 0x7FFFFFFF;
+			for (int p = 0; p < 4; p++)
+			{
+				int error = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					int delta = block[(i * 4) + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= (uint32_t)bestIndex << (i * 2);
+		}
+	}
+
+	// the block is stored little endian
+	output[0] = (unsigned char)(color0 & 0xFF);
+	output[1] = (unsigned char)(color0 >> 8);
+	output[2] = (unsigned char)(color1 & 0xFF);
+	output[3] = (unsigned char)(color1 >> 8);
+	output[4] = (unsigned char)(indices & 0xFF);
+	output[5] = (unsigned char)((indices >> 8) & 0xFF);
+	output[6] = (unsigned char)((indices >> 16) & 0xFF);
+	output[7] = (unsigned char)((indices >> 24) & 0xFF);
+}
+
+/***********************************************************
+ *  CompressAlphaBlock()
+ *
+ *  This method is used for compressing the alpha values of
+ *  a 4x4 block, between the smallest and the largest alpha
+ *  value with eight interpolated steps.
+ ***********************************************************/
+void TextureBaker::CompressAlphaBlock(const unsigned char block[64], unsigned char* output)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+
+	for (int i = 0; i < 16; i++)
+	{
+		int alpha = block[(i * 4) + 3];
+		if (alpha < minAlpha)
+			minAlpha = alpha;
+		if (alpha > maxAlpha)
+			maxAlpha = alpha;
+	}
+
+	uint64_t indices = 0;
+	if (maxAlpha != minAlpha)
+	{
+		// the eight step mode is selected by the first end
+		// point being the larger one
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int p = 1; p < 7; p++)
+		{
+			palette[p + 1] = (((7 - p) * maxAlpha) + (p * minAlpha)) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int alpha = block[(i * 4) + 3];
+			int bestIndex = 0;
+			int bestError = 256;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = (alpha > palette[p]) ? alpha - palette[p] : palette[p] - alpha;
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= (uint64_t)bestIndex << (i * 3);
+		}
+	}
+
+	output[0] = (unsigned char)maxAlpha;
+	output[1] = (unsigned char)minAlpha;
+	for (int i = 0; i < 6; i++)
+	{
+		output[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturebaker.h
+// ============
+// bake texture images offline into block compressed DDS files that hold
+// every mipmap level, ready to be uploaded without any decoding
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureBaker
+ *
+ *  This class converts an image file into a DDS file. The
+ *  mipmap chain is built on the CPU with a box filter, and
+ *  every level is compressed to BC1 (opaque images) or BC3
+ *  (images with transparency).
+ ***********************************************************/
+class TextureBaker
+{
+public:
+	// four character codes of the supported DDS formats
+	static const uint32_t FOURCC_DXT1 = 0x31545844;		// "DXT1" - BC1
+	static const uint32_t FOURCC_DXT5 = 0x35545844;		// "DXT5" - BC3
+
+	// layout of the DDS file header, which follows the
+	// four byte "DDS " magic number
+	struct DDS_PIXELFORMAT
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+	struct DDS_HEADER
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		DDS_PIXELFORMAT pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	// bake an image file into a DDS file
+	static bool BakeTexture(const char* imageFile, const char* bakedFile);
+	// name of the baked file for an image file - same name, .dds extension
+	static std::string GetBakedFilename(const std::string& imageFile);
+	// size in bytes of one compressed mipmap level
+	static uint32_t GetLevelSize(uint32_t fourCC, uint32_t width, uint32_t height);
+
+private:
+	// shrink an RGBA8 image to half its size with a box filter
+	static void DownsampleImage(
+		const std::vector<unsigned char>& source,
+		int width,
+		int height,
+		std::vector<unsigned char>& target,
+		int targetWidth,
+		int targetHeight);
+	// compress an RGBA8 image level into 4x4 blocks
+	static void CompressLevel(
+		const unsigned char* pixels,
+		int width,
+		int height,
+		bool bWithAlpha,
+		std::vector<unsigned char>& blocks);
+	// compress the colors of one 4x4 block to a BC1 block
+	static void CompressColorBlock(const unsigned char block[64], unsigned char* output);
+	// compress the alpha of one 4x4 block to a BC3 alpha block
+	static void CompressAlphaBlock(const unsigned char block[64], unsigned char* output);
+};
@@ -0,0 +1,584 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode texture images on worker threads and upload them to OpenGL in the
+// background, while placeholder textures are drawn in their place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+#include "TextureBaker.h"
+#include "MappedFile.h"
+
+#include "stb_image.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// neutral grey shown until the real image is uploaded
+	const unsigned char g_PlaceholderPixel[4] = { 128, 128, 128, 255 };
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader(ThreadPool* pThreadPool)
+{
+	m_pThreadPool = pThreadPool;
+	m_pixelBuffer = 0;
+	m_requestedCount = 0;
+	m_processedCount = 0;
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	// the decode jobs write into this object, so they need
+	// to be finished before it goes away
+	if (NULL != m_pThreadPool)
+	{
+		m_pThreadPool->WaitIdle();
+	}
+	m_pThreadPool = NULL;
+
+	for (unsigned int i = 0; i < m_decodedImages.size(); i++)
+	{
+		if (NULL != m_decodedImages[i].pixels)
+		{
+			stbi_image_free(m_decodedImages[i].pixels);
+		}
+	}
+	m_decodedImages.clear();
+
+	if (m_pixelBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_pixelBuffer);
+		m_pixelBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  LoadTexture()
+ *
+ *  This method is used for loading the baked DDS file of an
+ *  image file when one exists. Otherwise a texture object
+ *  holding the placeholder image is created, and the image
+ *  file is queued to be decoded on a worker thread. The
+ *  returned texture can be bound and drawn with right away.
+ ***********************************************************/
+GLuint TextureLoader::LoadTexture(const char* filename)
+{
+	// a baked texture needs no decoding, so it is ready right away
+	GLuint textureID = LoadBakedTexture(TextureBaker::GetBakedFilename(filename).c_str());
+	if (textureID != 0)
+	{
+		return(textureID);
+	}
+
+	GLint boundTexture = 0;
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &boundTexture);
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, g_PlaceholderPixel);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)boundTexture);
+
+	// the flip setting is shared by all threads, so it is set
+	// here on the GL thread before any decode job is started
+	stbi_set_flip_vertically_on_load(true);
+
+	std::string imageFile = filename;
+	m_requestedCount++;
+	m_pThreadPool->Submit([this, imageFile, textureID]()
+		{
+			DecodeImage(imageFile, textureID);
+		});
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  LoadBakedTexture()
+ *
+ *  This method is used for mapping a baked DDS file and
+ *  passing each of its compressed mipmap levels straight
+ *  from the mapped memory to OpenGL.
+ ***********************************************************/
+GLuint TextureLoader::LoadBakedTexture(const char* bakedFile)
+{
+	// without support for the compressed formats, the image
+	// file has to be decoded instead
+	if (!GLEW_EXT_texture_compression_s3tc)
+	{
+		return(0);
+	}
+
+	MappedFile file;
+	if (file.Open(bakedFile) == false)
+	{
+		return(0);
+	}
+
+	const size_t headerSize = sizeof(uint32_t) + sizeof(TextureBaker::DDS_HEADER);
+	if (file.GetSize() < headerSize)
+	{
+		std::cout << "Ignoring damaged baked texture:" << bakedFile << std::endl;
+		return(0);
+	}
+
+	uint32_t magic = 0;
+	TextureBaker::DDS_HEADER header;
+	memcpy(&magic, file.GetData(), sizeof(magic));
+	memcpy(&header, file.GetData() + sizeof(magic), sizeof(header));
+
+	GLenum internalFormat = 0;
+	if (header.pixelFormat.fourCC == TextureBaker::FOURCC_DXT1)
+		internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	else if (header.pixelFormat.fourCC == TextureBaker::FOURCC_DXT5)
+		internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+	if ((magic != 0x20534444) || (header.size != sizeof(header)) || (internalFormat == 0) ||
+		(header.width == 0) || (header.height == 0))
+	{
+		std::cout << "Not implemented to handle baked texture:" << bakedFile << std::endl;
+		return(0);
+	}
+
+	uint32_t levelCount = (header.mipMapCount > 0) ? header.mipMapCount : 1;
+
+	// make sure every level is inside of the file before
+	// anything is handed to OpenGL
+	size_t totalSize = headerSize;
+	uint32_t width = header.width;
+	uint32_t height = header.height;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		totalSize += TextureBaker::GetLevelSize(header.pixelFormat.fourCC, width, height);
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+	if (file.GetSize() < totalSize)
+	{
+		std::cout << "Ignoring damaged baked texture:" << bakedFile << std::endl;
+		return(0);
+	}
+
+	GLuint textureID = 0;
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &boundTexture);
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters - the baked mipmaps are used
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+	const unsigned char* levelData = file.GetData() + headerSize;
+	width = header.width;
+	height = header.height;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		GLsizei levelSize = TextureBaker::GetLevelSize(header.pixelFormat.fourCC, width, height);
+
+		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, width, height, 1, 0, levelSize, levelData);
+
+		levelData += levelSize;
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)boundTexture);
+
+	std::cout << "Successfully loaded baked texture:" << bakedFile << ", width:" << header.width << ", height:" << header.height << ", levels:" << levelCount << std::endl;
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for parsing the image data from the
+ *  image file. It runs on a worker thread, so it only hands
+ *  the decoded image over to the GL thread.
+ ***********************************************************/
+void TextureLoader::DecodeImage(const std::string& filename, GLuint textureID)
+{
+	DECODED_IMAGE image;
+	image.filename = filename;
+	image.textureID = textureID;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+
+	// try to parse the image data from the specified image file
+	image.pixels = stbi_load(
+		filename.c_str(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		0);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_decodedImages.push_back(image);
+}
+
+/***********************************************************
+ *  ProcessUploads()
+ *
+ *  This method is used for uploading the images that have
+ *  been decoded since the last call. The number of uploads
+ *  per call is limited, so a frame never stalls on several
+ *  large images at once.
+ ***********************************************************/
+int TextureLoader::ProcessUploads(int maxUploads)
+{
+	if (GetPendingCount() == 0)
+	{
+		return(0);
+	}
+
+	std::vector<DECODED_IMAGE> images;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		int uploadCount = (int)m_decodedImages.size();
+		if ((maxUploads > 0) && (uploadCount > maxUploads))
+		{
+			uploadCount = maxUploads;
+		}
+		images.assign(m_decodedImages.begin(), m_decodedImages.begin() + uploadCount);
+		m_decodedImages.erase(m_decodedImages.begin(), m_decodedImages.begin() + uploadCount);
+	}
+
+	int uploaded = 0;
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		if (NULL != images[i].pixels)
+		{
+			UploadImage(images[i]);
+			stbi_image_free(images[i].pixels);
+			uploaded++;
+		}
+		else
+		{
+			// the placeholder stays in the texture
+			std::cout << "Could not load image:" << images[i].filename << std::endl;
+		}
+		m_processedCount++;
+	}
+
+	return(uploaded);
+}
+
+/***********************************************************
+ *  FinishAll()
+ *
+ *  This method is used for waiting for all of the queued
+ *  images to be decoded, and uploading all of them.
+ ***********************************************************/
+void TextureLoader::FinishAll()
+{
+	m_pThreadPool->WaitIdle();
+	ProcessUploads(0);
+}
+
+/***********************************************************
+ *  UploadImage()
+ *
+ *  This method is used for copying a decoded image into the
+ *  pixel buffer object, and filling the texture object from
+ *  that buffer, so that the driver can do the transfer
+ *  without another copy of the image data.
+ ***********************************************************/
+void TextureLoader::UploadImage(const DECODED_IMAGE& image)
+{
+	GLenum internalFormat = GL_RGB8;
+	GLenum format = GL_RGB;
+
+	// if the loaded image is in RGB format
+	if (image.colorChannels == 3)
+	{
+		internalFormat = GL_RGB8;
+		format = GL_RGB;
+	}
+	// if the loaded image is in RGBA format - it supports transparency
+	else if (image.colorChannels == 4)
+	{
+		internalFormat = GL_RGBA8;
+		format = GL_RGBA;
+	}
+	else
+	{
+		std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+		return;
+	}
+
+	std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+	GLsizeiptr imageSize = (GLsizeiptr)image.width * image.height * image.colorChannels;
+	const void* pixelSource = image.pixels;
+
+	if (m_pixelBuffer == 0)
+	{
+		glGenBuffers(1, &m_pixelBuffer);
+	}
+
+	// orphan the previous contents, so the copy does not wait
+	// for the last upload from the buffer to complete
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, imageSize, NULL, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		imageSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+	if (NULL != mapped)
+	{
+		memcpy(mapped, image.pixels, imageSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		// the texture is now read from offset zero of the buffer
+		pixelSource = NULL;
+	}
+	else
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &boundTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, image.textureID);
+
+	// the rows of RGB images are not padded to four bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, image.width, image.height, 1, 0, format, GL_UNSIGNED_BYTE, pixelSource);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)boundTexture);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/***********************************************************
+ *  GetTextureFormat()
+ *
+ *  This method is used for reading the size, the format and
+ *  the number of mipmap levels of a single layer texture
+ *  array.
+ ***********************************************************/
+TextureLoader::TEXTURE_FORMAT TextureLoader::GetTextureFormat(GLuint textureID)
+{
+	TEXTURE_FORMAT format;
+	GLint maxLevel = 0;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_WIDTH, &format.width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_HEIGHT, &format.height);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_INTERNAL_FORMAT, &format.internalFormat);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_COMPRESSED, &format.bCompressed);
+	glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+
+	// the full mipmap chain, unless the texture was limited
+	// to fewer levels when it was loaded
+	format.levels = 1;
+	for (int size = (format.width > format.height) ? format.width : format.height; size > 1; size /= 2)
+	{
+		format.levels++;
+	}
+	if (maxLevel + 1 < format.levels)
+	{
+		format.levels = maxLevel + 1;
+	}
+
+	return(format);
+}
+
+/***********************************************************
+ *  CopyTextureLayer()
+ *
+ *  This method is used for copying every mipmap level of a
+ *  single layer texture array into a layer of the target
+ *  texture array. The copy stays on the GPU when copy image
+ *  is supported, otherwise the levels are read back.
+ ***********************************************************/
+void TextureLoader::CopyTextureLayer(
+	GLuint sourceID,
+	GLuint targetID,
+	int layer,
+	const TEXTURE_FORMAT& format)
+{
+	bool bCopyImage = (GLEW_VERSION_4_3 || GLEW_ARB_copy_image);
+	std::vector<unsigned char> levelData;
+
+	GLint width = format.width;
+	GLint height = format.height;
+	for (GLint level = 0; level < format.levels; level++)
+	{
+		if (bCopyImage)
+		{
+			glCopyImageSubData(
+				sourceID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				targetID, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+				width, height, 1);
+		}
+		else if (format.bCompressed)
+		{
+			GLint levelSize = 0;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, sourceID);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelSize);
+			levelData.resize(levelSize);
+			glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, level, levelData.data());
+
+			glBindTexture(GL_TEXTURE_2D_ARRAY, targetID);
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+				format.internalFormat, levelSize, levelData.data());
+		}
+		else
+		{
+			levelData.resize(width * height * 4);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, sourceID);
+			glGetTexImage(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, GL_UNSIGNED_BYTE, levelData.data());
+
+			glBindTexture(GL_TEXTURE_2D_ARRAY, targetID);
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, levelData.data());
+		}
+
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+}
+
+/***********************************************************
+ *  PackTextureArrays()
+ *
+ *  This method is used for packing the textures that share
+ *  the same size, format and number of mipmap levels into
+ *  one texture array each. The packed textures are deleted,
+ *  and the passed in IDs are replaced by the texture array
+ *  and the layer that now holds each of them. Textures
+ *  without a match are left as they are, in layer zero.
+ ***********************************************************/
+void TextureLoader::PackTextureArrays(std::vector<GLuint>& textureIDs, std::vector<int>& layers)
+{
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &boundTexture);
+
+	std::vector<TEXTURE_FORMAT> formats;
+	for (unsigned int i = 0; i < textureIDs.size(); i++)
+	{
+		formats.push_back(GetTextureFormat(textureIDs[i]));
+	}
+
+	layers.assign(textureIDs.size(), 0);
+	std::vector<unsigned char> bPacked(textureIDs.size(), 0);
+
+	for (unsigned int i = 0; i < textureIDs.size(); i++)
+	{
+		if (bPacked[i] != 0)
+		{
+			continue;
+		}
+
+		const TEXTURE_FORMAT& format = formats[i];
+		std::vector<unsigned int> group;
+		for (unsigned int j = i; j < textureIDs.size(); j++)
+		{
+			if ((bPacked[j] == 0) &&
+				(formats[j].width == format.width) &&
+				(formats[j].height == format.height) &&
+				(formats[j].internalFormat == format.internalFormat) &&
+				(formats[j].levels == format.levels))
+			{
+				group.push_back(j);
+				bPacked[j] = 1;
+			}
+		}
+
+		if (group.size() < 2)
+		{
+			continue;
+		}
+
+		GLuint arrayID = 0;
+		glGenTextures(1, &arrayID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, format.levels - 1);
+
+		// allocate every level with room for all of the layers
+		GLint width = format.width;
+		GLint height = format.height;
+		GLsizei layerCount = (GLsizei)group.size();
+		for (GLint level = 0; level < format.levels; level++)
+		{
+			if (format.bCompressed)
+			{
+				GLint levelSize = 0;
+				glBindTexture(GL_TEXTURE_2D_ARRAY, textureIDs[i]);
+				glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelSize);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+				glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat,
+					width, height, layerCount, 0, levelSize * layerCount, NULL);
+			}
+			else
+			{
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat,
+					width, height, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			}
+
+			width = (width > 1) ? width / 2 : 1;
+			height = (height > 1) ? height / 2 : 1;
+		}
+
+		for (unsigned int layer = 0; layer < group.size(); layer++)
+		{
+			unsigned int index = group[layer];
+
+			CopyTextureLayer(textureIDs[index], arrayID, layer, format);
+			glDeleteTextures(1, &textureIDs[index]);
+
+			textureIDs[index] = arrayID;
+			layers[index] = layer;
+		}
+
+		std::cout << "Packed " << group.size() << " textures of " << format.width << "x" << format.height
+			<< " into one texture array" << std::endl;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)boundTexture);
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode texture images on worker threads and upload them to OpenGL in the
+// background, while placeholder textures are drawn in their place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <GL/glew.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class hands out texture objects right away, filled
+ *  with a small placeholder image. The image files are
+ *  decoded on the worker threads of the thread pool, and
+ *  the decoded images are uploaded through a pixel buffer
+ *  object on the GL thread, a few per frame, into the same
+ *  texture objects. Textures that have been baked into
+ *  compressed DDS files skip all of that and are uploaded
+ *  straight from the mapped file. Every texture is created
+ *  as a texture array with a single layer, so that textures
+ *  of the same size can be packed together later on.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// constructor
+	TextureLoader(ThreadPool* pThreadPool);
+	// destructor
+	~TextureLoader();
+
+	// load the baked version of an image file when there is
+	// one, otherwise create a texture holding the placeholder
+	// image and queue the image file to be decoded
+	GLuint LoadTexture(const char* filename);
+	// upload up to the passed in number of decoded images,
+	// returns the number of textures that were uploaded
+	int ProcessUploads(int maxUploads);
+	// block until every queued texture has been uploaded
+	void FinishAll();
+	// pack the loaded textures that have the same size and
+	// format into shared texture arrays, the passed in IDs are
+	// replaced and the layer of each texture is filled in
+	void PackTextureArrays(std::vector<GLuint>& textureIDs, std::vector<int>& layers);
+
+	// number of textures that are still showing the placeholder
+	int GetPendingCount() const { return(m_requestedCount - m_processedCount); }
+
+private:
+	// image decoded by a worker thread, waiting for upload
+	struct DECODED_IMAGE
+	{
+		std::string filename;
+		GLuint textureID;
+		unsigned char* pixels;
+		int width;
+		int height;
+		int colorChannels;
+	};
+
+	// pointer to the thread pool running the decode jobs
+	ThreadPool* m_pThreadPool;
+	// pixel buffer object used for staging the uploads
+	GLuint m_pixelBuffer;
+	// decoded images waiting for upload, filled by the workers
+	std::vector<DECODED_IMAGE> m_decodedImages;
+	// guards the decoded images
+	std::mutex m_mutex;
+	// textures queued and textures finished, on the GL thread
+	int m_requestedCount;
+	int m_processedCount;
+
+	// upload the mipmap levels of a baked DDS file, returns
+	// zero when there is no usable baked file
+	GLuint LoadBakedTexture(const char* bakedFile);
+	// decode an image file, run on a worker thread
+	void DecodeImage(const std::string& filename, GLuint textureID);
+	// upload a decoded image into its texture object
+	void UploadImage(const DECODED_IMAGE& image);
+
+	// size and format of a texture, to find the ones that can
+	// share a texture array
+	struct TEXTURE_FORMAT
+	{
+		GLint width;
+		GLint height;
+		GLint internalFormat;
+		GLint bCompressed;
+		GLint levels;
+	};
+	// read the size and format of a single layer texture array
+	static TEXTURE_FORMAT GetTextureFormat(GLuint textureID);
+	// copy every level of a single layer texture array into
+	// a layer of a larger texture array
+	static void CopyTextureLayer(GLuint sourceID, GLuint targetID, int layer, const TEXTURE_FORMAT& format);
+};
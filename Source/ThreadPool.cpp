@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+// threadpool.cpp
+// ============
+// run background jobs on a fixed set of worker threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  ThreadPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ThreadPool::ThreadPool(int workerCount)
+{
+	m_pendingJobs = 0;
+	m_bStopping = false;
+	m_parallel.pFunction = NULL;
+	m_parallel.pJob = NULL;
+	m_parallel.count = 0;
+	m_parallel.chunkSize = 0;
+	m_parallel.chunkCount = 0;
+	m_parallel.nextChunk = 0;
+	m_parallel.bActive = false;
+	m_parallel.helperCount = 0;
+
+	if (workerCount <= 0)
+	{
+		// leave one hardware thread for the render loop
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+		if (workerCount < 1)
+		{
+			workerCount = 1;
+		}
+	}
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~ThreadPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ThreadPool::~ThreadPool()
+{
+	// let the queued jobs finish before the workers exit
+	WaitIdle();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobReady.notify_all();
+
+	for (unsigned int i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a job for the next
+ *  worker thread that becomes available.
+ ***********************************************************/
+void ThreadPool::Submit(const std::function<void()>& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+		m_pendingJobs++;
+	}
+	m_jobReady.notify_one();
+}
+
+/***********************************************************
+ *  GetChunkCount()
+ *
+ *  This method is used for getting the number of chunks of
+ *  the passed in size a range of elements is split into.
+ ***********************************************************/
+int ThreadPool::GetChunkCount(int count, int chunkSize)
+{
+	if ((count <= 0) || (chunkSize <= 0))
+	{
+		return(0);
+	}
+
+	return((count + chunkSize - 1) / chunkSize);
+}
+
+/***********************************************************
+ *  RunParallel()
+ *
+ *  This method is used for running the job of a
+ *  ParallelFor() call over a range of elements split into
+ *  chunks. The calling thread takes chunks as well, and
+ *  waits only for the chunks of this call - not for the
+ *  other queued jobs - so it never stalls behind a long
+ *  background job, it just does more of the chunks itself.
+ *  The call is published to the workers in place, without
+ *  queueing a job, so nothing is allocated. A range of a
+ *  single chunk is run on the calling thread directly.
+ ***********************************************************/
+void ThreadPool::RunParallel(
+	int count,
+	int chunkSize,
+	CHUNK_FUNCTION pFunction,
+	const void* pJob)
+{
+	int chunkCount = GetChunkCount(count, chunkSize);
+	if (chunkCount == 0)
+	{
+		return;
+	}
+	if ((chunkCount == 1) || (m_workers.size() == 0))
+	{
+		for (int chunk = 0; chunk < chunkCount; chunk++)
+		{
+			pFunction(pJob, chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_parallel.pFunction = pFunction;
+		m_parallel.pJob = pJob;
+		m_parallel.count = count;
+		m_parallel.chunkSize = chunkSize;
+		m_parallel.chunkCount = chunkCount;
+		m_parallel.nextChunk = 0;
+		m_parallel.helperCount = 0;
+		m_parallel.bActive = true;
+	}
+	// wake up no more workers than there are chunks for
+	int helperCount = std::min((int)m_workers.size(), chunkCount - 1);
+	for (int i = 0; i < helperCount; i++)
+	{
+		m_jobReady.notify_one();
+	}
+
+	RunChunks();
+
+	// every chunk is taken, the ones still running belong to the
+	// helpers, and no worker joins once the call is inactive
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_parallel.bActive = false;
+	m_parallelDone.wait(lock, [this]() { return(m_parallel.helperCount == 0); });
+}
+
+/***********************************************************
+ *  HasParallelChunks()
+ *
+ *  This method is used for checking whether a worker can
+ *  help with a ParallelFor() call, which is the case while
+ *  the call is active and has chunks that nobody has taken.
+ ***********************************************************/
+bool ThreadPool::HasParallelChunks() const
+{
+	return((m_parallel.bActive == true) && (m_parallel.nextChunk < m_parallel.chunkCount));
+}
+
+/***********************************************************
+ *  RunChunks()
+ *
+ *  This method is used for taking the next chunk of the
+ *  ParallelFor() call and running the job on it, until all
+ *  of the chunks are taken.
+ ***********************************************************/
+void ThreadPool::RunChunks()
+{
+	while (true)
+	{
+		int chunk = m_parallel.nextChunk.fetch_add(1);
+		if (chunk >= m_parallel.chunkCount)
+		{
+			return;
+		}
+
+		m_parallel.pFunction(
+			m_parallel.pJob,
+			chunk,
+			chunk * m_parallel.chunkSize,
+			std::min(m_parallel.count, (chunk + 1) * m_parallel.chunkSize));
+	}
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used for blocking the calling thread until
+ *  all of the queued jobs have finished running.
+ ***********************************************************/
+void ThreadPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this]() { return(m_pendingJobs == 0); });
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by every worker thread. It helps with
+ *  the ParallelFor() call in progress, or else takes the
+ *  next job from the queue and runs it, until the pool is
+ *  stopping.
+ ***********************************************************/
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobReady.wait(lock, [this]()
+				{
+					return(m_bStopping || HasParallelChunks() || (m_jobs.size() > 0));
+				});
+
+			// the chunks of a ParallelFor() call go ahead of the
+			// queued jobs, since a frame is waiting on them
+			if (HasParallelChunks())
+			{
+				m_parallel.helperCount++;
+				lock.unlock();
+
+				RunChunks();
+
+				lock.lock();
+				m_parallel.helperCount--;
+				if (m_parallel.helperCount == 0)
+				{
+					m_parallelDone.notify_all();
+				}
+				continue;
+			}
+
+			if (m_jobs.size() == 0)
+			{
+				// the chunks that woke the worker can all have been
+				// taken by the calling thread, so it only exits once
+				// the pool is stopping
+				if (m_bStopping)
+				{
+					return;
+				}
+				continue;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		job();
+
+		bool bIdle = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pendingJobs--;
+			bIdle = (m_pendingJobs == 0);
+		}
+		if (bIdle)
+		{
+			m_idle.notify_all();
+		}
+	}
+}
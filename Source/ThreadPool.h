@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// threadpool.h
+// ============
+// run background jobs on a fixed set of worker threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  ThreadPool
+ *
+ *  This class starts a fixed number of worker threads that
+ *  take jobs from a shared queue. Jobs must not make any
+ *  OpenGL calls, since the GL context belongs to the main
+ *  thread.
+ ***********************************************************/
+class ThreadPool
+{
+public:
+	// constructor - zero workers picks one less than the
+	// number of hardware threads, but at least one
+	ThreadPool(int workerCount = 0);
+	// destructor
+	~ThreadPool();
+
+	// queue a job to run on one of the worker threads
+	void Submit(const std::function<void()>& job);
+	// block until every queued job has finished running
+	void WaitIdle();
+
+	// split the range from 0 to count into chunks of the passed in
+	// size, and run the job on every chunk with its index and its
+	// first and last (exclusive) element, in parallel - returns once
+	// every chunk is done. The job is called as job(chunk, first,
+	// last) and is not copied, so nothing is allocated per call.
+	// Only one thread at a time may call it.
+	template <typename JOB>
+	void ParallelFor(int count, int chunkSize, const JOB& job)
+	{
+		RunParallel(count, chunkSize, &CallJob<JOB>, &job);
+	}
+	// number of chunks ParallelFor() splits a range into
+	static int GetChunkCount(int count, int chunkSize);
+
+	// number of worker threads
+	int GetWorkerCount() const { return((int)m_workers.size()); }
+
+private:
+	// worker threads
+	std::vector<std::thread> m_workers;
+	// jobs that have not been started yet
+	std::deque<std::function<void()>> m_jobs;
+	// number of jobs queued or running
+	int m_pendingJobs;
+	// set when the workers need to exit
+	bool m_bStopping;
+	// guards the job queue and the counters
+	std::mutex m_mutex;
+	// signalled when a job is queued or the pool is stopping
+	std::condition_variable m_jobReady;
+	// signalled when the last pending job finishes
+	std::condition_variable m_idle;
+
+	// calls the job of a ParallelFor() call on a chunk
+	typedef void (*CHUNK_FUNCTION)(const void* pJob, int chunk, int first, int last);
+
+	// the ParallelFor() call in progress, which the workers take
+	// chunks of ahead of the queued jobs
+	struct PARALLEL_FOR
+	{
+		CHUNK_FUNCTION pFunction;
+		const void* pJob;
+		int count;
+		int chunkSize;
+		int chunkCount;
+		std::atomic<int> nextChunk;
+		bool bActive;
+		// workers running chunks, the call returns once it is zero
+		int helperCount;
+	};
+	PARALLEL_FOR m_parallel;
+	// signalled when the last helper of the call is done
+	std::condition_variable m_parallelDone;
+
+	// loop run by each worker thread
+	void WorkerLoop();
+	// whether the ParallelFor() call in progress has chunks left,
+	// called with the mutex locked
+	bool HasParallelChunks() const;
+	// run the job of a ParallelFor() call on every chunk
+	void RunParallel(int count, int chunkSize, CHUNK_FUNCTION pFunction, const void* pJob);
+	// run chunks of the ParallelFor() call until none are left
+	void RunChunks();
+
+	// call a job of the type it was passed in with
+	template <typename JOB>
+	static void CallJob(const void* pJob, int chunk, int first, int last)
+	{
+		(*(const JOB*)pJob)(chunk, first, last);
+	}
+};
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.cpp
+// ============
+// manage the uniform buffer objects shared by the shader programs - camera,
+// lights, materials
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBlocks.h"
+#include "RingBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+// the structures must match the std140 layout in the shader code exactly
+static_assert(sizeof(UniformBlocks::CAMERA_BLOCK) == 144, "CameraBlock does not match std140");
+static_assert(sizeof(UniformBlocks::LIGHT_SOURCE) == 64, "DirectionalLight does not match std140");
+static_assert(sizeof(UniformBlocks::SPOT_LIGHT) == 96, "SpotLight does not match std140");
+static_assert(sizeof(UniformBlocks::LIGHT_BLOCK) == 64 + (64 * TOTAL_POINT_LIGHTS) + 96, "LightBlock does not match std140");
+static_assert(sizeof(UniformBlocks::MATERIAL) == 32, "Material does not match std140");
+
+// declaration of global variables
+namespace
+{
+	const char* g_CameraBlockName = "CameraBlock";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_MaterialBlockName = "MaterialBlock";
+}
+
+/***********************************************************
+ *  UniformBlocks()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformBlocks::UniformBlocks()
+{
+	m_buffers[0] = 0;
+	m_buffers[1] = 0;
+	m_buffers[2] = 0;
+	m_camera = CAMERA_BLOCK();
+	m_bCameraValid = false;
+	m_pRingBuffer = NULL;
+}
+
+/***********************************************************
+ *  ~UniformBlocks()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformBlocks::~UniformBlocks()
+{
+	if (m_buffers[0] != 0)
+	{
+		glDeleteBuffers(3, m_buffers);
+		m_buffers[0] = 0;
+		m_buffers[1] = 0;
+		m_buffers[2] = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the uniform buffers at
+ *  their full size and attaching each one to its binding
+ *  point, where every shader program can find it.
+ ***********************************************************/
+void UniformBlocks::CreateBuffers()
+{
+	glGenBuffers(3, m_buffers);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[CAMERA_BINDING]);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CAMERA_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[LIGHT_BINDING]);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LIGHT_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[MATERIAL_BINDING]);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(MATERIAL) * MAX_OBJECT_MATERIALS, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, m_buffers[CAMERA_BINDING]);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BINDING, m_buffers[LIGHT_BINDING]);
+	glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, m_buffers[MATERIAL_BINDING]);
+
+	m_bCameraValid = false;
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for connecting the uniform blocks
+ *  declared in a shader program to the binding points of
+ *  the uniform buffers. Blocks the program does not use
+ *  are skipped.
+ ***********************************************************/
+void UniformBlocks::BindProgram(GLuint programID)
+{
+	const char* blockNames[3] = { g_CameraBlockName, g_LightBlockName, g_MaterialBlockName };
+
+	for (GLuint binding = 0; binding < 3; binding++)
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(programID, blockNames[binding]);
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(programID, blockIndex, binding);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method is used for uploading the view, projection
+ *  and camera position with a single buffer upload, when
+ *  any of them changed since the last frame. With a ring
+ *  buffer, the block is written into the region of every
+ *  frame instead, since the regions take turns.
+ ***********************************************************/
+void UniformBlocks::SetCamera(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	CAMERA_BLOCK camera = CAMERA_BLOCK();
+	camera.view = view;
+	camera.projection = projection;
+	camera.viewPosition = viewPosition;
+
+	m_camera = camera;
+	m_bCameraValid = true;
+
+	RingBuffer::ALLOCATION allocation;
+	if ((NULL != m_pRingBuffer) && (m_pRingBuffer->Allocate(sizeof(camera), allocation) == true))
+	{
+		memcpy(allocation.pData, &camera, sizeof(camera));
+		m_pRingBuffer->Commit();
+		glBindBufferRange(
+			GL_UNIFORM_BUFFER,
+			CAMERA_BINDING,
+			m_pRingBuffer->GetBuffer(),
+			allocation.offset,
+			allocation.size);
+		return;
+	}
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, m_buffers[CAMERA_BINDING]);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[CAMERA_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(camera), &camera);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for uploading all of the scene
+ *  light sources with a single buffer upload.
+ ***********************************************************/
+void UniformBlocks::SetLights(const LIGHT_BLOCK& lights)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[LIGHT_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHT_BLOCK), &lights);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetMaterials()
+ *
+ *  This method is used for uploading the material table
+ *  with a single buffer upload. Draws then only need to
+ *  pass the index of their material into the shader.
+ ***********************************************************/
+void UniformBlocks::SetMaterials(const MATERIAL* materials, int materialCount)
+{
+	if (materialCount > MAX_OBJECT_MATERIALS)
+	{
+		std::cout << "Only the first " << MAX_OBJECT_MATERIALS << " of "
+			<< materialCount << " materials fit in the material table" << std::endl;
+		materialCount = MAX_OBJECT_MATERIALS;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[MATERIAL_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(MATERIAL) * materialCount, materials);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.h
+// ============
+// manage the uniform buffer objects shared by the shader programs - camera,
+// lights, materials
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+class RingBuffer;
+
+// these values need to match the ones in the shader code
+#define TOTAL_POINT_LIGHTS 5
+#define MAX_OBJECT_MATERIALS 32
+
+/***********************************************************
+ *  UniformBlocks
+ *
+ *  This class owns the uniform buffers for the per-frame
+ *  camera data, the scene lights and the material table.
+ *  The structures below mirror the std140 uniform blocks
+ *  declared in the shader code, so each block is updated
+ *  with a single buffer upload. With a ring buffer, the
+ *  camera block is written into the region of each frame.
+ ***********************************************************/
+class UniformBlocks
+{
+public:
+	// constructor
+	UniformBlocks();
+	// destructor
+	~UniformBlocks();
+
+	// binding points of the uniform blocks
+	enum BLOCK_BINDING
+	{
+		CAMERA_BINDING = 0,
+		LIGHT_BINDING = 1,
+		MATERIAL_BINDING = 2
+	};
+
+	// std140 layout of the CameraBlock uniform block
+	struct CAMERA_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPosition;
+		float padding;
+	};
+
+	// std140 layout of the DirectionalLight and PointLight structures
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 vector;		// direction or position
+		float padding0;
+		glm::vec3 ambient;
+		float padding1;
+		glm::vec3 diffuse;
+		float padding2;
+		glm::vec3 specular;
+		int bActive;
+	};
+
+	// std140 layout of the SpotLight structure
+	struct SPOT_LIGHT
+	{
+		glm::vec3 position;
+		float padding0;
+		glm::vec3 direction;
+		float cutOff;
+		float outerCutOff;
+		float constant;
+		float linear;
+		float quadratic;
+		glm::vec3 ambient;
+		float padding1;
+		glm::vec3 diffuse;
+		float padding2;
+		glm::vec3 specular;
+		int bActive;
+	};
+
+	// std140 layout of the LightBlock uniform block
+	struct LIGHT_BLOCK
+	{
+		LIGHT_SOURCE directionalLight;
+		LIGHT_SOURCE pointLights[TOTAL_POINT_LIGHTS];
+		SPOT_LIGHT spotLight;
+	};
+
+	// std140 layout of the Material structure
+	struct MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		float shininess;
+		glm::vec3 specularColor;
+		float padding;
+	};
+
+	// create the uniform buffers and attach them to their binding points
+	void CreateBuffers();
+	// connect the uniform blocks of a shader program to the binding points
+	void BindProgram(GLuint programID);
+	// write the camera block of every frame into the ring buffer
+	void SetRingBuffer(RingBuffer* pRingBuffer) { m_pRingBuffer = pRingBuffer; }
+
+	// upload the uniform block data
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	void SetLights(const LIGHT_BLOCK& lights);
+	void SetMaterials(const MATERIAL* materials, int materialCount);
+
+	// last uploaded camera data
+	const CAMERA_BLOCK& GetCamera() const { return(m_camera); }
+
+private:
+	// handles for the camera, light and material uniform buffers
+	GLuint m_buffers[3];
+	// last uploaded camera data, to skip unchanged uploads
+	CAMERA_BLOCK m_camera;
+	bool m_bCameraValid;
+	// per-frame allocator the camera block is written into
+	RingBuffer* m_pRingBuffer;
+};
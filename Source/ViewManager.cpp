@@ -1,269 +1,479 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.cpp
-// ============
-// manage the viewing of 3D objects within the viewport - camera, projection
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
-	g_pCamera->MovementSpeed = 20;
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	// tell GLFW to capture all mouse events
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	// this callback is used to receive mouse scroll events
-	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	// when the first mouse move event is received, this needs to be recorded so that
-	// all subsequent mouse moves can correctly calculate the X position offset and Y
-	// position offset for proper operation
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-	}
-
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
-
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-}
-
-/***********************************************************
-*  Mouse_Scroll_Callback()
-*
-*  This method is automatically called from GLFW whenever
-*  the mouse wheel is moved within the active GLFW display window.
-************************************************************/
-
-void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-	g_pCamera->ProcessMouseScroll(yoffset);
-}
-
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-
-	// process camera moving vertically up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-
-	// process changing projection between perpective and orthographic
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
-	{
-		bOrthographicProjection = false;
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
-	{
-		bOrthographicProjection = true;
-	}
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projectionPerspective;
-	glm::mat4 projectionOrtho;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	// define the projection matrices
-	projectionPerspective = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-	projectionOrtho = glm::ortho(-10.0f, 10.0f, -10.0f, 5.0f, 0.1f, 100.0f);
-
-	
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the projection matrix into the shader for proper rendering
-		if (!bOrthographicProjection)
-		{
-			m_pShaderManager->setMat4Value(g_ProjectionName, projectionPerspective);
-		}
-		else
-		{
-			m_pShaderManager->setMat4Value(g_ProjectionName, projectionOrtho);
-		}
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
-	
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.cpp
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+
+#include <algorithm>
+
+// declaration of the global variables and defines
+namespace
+{
+	// size the window is created at unless told otherwise
+	const int DEFAULT_WINDOW_WIDTH = 1000;
+	const int DEFAULT_WINDOW_HEIGHT = 800;
+
+	// Variables for window width and height, and the size of its
+	// framebuffer in pixels, which is kept up to date on resizes
+	int gWindowWidth = DEFAULT_WINDOW_WIDTH;
+	int gWindowHeight = DEFAULT_WINDOW_HEIGHT;
+	int gFramebufferWidth = DEFAULT_WINDOW_WIDTH;
+	int gFramebufferHeight = DEFAULT_WINDOW_HEIGHT;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = DEFAULT_WINDOW_WIDTH / 2.0f;
+	float gLastY = DEFAULT_WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// time of the update step the camera is being moved by
+	float gDeltaTime = 0.0f; 
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+
+	// the following variable is false while the camera is driven
+	// by a script instead of the keyboard and mouse
+	bool gInputEnabled = true;
+
+	// the following variable is true when the camera changed outside
+	// of the keyboard processing, such as from the mouse callbacks
+	bool gViewChanged = true;
+
+	// keys the keyboard processing reacts to
+	const int g_ViewKeys[] =
+	{
+		GLFW_KEY_ESCAPE, GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D,
+		GLFW_KEY_Q, GLFW_KEY_E, GLFW_KEY_P, GLFW_KEY_O, GLFW_KEY_F3
+	};
+	const int g_ViewKeyCount = sizeof(g_ViewKeys) / sizeof(g_ViewKeys[0]);
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(
+	ShaderManager *pShaderManager,
+	ShaderStateCache* pShaderState,
+	UniformBlocks* pUniformBlocks)
+{
+	// initialize the member variables
+	m_pShaderManager = pShaderManager;
+	m_pShaderState = pShaderState;
+	m_pWindow = NULL;
+	m_pUniformBlocks = pUniformBlocks;
+	m_bShowProfiler = false;
+	m_bProfilerKeyDown = false;
+	g_pCamera = new Camera();
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
+	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 80;
+	g_pCamera->MovementSpeed = 20;
+	m_previousPosition = g_pCamera->Position;
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderManager = NULL;
+	m_pShaderState = NULL;
+	m_pUniformBlocks = NULL;
+	m_pWindow = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		gWindowWidth,
+		gWindowHeight,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// tell GLFW to capture all mouse events
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// this callback is used to receive mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	// this callback is used to receive mouse scroll events
+	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+
+	// this callback is used to receive the size of the framebuffer
+	// when the window is resized, the size can differ from the size
+	// of the window on high density displays
+	glfwGetFramebufferSize(window, &gFramebufferWidth, &gFramebufferHeight);
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+
+	// blending stays off, every object of the scene is opaque and
+	// blending them only costs fill rate
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  SetHiddenWindow()
+ *
+ *  This method is used to create the display window that is
+ *  created next without showing it on the screen.
+ ***********************************************************/
+void ViewManager::SetHiddenWindow(bool bHidden)
+{
+	glfwWindowHint(GLFW_VISIBLE, bHidden ? GLFW_FALSE : GLFW_TRUE);
+}
+
+/***********************************************************
+ *  SetWindowSize()
+ *
+ *  This method is used to set the size of the display window
+ *  that is created next.
+ ***********************************************************/
+void ViewManager::SetWindowSize(int width, int height)
+{
+	if ((width > 0) && (height > 0))
+	{
+		gWindowWidth = width;
+		gWindowHeight = height;
+	}
+}
+
+/***********************************************************
+ *  GetFramebufferSize()
+ *
+ *  This method is used to get the size of the framebuffer of
+ *  the display window in pixels, which is zero while the
+ *  window is minimized.
+ ***********************************************************/
+void ViewManager::GetFramebufferSize(int& width, int& height) const
+{
+	width = gFramebufferWidth;
+	height = gFramebufferHeight;
+}
+
+/***********************************************************
+ *  SetInputEnabled()
+ *
+ *  This method is used to turn the keyboard and mouse control
+ *  of the camera on or off.
+ ***********************************************************/
+void ViewManager::SetInputEnabled(bool bEnabled)
+{
+	gInputEnabled = bEnabled;
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used to place the camera and to point it
+ *  in a direction, such as from a recorded camera path.
+ ***********************************************************/
+void ViewManager::SetCameraPose(const glm::vec3& position, const glm::vec3& front)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Front = glm::normalize(front);
+	// a placed camera is not blended from where it was before
+	m_previousPosition = position;
+	gViewChanged = true;
+}
+
+/***********************************************************
+ *  IsInputActive()
+ *
+ *  This method is used to check whether any of the keys the
+ *  keyboard processing reacts to is held down. The profiler
+ *  key also counts until its release has been seen, so that
+ *  the next press toggles the overlay again.
+ ***********************************************************/
+bool ViewManager::IsInputActive() const
+{
+	if ((gInputEnabled == false) || (NULL == m_pWindow))
+	{
+		return(false);
+	}
+
+	if (m_bProfilerKeyDown == true)
+	{
+		return(true);
+	}
+	for (int i = 0; i < g_ViewKeyCount; i++)
+	{
+		if (glfwGetKey(m_pWindow, g_ViewKeys[i]) == GLFW_PRESS)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ConsumeViewChanged()
+ *
+ *  This method is used to check whether the camera was moved
+ *  by the mouse or placed since the last check.
+ ***********************************************************/
+bool ViewManager::ConsumeViewChanged()
+{
+	bool bChanged = gViewChanged;
+	gViewChanged = false;
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  GetCameraPose()
+ *
+ *  This method is used to get the position of the camera and
+ *  the direction it is looking in.
+ ***********************************************************/
+void ViewManager::GetCameraPose(glm::vec3& position, glm::vec3& front) const
+{
+	position = g_pCamera->Position;
+	front = g_pCamera->Front;
+}
+
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the framebuffer of the display window is resized. The
+ *  projection follows the new aspect ratio in the next frame.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* /*window*/, int width, int height)
+{
+	gFramebufferWidth = width;
+	gFramebufferHeight = height;
+	gViewChanged = true;
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	if (gInputEnabled == false)
+	{
+		return;
+	}
+
+	// when the first mouse move event is received, this needs to be recorded so that
+	// all subsequent mouse moves can correctly calculate the X position offset and Y
+	// position offset for proper operation
+	if (gFirstMouse)
+	{
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+	}
+
+	// calculate the X offset and Y offset values for moving the 3D camera accordingly
+	float xOffset = xMousePos - gLastX;
+	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+
+	// set the current positions into the last position variables
+	gLastX = xMousePos;
+	gLastY = yMousePos;
+
+	// move the 3D camera according to the calculated offsets
+	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+	if ((xOffset != 0.0f) || (yOffset != 0.0f))
+	{
+		gViewChanged = true;
+	}
+}
+
+/***********************************************************
+*  Mouse_Scroll_Callback()
+*
+*  This method is automatically called from GLFW whenever
+*  the mouse wheel is moved within the active GLFW display window.
+************************************************************/
+
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	if (gInputEnabled == false)
+	{
+		return;
+	}
+
+	g_pCamera->ProcessMouseScroll(yoffset);
+	gViewChanged = true;
+}
+
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	// close the window if the escape key has been pressed
+	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// process camera zooming in and out
+	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+	}
+
+	// process camera panning left and right
+	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+	}
+
+	// process camera moving vertically up and down
+	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+	}
+
+	// process changing projection between perpective and orthographic
+	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+	{
+		bOrthographicProjection = false;
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	{
+		bOrthographicProjection = true;
+	}
+
+	// toggle the profiler overlay once each time the key goes down
+	bool bProfilerKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_PRESS);
+	if ((bProfilerKeyDown == true) && (m_bProfilerKeyDown == false))
+	{
+		m_bShowProfiler = !m_bShowProfiler;
+	}
+	m_bProfilerKeyDown = bProfilerKeyDown;
+}
+
+/***********************************************************
+ *  UpdateCamera()
+ *
+ *  This method is used for the update stage of the frame
+ *  loop, which runs at a fixed timestep - the keyboard
+ *  state is processed and moves the camera by the passed in
+ *  seconds, whatever the frame rate is.
+ ***********************************************************/
+void ViewManager::UpdateCamera(float seconds)
+{
+	m_previousPosition = g_pCamera->Position;
+	gDeltaTime = seconds;
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	if (gInputEnabled == true)
+	{
+		ProcessKeyboardEvents();
+	}
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering. The camera position is blended between the
+ *  last two update steps, so the movement is smooth when
+ *  the frames are not in step with the updates. The mouse
+ *  changes the direction between frames, so it is used as is.
+ ***********************************************************/
+void ViewManager::PrepareSceneView(float interpolation)
+{
+	glm::mat4 view;
+	glm::mat4 projectionPerspective;
+	glm::mat4 projectionOrtho;
+
+	// get the current view matrix from the camera, at the
+	// interpolated position
+	glm::vec3 position = glm::mix(m_previousPosition, g_pCamera->Position, interpolation);
+	view = glm::lookAt(position, position + g_pCamera->Front, g_pCamera->Up);
+
+	// define the projection matrices, with the aspect ratio of the
+	// window as it is now
+	GLfloat aspectRatio = (GLfloat)std::max(gFramebufferWidth, 1) / (GLfloat)std::max(gFramebufferHeight, 1);
+	projectionPerspective = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
+	projectionOrtho = glm::ortho(-10.0f, 10.0f, -10.0f, 5.0f, 0.1f, 100.0f);
+
+	
+
+	// if the uniform blocks object is valid
+	if (NULL != m_pUniformBlocks)
+	{
+		// set the view matrix, the projection matrix and the view
+		// position of the camera into the shared camera block
+		if (!bOrthographicProjection)
+		{
+			m_pUniformBlocks->SetCamera(view, projectionPerspective, position);
+		}
+		else
+		{
+			m_pUniformBlocks->SetCamera(view, projectionOrtho, position);
+		}
+	}
+	
 }
\ No newline at end of file
@@ -1,48 +1,96 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport - camera, projection
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "camera.h"
-
-// GLFW library
-#include "GLFW/glfw3.h" 
-
-class ViewManager
-{
-public:
-	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
-	// destructor
-	~ViewManager();
-
-	// mouse position callback for mouse interaction with the 3D scene
-	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// active OpenGL display window
-	GLFWwindow* m_pWindow;
-
-	// process mouse scroll callback for mouse wheel interaction with the 3D scene
-	static void Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
-
-	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
-
-public:
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
-	
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShaderStateCache.h"
+#include "UniformBlocks.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderManager* pShaderManager,
+		ShaderStateCache* pShaderState,
+		UniformBlocks* pUniformBlocks);
+	// destructor
+	~ViewManager();
+
+	// mouse position callback for mouse interaction with the 3D scene
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// framebuffer size callback for following the resizes of the window
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to the uniform state cache in front of the shader manager
+	ShaderStateCache* m_pShaderState;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// pointer to the uniform buffers shared by the shader programs
+	UniformBlocks* m_pUniformBlocks;
+	// whether the profiler overlay is shown, and whether its key
+	// was held down in the last frame
+	bool m_bShowProfiler;
+	bool m_bProfilerKeyDown;
+	// position of the camera before the last update step, which the
+	// rendered position is interpolated from
+	glm::vec3 m_previousPosition;
+
+	// process mouse scroll callback for mouse wheel interaction with the 3D scene
+	static void Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
+
+	// process keyboard events for interaction with the 3D scene
+	void ProcessKeyboardEvents();
+
+public:
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	
+	// move the camera by the keyboard input over one fixed timestep
+	void UpdateCamera(float seconds);
+	// prepare the conversion from 3D object display to 2D scene display,
+	// with the camera the passed in fraction of the way from its
+	// position before the last update step to its current position
+	void PrepareSceneView(float interpolation = 1.0f);
+
+	// whether the profiler overlay was toggled on with the F3 key
+	bool IsProfilerShown() const { return(m_bShowProfiler); }
+
+	// create the display window without showing it, for rendering
+	// into an offscreen target
+	void SetHiddenWindow(bool bHidden);
+	// set the size of the display window that is created next
+	void SetWindowSize(int width, int height);
+	// get the size of the framebuffer of the display window in
+	// pixels, as of its latest resize
+	void GetFramebufferSize(int& width, int& height) const;
+	// turn the keyboard and mouse control of the camera on or off,
+	// for a camera driven by a script
+	void SetInputEnabled(bool bEnabled);
+
+	// whether a key the view reacts to is held down, so frames have
+	// to keep being rendered for it
+	bool IsInputActive() const;
+	// whether the mouse or a placement changed the camera since the
+	// last call, clearing the change
+	bool ConsumeViewChanged();
+
+	// set and get the position of the camera and the direction it
+	// is looking in
+	void SetCameraPose(const glm::vec3& position, const glm::vec3& front);
+	void GetCameraPose(glm::vec3& position, glm::vec3& front) const;
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#version 430 core
+// one invocation per instance of the scene
+layout (local_size_x = 64) in;
+
+// levels of detail of each batch, must match MESH_LOD_LEVELS
+#define MESH_LOD_LEVELS 3
+
+// one level of detail of a batch of the draw list, with the object
+// space bounds of its mesh and the number of levels the batch has
+struct CullBatch {
+    uint count;
+    uint firstIndex;
+    int baseVertex;
+    uint firstInstance;
+    uint instanceCount;
+    uint lodCount;
+    uint padding1;
+    uint padding2;
+    vec4 boundsMin;
+    vec4 boundsMax;
+};
+
+// layout of a command as read by glMultiDrawElementsIndirect
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+// model matrices and draw values of all the instances
+layout (std430, binding = 0) readonly buffer InstanceMatrices
+{
+    mat4 instanceMatrices[];
+};
+layout (std430, binding = 1) readonly buffer InstanceData
+{
+    ivec2 instanceData[];
+};
+// batch of the draw list each instance belongs to
+layout (std430, binding = 2) readonly buffer InstanceBatches
+{
+    uint instanceBatches[];
+};
+layout (std430, binding = 3) readonly buffer CullBatches
+{
+    CullBatch batches[];
+};
+// one command per level of each batch, the instance counts start at zero
+layout (std430, binding = 4) buffer DrawCommands
+{
+    DrawCommand commands[];
+};
+// the surviving instances, packed at the start of their batch
+layout (std430, binding = 5) writeonly buffer CulledMatrices
+{
+    mat4 culledMatrices[];
+};
+layout (std430, binding = 6) writeonly buffer CulledData
+{
+    ivec2 culledData[];
+};
+
+// level of detail each instance was last drawn with
+layout (std430, binding = 7) buffer InstanceLods
+{
+    uint instanceLods[];
+};
+
+// total number of surviving instances, for the frame statistics
+layout (binding = 0, offset = 0) uniform atomic_uint visibleCount;
+
+// left, right, bottom, top, near and far planes of the camera
+uniform vec4 frustumPlanes[6];
+uniform uint instanceCount;
+// projected size of an instance is its radius times the scale over
+// its clip space w, and a level is left once the size has moved past
+// its threshold by the hysteresis fraction
+uniform mat4 viewProjection;
+uniform float lodScale;
+uniform vec2 lodThresholds;
+uniform float lodHysteresis;
+
+// pick the level of detail for a projected size, starting from the
+// level used last so that sizes near a threshold do not flicker
+uint SelectLod(float size, uint lod, uint lodCount)
+{
+    lod = min(lod, lodCount - 1u);
+    while((lod > 0u) && (size > lodThresholds[lod - 1u] * (1.0f + lodHysteresis)))
+    {
+        lod--;
+    }
+    while((lod + 1u < lodCount) && (size < lodThresholds[lod] * (1.0f - lodHysteresis)))
+    {
+        lod++;
+    }
+    return lod;
+}
+
+void main()
+{
+    uint instance = gl_GlobalInvocationID.x;
+    if(instance >= instanceCount)
+    {
+        return;
+    }
+
+    uint batchIndex = instanceBatches[instance] * MESH_LOD_LEVELS;
+    mat4 modelMatrix = instanceMatrices[instance];
+
+    // transform the object space box of the mesh into a world space box
+    vec3 center = (batches[batchIndex].boundsMin.xyz + batches[batchIndex].boundsMax.xyz) * 0.5f;
+    vec3 halfSize = (batches[batchIndex].boundsMax.xyz - batches[batchIndex].boundsMin.xyz) * 0.5f;
+    vec3 worldCenter = vec3(modelMatrix * vec4(center, 1.0f));
+    vec3 worldHalfSize = (abs(modelMatrix[0].xyz) * halfSize.x) +
+        (abs(modelMatrix[1].xyz) * halfSize.y) +
+        (abs(modelMatrix[2].xyz) * halfSize.z);
+
+    // the box is outside when it is entirely behind any of the planes
+    for(int i = 0; i < 6; i++)
+    {
+        vec4 plane = frustumPlanes[i];
+        if(dot(plane.xyz, worldCenter) + dot(abs(plane.xyz), worldHalfSize) + plane.w < 0.0f)
+        {
+            return;
+        }
+    }
+
+    // the coarser levels of the batch follow its finest one
+    float clipW = max((viewProjection * vec4(worldCenter, 1.0f)).w, 0.0001f);
+    float size = length(worldHalfSize) * lodScale / clipW;
+    uint lod = SelectLod(size, instanceLods[instance], batches[batchIndex].lodCount);
+    instanceLods[instance] = lod;
+    batchIndex += lod;
+
+    // claim the next slot of the batch and copy the instance into it
+    uint slot = atomicAdd(commands[batchIndex].instanceCount, 1u);
+    uint target = batches[batchIndex].firstInstance + slot;
+    culledMatrices[target] = modelMatrix;
+    culledData[target] = instanceData[instance];
+
+    atomicCounterIncrement(visibleCount);
+}
@@ -1,228 +1,360 @@
-#version 330 core
-out vec4 fragmentColor;
-
-in vec3 fragmentPosition;
-in vec3 fragmentVertexNormal;
-in vec2 fragmentTextureCoordinate;
-
-struct Material {
-    vec3 diffuseColor;
-    vec3 specularColor;
-    float shininess;
-}; 
-
-struct DirectionalLight {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    bool bActive;
-};
-
-struct PointLight {
-    vec3 position;
-    
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    bool bActive;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;       
-
-    bool bActive;
-};
-
-#define TOTAL_POINT_LIGHTS 5
-
-uniform bool bUseTexture=false;
-uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform vec3 viewPosition;
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
-uniform SpotLight spotLight;
-uniform Material material;
-uniform sampler2D objectTexture;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-
-// the scaled texture coordinate to use in calculations
-vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
-
-// function prototypes
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-
-void main()
-{   
-    if(bUseLighting == true)
-    {
-        vec3 phongResult = vec3(0.0f);
-        // properties
-        vec3 norm = normalize(fragmentVertexNormal);
-        vec3 viewDir = normalize(viewPosition - fragmentPosition);
-    
-        // == =====================================================
-        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
-        // For each phase, a calculate function is defined that calculates the corresponding color
-        // per light source. In the main() function we take all the calculated colors and sum them 
-        // up for this fragment's final color.
-        // == =====================================================
-        // phase 1: directional lighting
-        if(directionalLight.bActive == true)
-        {
-            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
-        }
-        // phase 2: point lights
-        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
-        {
-	    if(pointLights[i].bActive == true)
-            {
-                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
-            }
-        } 
-        // phase 3: spot light
-        if(spotLight.bActive == true)
-        {
-            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir);    
-        }
-    
-        if(bUseTexture == true)
-        {
-            fragmentColor = vec4(phongResult, (texture(objectTexture, fragmentTextureCoordinateScaled)).a);
-        }
-        else
-        {
-            fragmentColor = vec4(phongResult, objectColor.a);
-        }
-    }
-    else
-    {
-        if(bUseTexture == true)
-        {
-            fragmentColor = texture(objectTexture, fragmentTextureCoordinateScaled);
-        }
-        else
-        {
-            fragmentColor = objectColor;
-        }
-    }
-}
-
-// calculates the color when using a directional light.
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
-
-    vec3 lightDirection = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDirection), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDirection, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
-    }
-    
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular= vec3(0.0f);
-
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    // Calculate specular component
-    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-   
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * specularComponent * material.specularColor;
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * specularComponent * material.specularColor;
-    }
-    
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
-
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
-    }
-    
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
+#version 330 core
+out vec4 fragmentColor;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+// material index and texture layer of the drawn object
+flat in int fragmentMaterialIndex;
+flat in int fragmentTextureLayer;
+
+struct Material {
+    vec3 diffuseColor;
+    float shininess;
+    vec3 specularColor;
+}; 
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+
+#define TOTAL_POINT_LIGHTS 5
+#define MAX_OBJECT_MATERIALS 32
+// the view is divided into screen tiles and depth slices for the
+// clustered lighting, these need to match LightClusters
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+// number of shadow cascades, this needs to match ShadowCascades
+#define SHADOW_CASCADES 3
+
+// per-frame camera data shared by all shader programs
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
+
+// scene light sources, uploaded once when they change
+layout (std140) uniform LightBlock
+{
+    DirectionalLight directionalLight;
+    PointLight pointLights[TOTAL_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+// table of all the defined object materials
+layout (std140) uniform MaterialBlock
+{
+    Material materials[MAX_OBJECT_MATERIALS];
+};
+
+// the variants compiled with SHADER_VARIANT defined have their
+// features as constants, so the compiler removes the branches on them
+#ifdef SHADER_VARIANT
+const bool bUseTexture = (VARIANT_TEXTURE != 0);
+const bool bUseLighting = (VARIANT_LIGHTING != 0);
+const bool bUseClusteredLighting = (VARIANT_CLUSTERED_LIGHTING != 0);
+const bool bUseShadows = (VARIANT_SHADOWS != 0);
+// the active point lights fill the first slots of the light block
+#define ACTIVE_POINT_LIGHTS VARIANT_POINT_LIGHTS
+#define IS_DIRECTIONAL_LIGHT_ACTIVE (VARIANT_DIRECTIONAL_LIGHT != 0)
+#define IS_POINT_LIGHT_ACTIVE(index) true
+#define IS_SPOT_LIGHT_ACTIVE (VARIANT_SPOT_LIGHT != 0)
+#else
+uniform bool bUseTexture=false;
+uniform bool bUseLighting=false;
+uniform bool bUseClusteredLighting = false;
+uniform bool bUseShadows = false;
+#define ACTIVE_POINT_LIGHTS TOTAL_POINT_LIGHTS
+#define IS_DIRECTIONAL_LIGHT_ACTIVE (directionalLight.bActive == true)
+#define IS_POINT_LIGHT_ACTIVE(index) (pointLights[index].bActive == true)
+#define IS_SPOT_LIGHT_ACTIVE (spotLight.bActive == true)
+#endif
+uniform vec4 objectColor = vec4(1.0f);
+// every texture is a layer of a texture array
+uniform sampler2DArray objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+
+// the clustered path reads any number of point lights from buffer
+// textures, each fragment only looping over the lights of its cluster
+// position and radius, ambient, diffuse and specular of each light
+uniform samplerBuffer clusterLights;
+// offset and count of the light list of each cluster
+uniform usamplerBuffer clusterGrid;
+// light lists of all the clusters, one after another
+uniform usamplerBuffer clusterLightIndices;
+// size of a tile in pixels, and the factors turning the log of the
+// view depth into a slice
+uniform vec2 clusterTileSize = vec2(1.0f, 1.0f);
+uniform float clusterDepthScale = 0.0f;
+uniform float clusterDepthBias = 0.0f;
+
+// depth of the scene from the directional light, a layer per cascade
+uniform sampler2DArrayShadow shadowMap;
+// transforms from world space into the texture space of each cascade,
+// and the view depths the cascades end at
+uniform mat4 shadowMatrices[SHADOW_CASCADES];
+uniform vec4 shadowSplitDepths = vec4(0.0f);
+
+// the scaled texture coordinate to use in calculations
+vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
+// the material of the drawn object, looked up from the table
+Material material;
+
+// function prototypes
+vec4 SampleAlbedo();
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 albedo, float shadow);
+float CalcDirectionalShadow(vec3 normal, vec3 fragPos, vec3 lightDirection);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo);
+vec3 CalcClusteredPointLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo);
+
+void main()
+{   
+#ifdef DEPTH_ONLY
+    // the shadow pass only needs the depth of the fragment
+    return;
+#endif
+
+    // the surface color is fetched once and shared by every light
+    vec4 albedo = SampleAlbedo();
+
+    if(bUseLighting == true)
+    {
+        material = materials[fragmentMaterialIndex];
+
+        vec3 phongResult = vec3(0.0f);
+        // properties
+        vec3 norm = normalize(fragmentVertexNormal);
+        vec3 viewDir = normalize(viewPosition - fragmentPosition);
+    
+        // == =====================================================
+        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+        // For each phase, a calculate function is defined that calculates the corresponding color
+        // per light source. In the main() function we take all the calculated colors and sum them 
+        // up for this fragment's final color.
+        // == =====================================================
+        // phase 1: directional lighting
+        if(IS_DIRECTIONAL_LIGHT_ACTIVE)
+        {
+            float shadow = 1.0f;
+            if(bUseShadows == true)
+            {
+                shadow = CalcDirectionalShadow(norm, fragmentPosition, directionalLight.direction);
+            }
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir, albedo.rgb, shadow);
+        }
+        // phase 2: point lights
+        if(bUseClusteredLighting == true)
+        {
+            phongResult += CalcClusteredPointLights(norm, fragmentPosition, viewDir, albedo.rgb);
+        }
+        else
+        {
+            for(int i = 0; i < ACTIVE_POINT_LIGHTS; i++)
+            {
+                if(IS_POINT_LIGHT_ACTIVE(i))
+                {
+                    phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir, albedo.rgb);   
+                }
+            }
+        }
+        // phase 3: spot light
+        if(IS_SPOT_LIGHT_ACTIVE)
+        {
+            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir, albedo.rgb);    
+        }
+
+        fragmentColor = vec4(phongResult, albedo.a);
+    }
+    else
+    {
+        fragmentColor = albedo;
+    }
+}
+
+// returns the texture color of the fragment, or the object color
+// when the object is not textured
+vec4 SampleAlbedo()
+{
+    if(bUseTexture == true)
+    {
+        return texture(objectTexture, vec3(fragmentTextureCoordinateScaled, fragmentTextureLayer));
+    }
+    return objectColor;
+}
+
+// calculates the color when using a directional light, the shadow
+// only taking away the diffuse and specular light.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 albedo, float shadow)
+{
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // combine results
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * albedo;
+    vec3 specular = light.specular * spec * material.specularColor * albedo;
+    
+    return (ambient + ((diffuse + specular) * shadow));
+}
+
+// calculates how much of the directional light reaches the fragment,
+// from the cascade covering its view depth - each lookup compares and
+// filters 2x2 texels, and 3x3 of them are averaged for soft edges.
+float CalcDirectionalShadow(vec3 normal, vec3 fragPos, vec3 lightDirection)
+{
+    float depth = -(view * vec4(fragPos, 1.0f)).z;
+    int cascade = 0;
+    while((cascade < SHADOW_CASCADES) && (depth > shadowSplitDepths[cascade]))
+    {
+        cascade++;
+    }
+    if(cascade >= SHADOW_CASCADES)
+    {
+        return 1.0f;
+    }
+
+    vec4 shadowPosition = shadowMatrices[cascade] * vec4(fragPos, 1.0f);
+    // surfaces facing away from the light need more bias against acne
+    float slope = 1.0f - max(dot(normal, normalize(-lightDirection)), 0.0f);
+    float bias = mix(0.0005f, 0.003f, slope);
+    float reference = shadowPosition.z - bias;
+
+    vec2 texelSize = 1.0f / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0f;
+    for(int x = -1; x <= 1; x++)
+    {
+        for(int y = -1; y <= 1; y++)
+        {
+            vec2 offset = vec2(x, y) * texelSize;
+            lit += texture(shadowMap, vec4(shadowPosition.xy + offset, cascade, reference));
+        }
+    }
+
+    return lit / 9.0f;
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   
+    // combine results - the point light highlights keep the
+    // color of the light rather than taking on the surface color
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * albedo;
+    vec3 specular = light.specular * specularComponent * material.specularColor;
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * albedo;
+    vec3 specular = light.specular * spec * material.specularColor * albedo;
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color of the point lights in the cluster of the fragment.
+vec3 CalcClusteredPointLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo)
+{
+    vec3 result = vec3(0.0f);
+
+    // find the cluster from the screen tile and the view depth
+    float depth = -(view * vec4(fragPos, 1.0f)).z;
+    int slice = clamp(int(floor(log(max(depth, 0.0001f)) * clusterDepthScale + clusterDepthBias)), 0, CLUSTER_SLICES - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+    int cluster = ((slice * CLUSTER_TILES_Y) + tile.y) * CLUSTER_TILES_X + tile.x;
+
+    uvec2 range = texelFetch(clusterGrid, cluster).xy;
+    for(uint i = 0u; i < range.y; i++)
+    {
+        int lightTexel = int(texelFetch(clusterLightIndices, int(range.x + i)).x) * 4;
+        vec4 positionRadius = texelFetch(clusterLights, lightTexel);
+
+        PointLight light;
+        light.position = positionRadius.xyz;
+        light.ambient = texelFetch(clusterLights, lightTexel + 1).rgb;
+        light.diffuse = texelFetch(clusterLights, lightTexel + 2).rgb;
+        light.specular = texelFetch(clusterLights, lightTexel + 3).rgb;
+        light.bActive = true;
+
+        // lights with a radius fade out smoothly to nothing at it
+        float falloff = 1.0f;
+        if(positionRadius.w > 0.0f)
+        {
+            float ratio = length(light.position - fragPos) / positionRadius.w;
+            falloff = clamp(1.0f - (ratio * ratio * ratio * ratio), 0.0f, 1.0f);
+            falloff *= falloff;
+        }
+
+        result += CalcPointLight(light, normal, fragPos, viewDir, albedo) * falloff;
+    }
+
+    return result;
+}
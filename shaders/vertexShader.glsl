@@ -1,20 +1,55 @@
-#version 330 core
-layout (location = 0) in vec3 inVertexPosition;
-layout (location = 1) in vec3 inVertexNormal;
-layout (location = 2) in vec2 inTextureCoordinate;
-
-out vec3 fragmentPosition;
-out vec3 fragmentVertexNormal;
-out vec2 fragmentTextureCoordinate;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
-   fragmentTextureCoordinate = inTextureCoordinate;
-}
\ No newline at end of file
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance model matrix, takes up locations 3 to 6
+layout (location = 3) in mat4 inInstanceModel;
+// per-instance material index and texture layer
+layout (location = 7) in ivec2 inInstanceData;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out int fragmentMaterialIndex;
+flat out int fragmentTextureLayer;
+
+// per-frame camera data shared by all shader programs
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
+
+uniform bool bUseInstancing = false;
+uniform mat4 model;
+uniform int materialIndex = 0;
+uniform int textureLayer = 0;
+#ifdef DEPTH_ONLY
+// light space transform of the shadow cascade being rendered
+uniform mat4 lightViewProjection;
+#endif
+
+void main()
+{
+   // instanced draws read the model matrix and the draw values
+   // from the instance buffers
+   mat4 modelMatrix = model;
+   fragmentMaterialIndex = materialIndex;
+   fragmentTextureLayer = textureLayer;
+   if(bUseInstancing == true)
+   {
+      modelMatrix = inInstanceModel;
+      fragmentMaterialIndex = inInstanceData.x;
+      fragmentTextureLayer = inInstanceData.y;
+   }
+
+   fragmentPosition = vec3(modelMatrix * vec4(inVertexPosition, 1.0));
+#ifdef DEPTH_ONLY
+   gl_Position = lightViewProjection * modelMatrix * vec4(inVertexPosition, 1.0f);
+#else
+   gl_Position = projection * view * modelMatrix * vec4(inVertexPosition, 1.0f);
+#endif
+   fragmentVertexNormal = inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+}